@@ -0,0 +1,356 @@
+#include "ai-evaluator.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "terrain.h"
+#include "move-range.h"
+#include "unit.h"
+#include "unit-group.h"
+
+_Check_return_ _Ret_maybenull_
+AiSnapshot* AiSnapshot_Create(
+    _In_ const TerrainMap* pTerrain
+) {
+    AiSnapshot* pSnapshot = calloc(1, sizeof(AiSnapshot));
+    if (!pSnapshot) {
+        printf("Failed to allocate memory for AiSnapshot\n");
+        return NULL;
+    }
+
+    pSnapshot->nWidth = pTerrain->nWidth;
+    pSnapshot->nHeight = pTerrain->nHeight;
+    pSnapshot->pTerrain = pTerrain;
+    pSnapshot->arrOccupants = malloc((size_t)pTerrain->nWidth * pTerrain->nHeight * sizeof(INT));
+    if (!pSnapshot->arrOccupants) {
+        printf("Failed to allocate memory for snapshot occupants\n");
+        AiSnapshot_Destroy(pSnapshot);
+        return NULL;
+    }
+
+    memset(pSnapshot->arrOccupants, 0xFF, (size_t)pTerrain->nWidth * pTerrain->nHeight * sizeof(INT));
+    return pSnapshot;
+}
+
+void AiSnapshot_Clear(
+    _Inout_ AiSnapshot* pSnapshot
+) {
+    // Clear only the tiles the units wrote
+    for (INT i = 0; i < pSnapshot->nUnits; i++) {
+        const POINT ptTile = pSnapshot->arrUnits[i].state.ptTilePosition;
+        pSnapshot->arrOccupants[ptTile.y * pSnapshot->nWidth + ptTile.x] = -1;
+    }
+    pSnapshot->nUnits = 0;
+}
+
+_Check_return_opt_
+INT AiSnapshot_AddUnit(
+    _Inout_  AiSnapshot* pSnapshot,
+    _In_     const UnitState* pState,
+    _In_     const INT iFaction,
+    _In_opt_ const Unit* pUnit
+) {
+    const POINT ptTile = pState->ptTilePosition;
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pSnapshot->nWidth || ptTile.y >= pSnapshot->nHeight ||
+        pSnapshot->arrOccupants[ptTile.y * pSnapshot->nWidth + ptTile.x] >= 0) {
+        return -1;
+    }
+
+    if (pSnapshot->nUnits == pSnapshot->nCapacity) {
+        const INT nCapacity = pSnapshot->nCapacity ? pSnapshot->nCapacity * 2 : 64;
+        AiUnitState* arrUnits = realloc(pSnapshot->arrUnits, nCapacity * sizeof(AiUnitState));
+        if (!arrUnits) {
+            printf("Failed to allocate memory for snapshot units\n");
+            return -1;
+        }
+        pSnapshot->arrUnits = arrUnits;
+        pSnapshot->nCapacity = nCapacity;
+    }
+
+    const INT iUnit = pSnapshot->nUnits++;
+    pSnapshot->arrUnits[iUnit] = (AiUnitState) { pUnit, iFaction, *pState };
+    pSnapshot->arrOccupants[ptTile.y * pSnapshot->nWidth + ptTile.x] = iUnit;
+    return iUnit;
+}
+
+_Check_return_opt_
+bool AiSnapshot_Capture(
+    _Inout_                AiSnapshot* pSnapshot,
+    _In_reads_(nFactions)  const UnitGroup* const* arrFactions,
+    _In_                   const INT nFactions
+) {
+    AiSnapshot_Clear(pSnapshot);
+
+    for (INT iFaction = 0; iFaction < nFactions; iFaction++) {
+        const UnitGroup* pGroup = arrFactions[iFaction];
+        for (INT i = 0; i < pGroup->nCount; i++) {
+            const UnitState* pState = &pGroup->arrStates[i];
+            const POINT ptTile = pState->ptTilePosition;
+            if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pSnapshot->nWidth || ptTile.y >= pSnapshot->nHeight) {
+                continue; // << Off the map, e.g. not deployed yet
+            }
+
+            if (AiSnapshot_AddUnit(pSnapshot, pState, iFaction, pGroup->arrUnits[i]) < 0 &&
+                pSnapshot->arrOccupants[ptTile.y * pSnapshot->nWidth + ptTile.x] < 0) {
+                return false; // << Out of memory rather than two units sharing a tile
+            }
+        }
+    }
+
+    return true;
+}
+
+_Check_return_opt_
+bool AiSnapshot_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ AiSnapshot* pSnapshot
+) {
+    if (!pSnapshot) {
+        return false;
+    }
+
+    SafeFree(pSnapshot->arrUnits);
+    SafeFree(pSnapshot->arrOccupants);
+    SafeFree(pSnapshot);
+    return true;
+}
+
+_Check_return_ _Ret_maybenull_
+AiEvaluator* AiEvaluator_Create(
+    _In_ JobSystem* pJobs,
+    _In_ const INT nWidth,
+    _In_ const INT nHeight
+) {
+    if (nWidth <= 0 || nHeight <= 0) {
+        return NULL;
+    }
+
+    AiEvaluator* pEvaluator = calloc(1, sizeof(AiEvaluator));
+    if (!pEvaluator) {
+        printf("Failed to allocate memory for AiEvaluator\n");
+        return NULL;
+    }
+
+    pEvaluator->pJobs = pJobs;
+    pEvaluator->nWidth = nWidth;
+    pEvaluator->nHeight = nHeight;
+    pEvaluator->arrEnemyDistances = malloc((size_t)nWidth * nHeight * sizeof(INT));
+    pEvaluator->arrQueue = malloc((size_t)nWidth * nHeight * sizeof(INT));
+    if (!pEvaluator->arrEnemyDistances || !pEvaluator->arrQueue) {
+        printf("Failed to allocate memory for AI evaluator arrays\n");
+        AiEvaluator_Destroy(pEvaluator);
+        return NULL;
+    }
+
+    for (INT i = 0; i < JobSystem_GetThreadCount(pJobs); i++) {
+        pEvaluator->arrRanges[i] = MoveRange_Create(nWidth, nHeight);
+        if (!pEvaluator->arrRanges[i]) {
+            AiEvaluator_Destroy(pEvaluator);
+            return NULL;
+        }
+    }
+
+    return pEvaluator;
+}
+
+/*
+ * Breadth-first search from every enemy at once over passable tiles, giving each tile its step distance to the
+ * closest enemy. Units do not block it; they move away during the turn anyway.
+ */
+static void ComputeEnemyDistances(
+    _Inout_ AiEvaluator* pEvaluator,
+    _In_    const AiSnapshot* pSnapshot,
+    _In_    const INT iFaction
+) {
+    const INT nWidth = pEvaluator->nWidth;
+    const INT nHeight = pEvaluator->nHeight;
+    const BYTE* arrTerrain = pSnapshot->pTerrain->arrCosts;
+    INT* arrDistances = pEvaluator->arrEnemyDistances;
+    INT* arrQueue = pEvaluator->arrQueue;
+    INT nQueued = 0;
+
+    for (INT i = 0; i < nWidth * nHeight; i++) {
+        arrDistances[i] = INT_MAX;
+    }
+    for (INT i = 0; i < pSnapshot->nUnits; i++) {
+        const AiUnitState* pUnit = &pSnapshot->arrUnits[i];
+        const INT iTile = pUnit->state.ptTilePosition.y * nWidth + pUnit->state.ptTilePosition.x;
+        if (pUnit->iFaction != iFaction && arrDistances[iTile] != 0) {
+            arrDistances[iTile] = 0;
+            arrQueue[nQueued++] = iTile;
+        }
+    }
+
+    for (INT iHead = 0; iHead < nQueued; iHead++) {
+        const INT iTile = arrQueue[iHead];
+        const INT x = iTile % nWidth;
+        const INT y = iTile / nWidth;
+        const INT arrNeighbours[4] = {
+            x > 0 ? iTile - 1 : -1,
+            x < nWidth - 1 ? iTile + 1 : -1,
+            y > 0 ? iTile - nWidth : -1,
+            y < nHeight - 1 ? iTile + nWidth : -1
+        };
+
+        for (INT i = 0; i < 4; i++) {
+            const INT iNeighbour = arrNeighbours[i];
+            if (iNeighbour >= 0 && arrDistances[iNeighbour] == INT_MAX &&
+                arrTerrain[iNeighbour] != TERRAIN_COST_IMPASSABLE) {
+                arrDistances[iNeighbour] = arrDistances[iTile] + 1;
+                arrQueue[nQueued++] = iNeighbour;
+            }
+        }
+    }
+}
+
+static void ScoreAttacksFrom(
+    _In_    const AiSnapshot* pSnapshot,
+    _In_    const AiUnitState* pUnit,
+    _In_    const POINT ptFrom,
+    _Inout_ AiAction* pBest
+) {
+    const INT nRange = pUnit->state.nAttackRange;
+
+    // Diamond of Manhattan radius nRange, row by row, so the visiting order is fixed
+    for (INT dy = -nRange; dy <= nRange; dy++) {
+        const INT y = ptFrom.y + dy;
+        if (y < 0 || y >= pSnapshot->nHeight) {
+            continue;
+        }
+
+        const INT nSpan = nRange - abs(dy);
+        for (INT dx = -nSpan; dx <= nSpan; dx++) {
+            const INT x = ptFrom.x + dx;
+            if (x < 0 || x >= pSnapshot->nWidth || (dx == 0 && dy == 0)) {
+                continue;
+            }
+
+            const INT iTarget = pSnapshot->arrOccupants[y * pSnapshot->nWidth + x];
+            if (iTarget < 0 || pSnapshot->arrUnits[iTarget].iFaction == pUnit->iFaction) {
+                continue;
+            }
+
+            const UnitState* pTarget = &pSnapshot->arrUnits[iTarget].state;
+            const INT nDamage = UnitState_GetDamage(&pUnit->state, pTarget);
+            const INT nScore = nDamage * AI_SCORE_PER_DAMAGE + (nDamage >= pTarget->nHp ? AI_SCORE_KILL : 0);
+            if (nScore > pBest->nScore) {
+                pBest->ptMoveTo = ptFrom;
+                pBest->iTarget = iTarget;
+                pBest->nScore = nScore;
+            }
+        }
+    }
+}
+
+static void EvaluateUnits(
+    _Inout_ void* pData,
+    _In_    const INT iBegin,
+    _In_    const INT iEnd,
+    _In_    const INT iThread
+) {
+    AiEvaluator* pEvaluator = pData;
+    const AiSnapshot* pSnapshot = pEvaluator->pSnapshot;
+    MoveRange* pRange = pEvaluator->arrRanges[iThread];
+    const INT nWidth = pSnapshot->nWidth;
+
+    for (INT i = iBegin; i < iEnd; i++) {
+        const INT iUnit = pEvaluator->arrUnitIndices[i];
+        const AiUnitState* pUnit = &pSnapshot->arrUnits[iUnit];
+
+        AiAction best = { iUnit, pUnit->state.ptTilePosition, -1, INT_MIN };
+        const INT nReached = MoveRange_Compute(
+            pRange,
+            pSnapshot->pTerrain,
+            pUnit->state.ptTilePosition,
+            pUnit->state.nMoveSpeed
+        );
+
+        for (INT j = 0; j < nReached; j++) {
+            const INT iTile = pRange->arrReached[j];
+            const INT iOccupant = pSnapshot->arrOccupants[iTile];
+            if (iOccupant >= 0 && iOccupant != iUnit) {
+                continue;
+            }
+
+            const POINT ptTile = { iTile % nWidth, iTile / nWidth };
+            ScoreAttacksFrom(pSnapshot, pUnit, ptTile, &best);
+
+            // Closing in scores below every attack, so it only wins when nothing is in reach
+            const INT nDistance = pEvaluator->arrEnemyDistances[iTile];
+            const INT nScore = nDistance == INT_MAX ? INT_MIN + 1 : -nDistance * AI_SCORE_PER_STEP;
+            if (nScore > best.nScore) {
+                best.ptMoveTo = ptTile;
+                best.iTarget = -1;
+                best.nScore = nScore;
+            }
+        }
+
+        pEvaluator->arrActions[i] = best;
+    }
+}
+
+_Check_return_
+INT AiEvaluator_Evaluate(
+    _Inout_                              AiEvaluator* pEvaluator,
+    _In_                                 const AiSnapshot* pSnapshot,
+    _In_                                 const INT iFaction,
+    _Out_writes_to_(nMaxActions, return) AiAction* arrActions,
+    _In_                                 const INT nMaxActions
+) {
+    if (pSnapshot->nWidth != pEvaluator->nWidth || pSnapshot->nHeight != pEvaluator->nHeight) {
+        printf("AiEvaluator is %dx%d but the snapshot is %dx%d\n",
+            pEvaluator->nWidth, pEvaluator->nHeight, pSnapshot->nWidth, pSnapshot->nHeight);
+        return -1;
+    }
+
+    if (pSnapshot->nUnits > pEvaluator->nUnitIndicesCapacity) {
+        INT* arrUnitIndices = realloc(pEvaluator->arrUnitIndices, pSnapshot->nUnits * sizeof(INT));
+        if (!arrUnitIndices) {
+            printf("Failed to allocate memory for AI unit indices\n");
+            return -1;
+        }
+        pEvaluator->arrUnitIndices = arrUnitIndices;
+        pEvaluator->nUnitIndicesCapacity = pSnapshot->nUnits;
+    }
+
+    INT nUnits = 0;
+    for (INT i = 0; i < pSnapshot->nUnits; i++) {
+        if (pSnapshot->arrUnits[i].iFaction == iFaction) {
+            pEvaluator->arrUnitIndices[nUnits++] = i;
+        }
+    }
+    if (nUnits > nMaxActions) {
+        return -1;
+    }
+
+    ComputeEnemyDistances(pEvaluator, pSnapshot, iFaction);
+
+    pEvaluator->pSnapshot = pSnapshot;
+    pEvaluator->iFaction = iFaction;
+    pEvaluator->arrActions = arrActions;
+
+    // One unit per job; units differ a lot in cost, so small jobs keep the threads evenly loaded
+    JobSystem_ParallelFor(pEvaluator->pJobs, nUnits, 1, EvaluateUnits, pEvaluator);
+
+    pEvaluator->pSnapshot = NULL;
+    pEvaluator->arrActions = NULL;
+    return nUnits;
+}
+
+_Check_return_opt_
+bool AiEvaluator_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ AiEvaluator* pEvaluator
+) {
+    if (!pEvaluator) {
+        return false;
+    }
+
+    for (INT i = 0; i < JOB_SYSTEM_MAX_THREADS; i++) {
+        MoveRange_Destroy(pEvaluator->arrRanges[i]);
+    }
+
+    SafeFree(pEvaluator->arrEnemyDistances);
+    SafeFree(pEvaluator->arrQueue);
+    SafeFree(pEvaluator->arrUnitIndices);
+    SafeFree(pEvaluator);
+    return true;
+}
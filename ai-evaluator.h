@@ -0,0 +1,174 @@
+#ifndef AI_EVALUATOR_H
+#define AI_EVALUATOR_H
+
+#include "utils.h"
+#include "point.h"
+#include "job-system.h"
+#include "unit-state.h"
+
+typedef struct _Unit Unit;
+typedef struct _UnitGroup UnitGroup;
+typedef struct _TerrainMap TerrainMap;
+typedef struct _MoveRange MoveRange;
+
+#define AI_SCORE_PER_DAMAGE 100
+#define AI_SCORE_KILL 1000
+#define AI_SCORE_PER_STEP 1       // << Penalty per step still needed to reach the nearest enemy
+
+/*
+ * Copy of the unit state the AI reads, taken once per turn. Evaluation never touches live `Unit`s, so sprites
+ * and animations may keep updating on the main thread while the workers score.
+ */
+typedef struct _AiUnitState {
+    const Unit* pUnit;         // << Unit the state was captured from, or NULL for headless units
+    INT iFaction;              // << Index of the group the unit was captured from
+    UnitState state;
+} AiUnitState;
+
+typedef struct _AiSnapshot {
+    INT nWidth;
+    INT nHeight;
+    const TerrainMap* pTerrain; // << Must not change while an evaluation runs
+    AiUnitState* arrUnits;
+    INT nUnits;
+    INT nCapacity;
+    INT* arrOccupants;         // << Index into arrUnits for every tile, -1 for empty tiles
+} AiSnapshot;
+
+typedef struct _AiAction {
+    INT iUnit;                 // << Index into the snapshot's arrUnits
+    POINT ptMoveTo;            // << Tile to move to; the unit's own tile to stay
+    INT iTarget;               // << Unit to attack from ptMoveTo, or -1
+    INT nScore;
+} AiAction;
+
+/*
+ * Scores every move and attack option of a faction's units in parallel.
+ *
+ * Each unit is scored on its own against the read-only snapshot and writes only its own result slot, and ties
+ * are broken by the fixed order tiles and targets are visited in. The chosen actions are therefore the same for
+ * any number of threads. Units do not see each other's choices; resolving two units picking the same tile is
+ * left to the caller, which applies the actions in order.
+ */
+typedef struct _AiEvaluator {
+    JobSystem* pJobs;
+    INT nWidth;
+    INT nHeight;
+    MoveRange* arrRanges[JOB_SYSTEM_MAX_THREADS]; // << Scratch search state per thread
+    INT* arrEnemyDistances;    // << Steps from each tile to the nearest enemy of the evaluated faction
+    INT* arrQueue;
+    INT* arrUnitIndices;       // << Snapshot indices of the evaluated faction's units
+    INT nUnitIndicesCapacity;
+
+    // State of the running evaluation, read by the jobs
+    const AiSnapshot* pSnapshot;
+    INT iFaction;
+    AiAction* arrActions;
+} AiEvaluator;
+
+/**
+ * @brief Creates an empty snapshot for maps of the given terrain.
+ *
+ * @param pTerrain Terrain the units stand on.
+ * @return A pointer to the new `AiSnapshot`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ AiSnapshot* AiSnapshot_Create(
+    _In_ const TerrainMap* pTerrain
+    );
+
+/**
+ * @brief Copies the state of every unit of the given factions into the snapshot.
+ *
+ * @param pSnapshot    Pointer to the `AiSnapshot`; its previous contents are replaced.
+ * @param arrFactions  One `UnitGroup` per faction; the index becomes the faction id.
+ * @param nFactions    Number of factions.
+ * @return `true` if the snapshot was taken, `false` if the allocation failed.
+ */
+_Check_return_opt_ bool AiSnapshot_Capture(
+    _Inout_                AiSnapshot* pSnapshot,
+    _In_reads_(nFactions)  const UnitGroup* const* arrFactions,
+    _In_                   INT nFactions
+    );
+
+/**
+ * @brief Removes every unit from the snapshot.
+ *
+ * @param pSnapshot Pointer to the `AiSnapshot`.
+ */
+void AiSnapshot_Clear(
+    _Inout_ AiSnapshot* pSnapshot
+    );
+
+/**
+ * @brief Adds one unit to the snapshot.
+ *
+ * @param pSnapshot Pointer to the `AiSnapshot`.
+ * @param pState    State of the unit. Its tile must be on the map and free.
+ * @param iFaction  Faction of the unit.
+ * @param pUnit     Unit the state belongs to, or `NULL`.
+ * @return The index of the unit in `arrUnits`, or `-1` if the tile is taken or the allocation failed.
+ */
+_Check_return_opt_ INT AiSnapshot_AddUnit(
+    _Inout_  AiSnapshot* pSnapshot,
+    _In_     const UnitState* pState,
+    _In_     INT iFaction,
+    _In_opt_ const Unit* pUnit
+    );
+
+/**
+ * @brief Destroys a snapshot and frees its resources.
+ *
+ * @param pSnapshot Pointer to the `AiSnapshot` to destroy.
+ * @return `true` if the snapshot was destroyed, `false` if `pSnapshot` was `NULL`.
+ */
+_Check_return_opt_ bool AiSnapshot_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ AiSnapshot* pSnapshot
+    );
+
+/**
+ * @brief Creates an evaluator that runs on a job system.
+ *
+ * @param pJobs   Job system to run on; it must outlive the evaluator.
+ * @param nWidth  Width of the map in tiles.
+ * @param nHeight Height of the map in tiles.
+ * @return A pointer to the new `AiEvaluator`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ AiEvaluator* AiEvaluator_Create(
+    _In_ JobSystem* pJobs,
+    _In_ INT nWidth,
+    _In_ INT nHeight
+    );
+
+/**
+ * @brief Picks the best action for every unit of a faction.
+ *
+ * A unit may move to any free tile it can reach with `nMoveSpeed` points and then attack an enemy within
+ * `nAttackRange` steps. Attacks score by damage, with a bonus for kills; without an attack in reach, the unit
+ * moves as close to the enemy as it can.
+ *
+ * @param pEvaluator Pointer to the `AiEvaluator`. Must be called from the job system's owning thread.
+ * @param pSnapshot  Snapshot to score against.
+ * @param iFaction   Faction whose units act.
+ * @param arrActions Receives one action per unit of the faction, in snapshot order.
+ * @param nMaxActions Capacity of `arrActions`.
+ * @return The number of actions written, or `-1` if they do not fit.
+ */
+_Check_return_ INT AiEvaluator_Evaluate(
+    _Inout_                              AiEvaluator* pEvaluator,
+    _In_                                 const AiSnapshot* pSnapshot,
+    _In_                                 INT iFaction,
+    _Out_writes_to_(nMaxActions, return) AiAction* arrActions,
+    _In_                                 INT nMaxActions
+    );
+
+/**
+ * @brief Destroys an evaluator and frees its resources.
+ *
+ * @param pEvaluator Pointer to the `AiEvaluator` to destroy.
+ * @return `true` if the evaluator was destroyed, `false` if `pEvaluator` was `NULL`.
+ */
+_Check_return_opt_ bool AiEvaluator_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ AiEvaluator* pEvaluator
+    );
+
+#endif //AI_EVALUATOR_H
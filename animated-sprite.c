@@ -10,6 +10,12 @@
 #include "file.h"
 #include "convert.h"
 #include "xml.h"
+#include "asset-watcher.h"
+#include "profiler.h"
+#include "arena.h"
+#include "pool.h"
+
+static Pool s_animSpritePool = POOL_INIT(AnimatedSprite);
 
 _Check_return_ _Ret_maybenull_
 AnimatedSprite* AnimatedSprite_Create(
@@ -17,7 +23,7 @@ AnimatedSprite* AnimatedSprite_Create(
     _In_ const FLOAT x,
     _In_ const FLOAT y
 ) {
-    AnimatedSprite* pAnimSprite = malloc(sizeof(AnimatedSprite));
+    AnimatedSprite* pAnimSprite = Pool_Alloc(&s_animSpritePool);
     if (!pAnimSprite) {
         printf("Failed to allocate memory for animated sprite.\n");
         return NULL;
@@ -25,11 +31,12 @@ AnimatedSprite* AnimatedSprite_Create(
 
     pAnimSprite->nCount = 0;
     pAnimSprite->nCapacity = 5;
+    pAnimSprite->pActiveAnimation = NULL;
     pAnimSprite->pSprite = Sprite_Create(pTexture, x, y);
     pAnimSprite->arrAnimations = malloc(pAnimSprite->nCapacity * sizeof(Animation));
     if (!pAnimSprite->arrAnimations) {
         printf("Failed to allocate memory for animated sprite frames.\n");
-        SafeFree(pAnimSprite);
+        Pool_Free(&s_animSpritePool, pAnimSprite);
         return NULL;
     }
 
@@ -44,7 +51,7 @@ Result AnimatedSprite_Allocate(
     _In_                          const FLOAT y,
     _Outptr_result_nullonfailure_ AnimatedSprite** ppAnimSprite
 ) {
-    *ppAnimSprite = malloc(sizeof(AnimatedSprite));
+    *ppAnimSprite = Pool_Alloc(&s_animSpritePool);
     if (!*ppAnimSprite) {
         printf("Failed to allocate memory for animated sprite.\n");
         return RESULT_MALLOC_FAILED;
@@ -52,11 +59,13 @@ Result AnimatedSprite_Allocate(
 
     (*ppAnimSprite)->nCount = 0;
     (*ppAnimSprite)->nCapacity = 5;
+    (*ppAnimSprite)->pActiveAnimation = NULL;
     (*ppAnimSprite)->pSprite = Sprite_Create(pTexture, x, y);
     (*ppAnimSprite)->arrAnimations = malloc((*ppAnimSprite)->nCapacity * sizeof(Animation));
     if (!(*ppAnimSprite)->arrAnimations) {
         printf("Failed to allocate memory for animated sprite frames.\n");
-        SafeFree(*ppAnimSprite);
+        Pool_Free(&s_animSpritePool, *ppAnimSprite);
+        *ppAnimSprite = NULL;
         return RESULT_MALLOC_FAILED;
     }
 
@@ -97,99 +106,205 @@ Result AnimatedSprite_AddAnimation(
     return RESULT_SUCCESS;
 }
 
+/**
+ * Copies a child node's text into the arena, or onto the heap for the caller to free when `pArena` is `NULL`.
+ */
+_Check_return_ _Ret_maybenull_
+static PSTR ReadXmlNodeContent(
+    _In_        struct xml_node* pXmlNode,
+    _In_        const INT iNode,
+    _Inout_opt_ Arena* pArena
+) {
+    struct xml_node* pChild = xml_node_child(pXmlNode, iNode);
+    struct xml_string* pContent = pChild ? xml_node_content(pChild) : NULL;
+    if (!pContent) {
+        return NULL;
+    }
+
+    const size_t cchContent = xml_string_length(pContent);
+    PSTR pszContent = pArena ? Arena_AllocAligned(pArena, cchContent + 1, 1) : malloc(cchContent + 1);
+    if (!pszContent) {
+        return NULL;
+    }
+
+    xml_string_copy(pContent, (uint8_t*)pszContent, cchContent);
+    pszContent[cchContent] = '\0';
+    return pszContent;
+}
+
 static void ParseXmlNodeContentFloat(
-    _Out_ FLOAT* pfValue,
-    _In_  struct xml_node* pXmlNode,
-    _In_  const INT iNode
+    _Out_       FLOAT* pfValue,
+    _In_        struct xml_node* pXmlNode,
+    _In_        const INT iNode,
+    _Inout_opt_ Arena* pArena
 ) {
-    BYTE* pNodeContent = xml_easy_content(xml_node_child(pXmlNode, iNode));
-    *pfValue = StrToFloat((PCSTR)pNodeContent);
-    SafeFree(pNodeContent);
+    PSTR pszContent = ReadXmlNodeContent(pXmlNode, iNode, pArena);
+    *pfValue = pszContent ? StrToFloat(pszContent) : 0.0f;
+    if (!pArena) {
+        SafeFree(pszContent);
+    }
 }
 
 static void ParseXmlNodeContentInt(
-    _Out_ INT* pnValue,
-    _In_  struct xml_node* pXmlNode,
-    _In_  const INT iNode
+    _Out_       INT* pnValue,
+    _In_        struct xml_node* pXmlNode,
+    _In_        const INT iNode,
+    _Inout_opt_ Arena* pArena
 ) {
-    BYTE* pNodeContent = xml_easy_content(xml_node_child(pXmlNode, iNode));
-    *pnValue = StrToInt((PCSTR)pNodeContent);
-    SafeFree(pNodeContent);
+    PSTR pszContent = ReadXmlNodeContent(pXmlNode, iNode, pArena);
+    *pnValue = pszContent ? StrToInt(pszContent) : 0;
+    if (!pArena) {
+        SafeFree(pszContent);
+    }
 }
 
 static void ParseXmlNodeContentUlong(
-    _Out_ ULONG* pu64Value,
-    _In_  struct xml_node* pXmlNode,
-    _In_  const INT iNode
+    _Out_       ULONG* pu64Value,
+    _In_        struct xml_node* pXmlNode,
+    _In_        const INT iNode,
+    _Inout_opt_ Arena* pArena
 ) {
-    BYTE* pNodeContent = xml_easy_content(xml_node_child(pXmlNode, iNode));
-    *pu64Value = StrToUlong((PCSTR)pNodeContent);
-    SafeFree(pNodeContent);
+    PSTR pszContent = ReadXmlNodeContent(pXmlNode, iNode, pArena);
+    *pu64Value = pszContent ? StrToUlong(pszContent) : 0;
+    if (!pArena) {
+        SafeFree(pszContent);
+    }
 }
 
-void AnimatedSprite_LoadAnimationsFromFile(
-    _Inout_ AnimatedSprite* pAnimSprite,
-    _In_z_  PCSTR pszFileName
+_Check_return_ _Success_(return)
+bool AnimatedSprite_ParseAnimations(
+    _In_z_ PCSTR pszFileName,
+    _Out_  Animation** parrAnimations,
+    _Out_  INT* pnCount
 ) {
-    File* pAnimationFile = File_Open(pszFileName);
-    if (!pAnimationFile) {
-        printf("Failed to open file: %s\n", pszFileName);
-        return;
-    }
+    *parrAnimations = NULL;
+    *pnCount = 0;
 
-    PSTR pszBuffer = File_ReadAllBytes(pAnimationFile, NULL);
-    if (!pszBuffer) {
-        printf("Failed to read file: %s\n", pszFileName);
-        File_Close(pAnimationFile);
-        return;
+    Arena* pScratch = Arena_GetScratch();
+    if (!pScratch) {
+        return false;
     }
 
-    File_Close(pAnimationFile);
+    FileView* pAnimationFile = File_Map(pszFileName);
+    if (!pAnimationFile) {
+        printf("Failed to open file: %s\n", pszFileName);
+        return false;
+    }
 
-    struct xml_document* pXmlDocument = xml_parse_document((uint8_t*)pszBuffer, strlen(pszBuffer));
+    // The parser only reads from the buffer, so it can work on the mapped view directly
+    struct xml_document* pXmlDocument = xml_parse_document(
+        (uint8_t*)FileView_GetData(pAnimationFile),
+        FileView_GetSize(pAnimationFile)
+    );
     if (!pXmlDocument) {
         printf("Failed to parse file: %s\n", pszFileName);
-        SafeFree(pszBuffer);
-        return;
+        File_Unmap(pAnimationFile);
+        return false;
     }
 
     struct xml_node* pRootElement = xml_document_root(pXmlDocument);
     const ULONG nAnimations = xml_node_children(pRootElement);
 
-    if (pAnimSprite->nCapacity <= nAnimations) {
-        pAnimSprite->nCapacity = (int)nAnimations + 1;
-        Animation* arrAnimations = realloc(pAnimSprite->arrAnimations, pAnimSprite->nCapacity * sizeof(Animation));
-        if (!arrAnimations) {
-            printf("Failed to allocate memory for animated sprite frames.\n");
-            xml_document_free(pXmlDocument, false);
-            SafeFree(pszBuffer);
-            return;
-        }
-        pAnimSprite->arrAnimations = arrAnimations;
+    Animation* arrAnimations = malloc((nAnimations + 1) * sizeof(Animation));
+    if (!arrAnimations) {
+        printf("Failed to allocate memory for animated sprite frames.\n");
+        xml_document_free(pXmlDocument, false);
+        File_Unmap(pAnimationFile);
+        return false;
     }
 
     for (int i = 0; i < nAnimations; i++) {
         struct xml_node* pXmlAnimationNode = xml_node_child(pRootElement, i);
 
-        Animation* pAnimation = &pAnimSprite->arrAnimations[i];
+        Animation* pAnimation = &arrAnimations[i];
 
-        pAnimation->pszName = (PSTR)xml_easy_content(xml_node_child(pXmlAnimationNode, 0));
+        // The name outlives the parse, so it is the one field copied onto the heap
+        pAnimation->pszName = ReadXmlNodeContent(pXmlAnimationNode, 0, NULL);
 
-        ParseXmlNodeContentFloat(&pAnimation->fFrameSizeX, pXmlAnimationNode, 1);
-        ParseXmlNodeContentFloat(&pAnimation->fFrameSizeY, pXmlAnimationNode, 2);
-        ParseXmlNodeContentInt(&pAnimation->iStartFrame, pXmlAnimationNode, 3);
-        ParseXmlNodeContentInt(&pAnimation->nFrameCount, pXmlAnimationNode, 4);
-        ParseXmlNodeContentUlong(&pAnimation->u64FrameTime, pXmlAnimationNode, 5);
+        const ArenaScope scope = Arena_BeginScope(pScratch);
+        ParseXmlNodeContentFloat(&pAnimation->fFrameSizeX, pXmlAnimationNode, 1, pScratch);
+        ParseXmlNodeContentFloat(&pAnimation->fFrameSizeY, pXmlAnimationNode, 2, pScratch);
+        ParseXmlNodeContentInt(&pAnimation->iStartFrame, pXmlAnimationNode, 3, pScratch);
+        ParseXmlNodeContentInt(&pAnimation->nFrameCount, pXmlAnimationNode, 4, pScratch);
+        ParseXmlNodeContentUlong(&pAnimation->u64FrameTime, pXmlAnimationNode, 5, pScratch);
+        Arena_EndScope(scope);
 
         pAnimation->iCurrentFrame = pAnimation->iStartFrame;
         pAnimation->u64LastTime = 0;
         pAnimation->bPlaying = true;
-
-        pAnimSprite->nCount++;
     }
 
     xml_document_free(pXmlDocument, false);
-    SafeFree(pszBuffer);
+    File_Unmap(pAnimationFile);
+
+    *parrAnimations = arrAnimations;
+    *pnCount = (INT)nAnimations;
+    return true;
+}
+
+void AnimatedSprite_ReplaceAnimations(
+    _Inout_ AnimatedSprite* pAnimSprite,
+    _In_    Animation* arrAnimations,
+    _In_    const INT nCount
+) {
+    const Animation* pOldActive = pAnimSprite->pActiveAnimation;
+    Animation* pNewActive = NULL;
+
+    // Keep playing the same animation, at the same frame where it still exists, so a reload does not pop
+    if (pOldActive) {
+        for (int i = 0; i < nCount; i++) {
+            Animation* pAnimation = &arrAnimations[i];
+            if (strcmp(pAnimation->pszName, pOldActive->pszName) != 0) {
+                continue;
+            }
+
+            const INT iFrameOffset = pOldActive->iCurrentFrame - pOldActive->iStartFrame;
+            pAnimation->iCurrentFrame = pAnimation->iStartFrame +
+                (iFrameOffset < pAnimation->nFrameCount ? iFrameOffset : 0);
+            pAnimation->u64LastTime = pOldActive->u64LastTime;
+            pAnimation->bPlaying = pOldActive->bPlaying;
+            pNewActive = pAnimation;
+            break;
+        }
+    }
+
+    AnimatedSprite_FreeAnimations(pAnimSprite->arrAnimations, pAnimSprite->nCount);
+
+    pAnimSprite->arrAnimations = arrAnimations;
+    pAnimSprite->nCount = nCount;
+    pAnimSprite->nCapacity = nCount + 1;
+    pAnimSprite->pActiveAnimation = pNewActive ? pNewActive : (nCount > 0 ? &arrAnimations[0] : NULL);
+}
+
+void AnimatedSprite_FreeAnimations(
+    _In_ _Post_invalid_ Animation* arrAnimations,
+    _In_                const INT nCount
+) {
+    if (!arrAnimations) {
+        return;
+    }
+
+    for (int i = 0; i < nCount; i++) {
+        SafeFree(arrAnimations[i].pszName);
+    }
+    free(arrAnimations);
+}
+
+void AnimatedSprite_LoadAnimationsFromFile(
+    _Inout_ AnimatedSprite* pAnimSprite,
+    _In_z_  PCSTR pszFileName
+) {
+    Animation* arrAnimations;
+    INT nCount;
+    PROFILE_BEGIN("AnimatedSprite_LoadAnimations");
+    const bool bParsed = AnimatedSprite_ParseAnimations(pszFileName, &arrAnimations, &nCount);
+    PROFILE_END();
+    if (!bParsed) {
+        return;
+    }
+
+    AnimatedSprite_ReplaceAnimations(pAnimSprite, arrAnimations, nCount);
+    AssetWatcher_Watch(ASSET_KIND_ANIMATIONS, pAnimSprite, 0, pszFileName);
 }
 
 void AnimatedSprite_SetActiveAnimation(
@@ -204,33 +319,25 @@ void AnimatedSprite_SetActiveAnimation(
     }
 }
 
-void AnimatedSprite_Draw(
+void AnimatedSprite_ApplyFrame(
     _In_ const AnimatedSprite* pAnimSprite
 ) {
     const int iSourceX = pAnimSprite->pActiveAnimation->iCurrentFrame % (int)(Sprite_GetWidth(pAnimSprite->pSprite) / pAnimSprite->pActiveAnimation->fFrameSizeX);
     const int iSourceY = pAnimSprite->pActiveAnimation->iCurrentFrame / (int)(Sprite_GetWidth(pAnimSprite->pSprite) / pAnimSprite->pActiveAnimation->fFrameSizeX);
 
-    /*
-    const Vector2 screenPos = WorldToScreen(pAnimSprite->pSprite->x, pAnimSprite->pSprite->y);
-
-    const SDL_FRect dstRect = {
-        screenPos.x,
-        screenPos.y,
-        pAnimSprite->pActiveAnimation->fFrameSizeX * pAnimSprite->pSprite->fScaleX * Camera_GetZoom(),
-        pAnimSprite->pActiveAnimation->fFrameSizeY * pAnimSprite->pSprite->fScaleY * Camera_GetZoom()
-    };
-    */
-
-    sfSprite_setTextureRect(
-        pAnimSprite->pSprite->pSpriteHandle,
-        (sfIntRect) {
-            iSourceX * (int)pAnimSprite->pActiveAnimation->fFrameSizeX,
-            iSourceY * (int)pAnimSprite->pActiveAnimation->fFrameSizeY,
-            (int)pAnimSprite->pActiveAnimation->fFrameSizeX,
-            (int)pAnimSprite->pActiveAnimation->fFrameSizeY
-        }
+    Sprite_SetTextureRect(
+        pAnimSprite->pSprite,
+        iSourceX * (int)pAnimSprite->pActiveAnimation->fFrameSizeX,
+        iSourceY * (int)pAnimSprite->pActiveAnimation->fFrameSizeY,
+        (int)pAnimSprite->pActiveAnimation->fFrameSizeX,
+        (int)pAnimSprite->pActiveAnimation->fFrameSizeY
     );
-    
+}
+
+void AnimatedSprite_Draw(
+    _In_ const AnimatedSprite* pAnimSprite
+) {
+    AnimatedSprite_ApplyFrame(pAnimSprite);
     Sprite_Draw(pAnimSprite->pSprite);
 }
 
@@ -241,14 +348,25 @@ void AnimatedSprite_Update(
         return;
     }
 
-    const INT nTime = GetTime();
-    if (nTime - pAnimSprite->pActiveAnimation->u64LastTime >= pAnimSprite->pActiveAnimation->u64FrameTime) {
-        pAnimSprite->pActiveAnimation->u64LastTime = nTime;
-        pAnimSprite->pActiveAnimation->iCurrentFrame++;
-        if (pAnimSprite->pActiveAnimation->iCurrentFrame >= pAnimSprite->pActiveAnimation->nFrameCount + pAnimSprite->pActiveAnimation->iStartFrame) {
-            pAnimSprite->pActiveAnimation->iCurrentFrame = pAnimSprite->pActiveAnimation->iStartFrame;
-        }
+    Animation* pAnimation = pAnimSprite->pActiveAnimation;
+    const UINT64 u64Now = (UINT64)GetTimeMicroseconds();
+    const UINT64 u64FrameUs = pAnimation->u64FrameTime * 1000;
+    if (pAnimation->u64LastTime == 0 || u64FrameUs == 0 || pAnimation->nFrameCount <= 0) {
+        pAnimation->u64LastTime = u64Now;
+        return;
     }
+
+    const UINT64 u64Elapsed = u64Now > pAnimation->u64LastTime ? u64Now - pAnimation->u64LastTime : 0;
+    if (u64Elapsed < u64FrameUs) {
+        return;
+    }
+
+    // Step the frame start by whole frames rather than resetting it to now, so rounding to the display's frame
+    // rate does not stretch every animation frame
+    const UINT64 u64Frames = u64Elapsed / u64FrameUs;
+    pAnimation->u64LastTime += u64Frames * u64FrameUs;
+    pAnimation->iCurrentFrame = pAnimation->iStartFrame +
+        (INT)((pAnimation->iCurrentFrame - pAnimation->iStartFrame + u64Frames) % (UINT64)pAnimation->nFrameCount);
 }
 
 void AnimatedSprite_SetFrame(
@@ -304,14 +422,17 @@ Result AnimatedSprite_Destroy(
         return RESULT_NULL_POINTER;
     }
 
+    AssetWatcher_Unwatch(pAnimSprite);
     Sprite_Destroy(pAnimSprite->pSprite);
 
-    for (int i = 0; i < pAnimSprite->nCount; i++) {
-        SafeFree(pAnimSprite->arrAnimations[i].pszName);
-    }
-
-    SafeFree(pAnimSprite->arrAnimations);
-    SafeFree(pAnimSprite);
+    AnimatedSprite_FreeAnimations(pAnimSprite->arrAnimations, pAnimSprite->nCount);
+    Pool_Free(&s_animSpritePool, pAnimSprite);
 
     return RESULT_SUCCESS;
 }
+
+void AnimatedSprite_Shutdown(
+    void
+) {
+    Pool_Release(&s_animSpritePool);
+}
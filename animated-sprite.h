@@ -13,8 +13,8 @@ typedef struct _Animation {
     INT nFrameCount;
     FLOAT fFrameSizeX;
     FLOAT fFrameSizeY;
-    UINT64 u64LastTime;
-    UINT64 u64FrameTime;
+    UINT64 u64LastTime;        // << Time the current frame started, from GetTimeMicroseconds
+    UINT64 u64FrameTime;       // << Duration of a frame in milliseconds
     bool bPlaying;
 } Animation;
 
@@ -94,11 +94,58 @@ Result AnimatedSprite_AddAnimation(
     _In_    UINT64 u64FrameTime
     );
 
+/**
+ * @brief Loads all animations of a sprite from an XML file, replacing any it already has.
+ *
+ * @param pAnimSprite Pointer to the `AnimatedSprite` to load the animations into.
+ * @param pszFileName Path to the animation XML file.
+ */
 void AnimatedSprite_LoadAnimationsFromFile(
     _Inout_ AnimatedSprite* pAnimSprite,
     _In_z_  PCSTR pszFileName
     );
 
+/**
+ * @brief Parses an animation XML file into a new array without touching any sprite.
+ *
+ * Only touches the file and the heap, so it may run on any thread.
+ *
+ * @param pszFileName    Path to the animation XML file.
+ * @param parrAnimations Receives the parsed animations. Pass them to `AnimatedSprite_ReplaceAnimations` or
+ *                       free them with `AnimatedSprite_FreeAnimations`.
+ * @param pnCount        Receives the number of parsed animations.
+ * @return `true` if the file was parsed.
+ */
+_Check_return_ _Success_(return) bool AnimatedSprite_ParseAnimations(
+    _In_z_ PCSTR pszFileName,
+    _Out_  Animation** parrAnimations,
+    _Out_  INT* pnCount
+    );
+
+/**
+ * @brief Swaps in a new set of animations.
+ *
+ * The sprite takes ownership of `arrAnimations` and frees its old animations. If the active animation exists
+ * in the new set it stays active and keeps its current frame; otherwise the first animation becomes active.
+ *
+ * @param pAnimSprite   Pointer to the `AnimatedSprite` to update.
+ * @param arrAnimations Animations returned by `AnimatedSprite_ParseAnimations`.
+ * @param nCount        Number of animations in `arrAnimations`.
+ */
+void AnimatedSprite_ReplaceAnimations(
+    _Inout_ AnimatedSprite* pAnimSprite,
+    _In_    Animation* arrAnimations,
+    _In_    INT nCount
+    );
+
+/**
+ * @brief Frees an animation array and the names it owns.
+ */
+void AnimatedSprite_FreeAnimations(
+    _In_ _Post_invalid_ Animation* arrAnimations,
+    _In_                INT nCount
+    );
+
 /**
  * @brief Sets the active animation for an animated sprite.
  *
@@ -115,6 +162,17 @@ void AnimatedSprite_SetActiveAnimation(
     _In_z_  PCSTR pszName
     );
 
+/**
+ * @brief Points the sprite's texture rectangle at the current frame of the active animation, without drawing.
+ *
+ * Touches only this sprite, so different animated sprites may be updated on different threads.
+ *
+ * @param pAnimSprite Pointer to the `AnimatedSprite`. The sprite must have an active animation set.
+ */
+void AnimatedSprite_ApplyFrame(
+    _In_ const AnimatedSprite* pAnimSprite
+    );
+
 /**
  * @brief Draws the current frame of an animated sprite.
  *
@@ -223,4 +281,13 @@ _Check_return_opt_ Result AnimatedSprite_Destroy(
     _Inout_ _Pre_valid_ _Post_invalid_ AnimatedSprite* pAnimSprite
     );
 
+/**
+ * @brief Frees the memory pool that animated sprites are allocated from.
+ *
+ * Call once at shutdown, after every one of them is destroyed.
+ */
+void AnimatedSprite_Shutdown(
+    void
+    );
+
 #endif //ANIMATED_SPRITE_H
@@ -0,0 +1,154 @@
+#include "arena.h"
+
+#include <string.h>
+
+static Arena* s_pFrameArena;
+static THREAD_LOCAL Arena* s_pScratchArena;
+
+_Check_return_ _Ret_maybenull_
+Arena* Arena_Create(
+    _In_ const size_t cbCapacity
+) {
+    Arena* pArena = calloc(1, sizeof(Arena));
+    if (!pArena) {
+        printf("Failed to allocate memory for Arena\n");
+        return NULL;
+    }
+
+    pArena->pBase = malloc(cbCapacity);
+    if (!pArena->pBase) {
+        printf("Failed to allocate %zu bytes for Arena\n", cbCapacity);
+        SafeFree(pArena);
+        return NULL;
+    }
+
+    pArena->cbCapacity = cbCapacity;
+    return pArena;
+}
+
+_Check_return_ _Ret_maybenull_
+void* Arena_AllocAligned(
+    _Inout_ Arena* pArena,
+    _In_    const size_t cb,
+    _In_    const size_t cbAlign
+) {
+    // Align the address rather than the offset, so alignments above malloc's are honoured too
+    const uintptr_t uAddress = (uintptr_t)pArena->pBase + pArena->cbUsed;
+    const uintptr_t uAligned = (uAddress + (cbAlign - 1)) & ~(uintptr_t)(cbAlign - 1);
+    const size_t cbOffset = (size_t)(uAligned - (uintptr_t)pArena->pBase);
+
+    if (cbOffset > pArena->cbCapacity || cb > pArena->cbCapacity - cbOffset) {
+        printf("Arena of %zu bytes is full, cannot allocate %zu more\n", pArena->cbCapacity, cb);
+        return NULL;
+    }
+
+    pArena->cbUsed = cbOffset + cb;
+    if (pArena->cbUsed > pArena->cbPeak) {
+        pArena->cbPeak = pArena->cbUsed;
+    }
+    return pArena->pBase + cbOffset;
+}
+
+_Check_return_ _Ret_maybenull_
+void* Arena_Alloc(
+    _Inout_ Arena* pArena,
+    _In_    const size_t cb
+) {
+    return Arena_AllocAligned(pArena, cb, ARENA_DEFAULT_ALIGNMENT);
+}
+
+_Check_return_ _Ret_maybenull_
+PSTR Arena_CopyString(
+    _Inout_         Arena* pArena,
+    _In_reads_(cch) const char* pch,
+    _In_            const size_t cch
+) {
+    PSTR pszCopy = Arena_AllocAligned(pArena, cch + 1, 1);
+    if (!pszCopy) {
+        return NULL;
+    }
+
+    memcpy(pszCopy, pch, cch);
+    pszCopy[cch] = '\0';
+    return pszCopy;
+}
+
+void Arena_Reset(
+    _Inout_ Arena* pArena
+) {
+    pArena->cbUsed = 0;
+}
+
+_Check_return_
+ArenaScope Arena_BeginScope(
+    _Inout_ Arena* pArena
+) {
+    return (ArenaScope) { pArena, pArena->cbUsed };
+}
+
+void Arena_EndScope(
+    _In_ const ArenaScope scope
+) {
+    assert(scope.cbMarker <= scope.pArena->cbUsed);
+    scope.pArena->cbUsed = scope.cbMarker;
+}
+
+_Check_return_ _Ret_maybenull_
+Arena* Arena_GetFrame(
+    void
+) {
+    if (!s_pFrameArena) {
+        s_pFrameArena = Arena_Create(ARENA_FRAME_SIZE);
+    }
+    return s_pFrameArena;
+}
+
+void Arena_EndFrame(
+    void
+) {
+    if (s_pFrameArena) {
+        Arena_Reset(s_pFrameArena);
+    }
+}
+
+_Check_return_ _Ret_maybenull_
+Arena* Arena_GetScratch(
+    void
+) {
+    if (!s_pScratchArena) {
+        s_pScratchArena = Arena_Create(ARENA_SCRATCH_SIZE);
+    }
+    return s_pScratchArena;
+}
+
+void Arena_ReleaseScratch(
+    void
+) {
+    if (s_pScratchArena) {
+        Arena_Destroy(s_pScratchArena);
+        s_pScratchArena = NULL;
+    }
+}
+
+void Arena_Shutdown(
+    void
+) {
+    if (s_pFrameArena) {
+        Arena_Destroy(s_pFrameArena);
+        s_pFrameArena = NULL;
+    }
+    Arena_ReleaseScratch();
+}
+
+_Check_return_opt_
+bool Arena_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ Arena* pArena
+) {
+    if (!pArena) {
+        return false;
+    }
+
+    SafeFree(pArena->pBase);
+    SafeFree(pArena);
+    return true;
+}
@@ -0,0 +1,152 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "utils.h"
+
+#define ARENA_DEFAULT_ALIGNMENT 16
+#define ARENA_FRAME_SIZE (4 * 1024 * 1024)    // << Capacity of the frame arena
+#define ARENA_SCRATCH_SIZE (1024 * 1024)      // << Capacity of each thread's scratch arena
+
+/*
+ * Linear allocator for short-lived data. Allocating bumps an offset into one fixed block and nothing is freed
+ * individually; everything goes at once when the arena is reset, or back to a marker when a scope ends. That makes
+ * an allocation a handful of instructions and keeps the general-purpose heap out of per-frame code.
+ *
+ * Two arenas are always available:
+ * - The frame arena, for data that lives until the end of the frame. `Window_Display` resets it, so nothing
+ *   allocated from it may be kept across frames. Main thread only.
+ * - A scratch arena per thread, for temporaries inside a single function. Wrap uses in `Arena_BeginScope` and
+ *   `Arena_EndScope` so callees can use it too without their data outliving them.
+ *
+ * An arena never grows. When it is full, allocations fail with `NULL` like `malloc`.
+ */
+typedef struct _Arena {
+    BYTE* pBase;
+    size_t cbCapacity;
+    size_t cbUsed;
+    size_t cbPeak;             // << Highest `cbUsed` ever reached, for sizing the arena
+} Arena;
+
+/*
+ * Position in an arena to return to. Everything allocated after `Arena_BeginScope` is released by `Arena_EndScope`.
+ */
+typedef struct _ArenaScope {
+    Arena* pArena;
+    size_t cbMarker;
+} ArenaScope;
+
+/**
+ * @brief Creates an arena with a fixed capacity.
+ *
+ * @param cbCapacity Number of bytes the arena can hand out before it is reset.
+ * @return A pointer to the new `Arena`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ Arena* Arena_Create(
+    _In_ size_t cbCapacity
+    );
+
+/**
+ * @brief Allocates memory aligned to `ARENA_DEFAULT_ALIGNMENT`.
+ *
+ * @param pArena Pointer to the `Arena`.
+ * @param cb     Number of bytes.
+ * @return Uninitialised memory, or `NULL` if the arena is full.
+ */
+_Check_return_ _Ret_maybenull_ void* Arena_Alloc(
+    _Inout_ Arena* pArena,
+    _In_    size_t cb
+    );
+
+/**
+ * @brief Allocates memory with a given alignment.
+ *
+ * @param pArena  Pointer to the `Arena`.
+ * @param cb      Number of bytes.
+ * @param cbAlign Alignment in bytes; must be a power of two.
+ * @return Uninitialised memory, or `NULL` if the arena is full.
+ */
+_Check_return_ _Ret_maybenull_ void* Arena_AllocAligned(
+    _Inout_ Arena* pArena,
+    _In_    size_t cb,
+    _In_    size_t cbAlign
+    );
+
+/**
+ * @brief Copies a string into the arena.
+ *
+ * @param pArena Pointer to the `Arena`.
+ * @param pch    Characters to copy; need not be null-terminated.
+ * @param cch    Number of characters.
+ * @return The null-terminated copy, or `NULL` if the arena is full.
+ */
+_Check_return_ _Ret_maybenull_ PSTR Arena_CopyString(
+    _Inout_          Arena* pArena,
+    _In_reads_(cch)  const char* pch,
+    _In_             size_t cch
+    );
+
+/**
+ * @brief Releases everything allocated from the arena.
+ */
+void Arena_Reset(
+    _Inout_ Arena* pArena
+    );
+
+/**
+ * @brief Remembers the arena's current position.
+ */
+_Check_return_ ArenaScope Arena_BeginScope(
+    _Inout_ Arena* pArena
+    );
+
+/**
+ * @brief Releases everything allocated since the matching `Arena_BeginScope`.
+ */
+void Arena_EndScope(
+    _In_ ArenaScope scope
+    );
+
+/**
+ * @brief Gets the frame arena, creating it on first use.
+ *
+ * @return The frame arena, or `NULL` if it could not be created.
+ */
+_Check_return_ _Ret_maybenull_ Arena* Arena_GetFrame(
+    void
+    );
+
+/**
+ * @brief Resets the frame arena. Called by `Window_Display`.
+ */
+void Arena_EndFrame(
+    void
+    );
+
+/**
+ * @brief Gets the calling thread's scratch arena, creating it on first use.
+ *
+ * @return The scratch arena, or `NULL` if it could not be created.
+ */
+_Check_return_ _Ret_maybenull_ Arena* Arena_GetScratch(
+    void
+    );
+
+/**
+ * @brief Frees the calling thread's scratch arena. Call before a thread that used it exits.
+ */
+void Arena_ReleaseScratch(
+    void
+    );
+
+/**
+ * @brief Frees the frame arena and the calling thread's scratch arena. Call once at shutdown.
+ */
+void Arena_Shutdown(
+    void
+    );
+
+_Check_return_opt_ bool Arena_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ Arena* pArena
+    );
+
+#endif //ARENA_H
@@ -0,0 +1,531 @@
+#include "asset-watcher.h"
+
+#include <string.h>
+#include <sys/stat.h>
+#include <SFML/Graphics.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include "file.h"
+#include "texture.h"
+#include "tilemap.h"
+#include "animated-sprite.h"
+#include "profiler.h"
+#include "arena.h"
+
+typedef struct _WatchEntry {
+    UINT uId;
+    AssetKind kind;
+    void* pAsset;
+    INT iIndex;
+    PSTR pszFilename;
+    PCSTR pszBaseName;       // << Points into pszFilename, past the last path separator
+    LONG lModifiedTime;
+    LONG cbSize;
+    INT iWatchDescriptor;    // << inotify watch on the containing directory, or -1
+    bool bDirty;
+} WatchEntry;
+
+typedef struct _PendingReload {
+    UINT uId;
+    AssetKind kind;
+    PSTR pszFilename;
+    union {
+        sfImage* pImage;
+        Layer layer;
+        struct {
+            Animation* arrAnimations;
+            INT nCount;
+        } animations;
+    };
+} PendingReload;
+
+static sfThread* s_pThread;
+static sfMutex* s_pMutex;       // << Guards everything below; NULL while the watcher is stopped
+static bool s_bRunning;
+
+static WatchEntry* s_arrEntries;
+static INT s_nEntries;
+static INT s_nEntriesCapacity;
+static UINT s_uNextId = 1;
+
+static PendingReload* s_arrPending;
+static INT s_nPending;
+static INT s_nPendingCapacity;
+
+#ifdef __linux__
+static int s_iNotifyFd = -1;
+#endif
+
+static void GetFileStamp(
+    _In_z_ PCSTR pszFilename,
+    _Out_  LONG* plModifiedTime,
+    _Out_  LONG* pcbSize
+) {
+#ifdef _WIN32
+    struct _stat64 fileStat;
+    const bool bFound = _stat64(pszFilename, &fileStat) == 0;
+#else
+    struct stat fileStat;
+    const bool bFound = stat(pszFilename, &fileStat) == 0;
+#endif
+
+    *plModifiedTime = bFound ? (LONG)fileStat.st_mtime : 0;
+    *pcbSize = bFound ? (LONG)fileStat.st_size : -1;
+}
+
+_Ret_z_
+static PCSTR GetBaseName(
+    _In_z_ PCSTR pszFilename
+) {
+    PCSTR pszBaseName = pszFilename;
+    for (PCSTR p = pszFilename; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            pszBaseName = p + 1;
+        }
+    }
+    return pszBaseName;
+}
+
+static void FreePayload(
+    _Inout_ PendingReload* pReload
+) {
+    switch (pReload->kind) {
+        case ASSET_KIND_TEXTURE:
+            if (pReload->pImage) {
+                sfImage_destroy(pReload->pImage);
+                pReload->pImage = NULL;
+            }
+            break;
+        case ASSET_KIND_LAYER:
+            SafeFree(pReload->layer.arrTiles);
+            break;
+        case ASSET_KIND_ANIMATIONS:
+            AnimatedSprite_FreeAnimations(pReload->animations.arrAnimations, pReload->animations.nCount);
+            break;
+    }
+    SafeFree(pReload->pszFilename);
+}
+
+_Check_return_
+static bool DecodeAsset(
+    _Inout_ PendingReload* pReload
+) {
+    switch (pReload->kind) {
+        case ASSET_KIND_TEXTURE: {
+            FileView* pView = File_Map(pReload->pszFilename);
+            if (!pView) {
+                return false;
+            }
+            pReload->pImage = sfImage_createFromMemory(FileView_GetData(pView), FileView_GetSize(pView));
+            File_Unmap(pView);
+            return pReload->pImage != NULL;
+        }
+        case ASSET_KIND_LAYER:
+            pReload->layer = Tilemap_ParseLayer(pReload->pszFilename);
+            return pReload->layer.arrTiles != NULL;
+        case ASSET_KIND_ANIMATIONS:
+            return AnimatedSprite_ParseAnimations(
+                pReload->pszFilename,
+                &pReload->animations.arrAnimations,
+                &pReload->animations.nCount
+            );
+    }
+    return false;
+}
+
+static void QueueReload(
+    _In_ const PendingReload* pReload
+) {
+    sfMutex_lock(s_pMutex);
+    if (s_nPending >= s_nPendingCapacity) {
+        const INT nCapacity = s_nPendingCapacity + 8;
+        PendingReload* arrPending = realloc(s_arrPending, nCapacity * sizeof(PendingReload));
+        if (!arrPending) {
+            sfMutex_unlock(s_pMutex);
+            printf("Failed to allocate memory for pending reloads\n");
+            PendingReload reload = *pReload;
+            FreePayload(&reload);
+            return;
+        }
+        s_arrPending = arrPending;
+        s_nPendingCapacity = nCapacity;
+    }
+
+    s_arrPending[s_nPending++] = *pReload;
+    sfMutex_unlock(s_pMutex);
+}
+
+static void ReloadDirtyEntries(
+    void
+) {
+    for (;;) {
+        PendingReload reload = { 0 };
+
+        sfMutex_lock(s_pMutex);
+        for (int i = 0; i < s_nEntries; i++) {
+            if (s_arrEntries[i].bDirty) {
+                s_arrEntries[i].bDirty = false;
+                reload.uId = s_arrEntries[i].uId;
+                reload.kind = s_arrEntries[i].kind;
+                reload.pszFilename = _strdup(s_arrEntries[i].pszFilename);
+                break;
+            }
+        }
+        sfMutex_unlock(s_pMutex);
+
+        if (!reload.uId) {
+            return;
+        }
+        if (!reload.pszFilename) {
+            continue;
+        }
+
+        // Decoding runs without the lock, so the main thread keeps rendering while a large file is read
+        PROFILE_BEGIN("AssetWatcher_Decode");
+        const bool bDecoded = DecodeAsset(&reload);
+        PROFILE_END();
+        if (!bDecoded) {
+            printf("Failed to reload %s, keeping the previous version\n", reload.pszFilename);
+            FreePayload(&reload);
+            continue;
+        }
+
+        QueueReload(&reload);
+    }
+}
+
+_Check_return_
+static bool PollModifiedTimes(
+    void
+) {
+    bool bChanged = false;
+
+    sfMutex_lock(s_pMutex);
+    for (int i = 0; i < s_nEntries; i++) {
+        WatchEntry* pEntry = &s_arrEntries[i];
+
+        LONG lModifiedTime;
+        LONG cbSize;
+        GetFileStamp(pEntry->pszFilename, &lModifiedTime, &cbSize);
+        if (lModifiedTime != pEntry->lModifiedTime || cbSize != pEntry->cbSize) {
+            pEntry->lModifiedTime = lModifiedTime;
+            pEntry->cbSize = cbSize;
+            pEntry->bDirty = cbSize >= 0;
+            bChanged = true;
+        }
+    }
+    sfMutex_unlock(s_pMutex);
+
+    return bChanged;
+}
+
+#ifdef __linux__
+_Check_return_
+static bool WaitForNotifications(
+    void
+) {
+    struct pollfd pollDescriptor = { s_iNotifyFd, POLLIN, 0 };
+    if (poll(&pollDescriptor, 1, ASSET_WATCHER_SETTLE_TIME) <= 0) {
+        return false;
+    }
+
+    _Alignas(struct inotify_event) char buffer[4096];
+    bool bChanged = false;
+
+    for (;;) {
+        const ssize_t cbRead = read(s_iNotifyFd, buffer, sizeof(buffer));
+        if (cbRead <= 0) {
+            break;
+        }
+
+        sfMutex_lock(s_pMutex);
+        for (ssize_t cbOffset = 0; cbOffset < cbRead;) {
+            const struct inotify_event* pEvent = (const struct inotify_event*)(buffer + cbOffset);
+            cbOffset += (ssize_t)(sizeof(struct inotify_event) + pEvent->len);
+
+            if (pEvent->len == 0) {
+                continue;
+            }
+
+            // Editors often save by writing a temporary file and renaming it, so directories are watched
+            for (int i = 0; i < s_nEntries; i++) {
+                if (s_arrEntries[i].iWatchDescriptor == pEvent->wd &&
+                    strcmp(s_arrEntries[i].pszBaseName, pEvent->name) == 0) {
+                    s_arrEntries[i].bDirty = true;
+                    bChanged = true;
+                }
+            }
+        }
+        sfMutex_unlock(s_pMutex);
+    }
+
+    return bChanged;
+}
+
+static INT AddDirectoryWatch(
+    _In_z_ PCSTR pszFilename,
+    _In_z_ PCSTR pszBaseName
+) {
+    if (s_iNotifyFd < 0) {
+        return -1;
+    }
+
+    char szDirectory[4096] = ".";
+    const size_t cchDirectory = (size_t)(pszBaseName - pszFilename);
+    if (cchDirectory > 0 && cchDirectory < sizeof(szDirectory)) {
+        memcpy(szDirectory, pszFilename, cchDirectory);
+        szDirectory[cchDirectory] = '\0';
+    }
+
+    // Adding the same directory twice returns the existing descriptor
+    return inotify_add_watch(s_iNotifyFd, szDirectory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+}
+#endif
+
+static void WatcherThread(
+    void* pUserData
+) {
+    UnusedParam(pUserData);
+
+    for (;;) {
+        sfMutex_lock(s_pMutex);
+        const bool bRunning = s_bRunning;
+        sfMutex_unlock(s_pMutex);
+        if (!bRunning) {
+            // Decoding animations may have created this thread's scratch arena and profiler buffer
+            Arena_ReleaseScratch();
+            PROFILE_THREAD_EXIT();
+            return;
+        }
+
+        // A change restarts the wait, so a file is only decoded once it has stopped changing
+        bool bChanged;
+#ifdef __linux__
+        if (s_iNotifyFd >= 0) {
+            bChanged = WaitForNotifications();
+        } else
+#endif
+        {
+            sfSleep(sfMilliseconds(ASSET_WATCHER_POLL_INTERVAL));
+            bChanged = PollModifiedTimes();
+        }
+
+        if (!bChanged) {
+            ReloadDirtyEntries();
+        }
+    }
+}
+
+_Check_return_opt_
+bool AssetWatcher_Start(
+    void
+) {
+    if (s_pMutex) {
+        return true;
+    }
+
+    s_pMutex = sfMutex_create();
+    if (!s_pMutex) {
+        printf("Failed to create asset watcher mutex\n");
+        return false;
+    }
+
+#ifdef __linux__
+    s_iNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s_iNotifyFd < 0) {
+        printf("inotify is unavailable, polling asset files instead\n");
+    }
+#endif
+
+    s_bRunning = true;
+    s_pThread = sfThread_create(WatcherThread, NULL);
+    if (!s_pThread) {
+        printf("Failed to create asset watcher thread\n");
+        AssetWatcher_Stop();
+        return false;
+    }
+
+    sfThread_launch(s_pThread);
+    return true;
+}
+
+void AssetWatcher_Stop(
+    void
+) {
+    if (!s_pMutex) {
+        return;
+    }
+
+    if (s_pThread) {
+        sfMutex_lock(s_pMutex);
+        s_bRunning = false;
+        sfMutex_unlock(s_pMutex);
+
+        sfThread_wait(s_pThread);
+        sfThread_destroy(s_pThread);
+        s_pThread = NULL;
+    }
+
+#ifdef __linux__
+    if (s_iNotifyFd >= 0) {
+        close(s_iNotifyFd);
+        s_iNotifyFd = -1;
+    }
+#endif
+
+    for (int i = 0; i < s_nEntries; i++) {
+        SafeFree(s_arrEntries[i].pszFilename);
+    }
+    SafeFree(s_arrEntries);
+    s_nEntries = 0;
+    s_nEntriesCapacity = 0;
+
+    for (int i = 0; i < s_nPending; i++) {
+        FreePayload(&s_arrPending[i]);
+    }
+    SafeFree(s_arrPending);
+    s_nPending = 0;
+    s_nPendingCapacity = 0;
+
+    sfMutex_destroy(s_pMutex);
+    s_pMutex = NULL;
+}
+
+void AssetWatcher_Watch(
+    _In_   const AssetKind kind,
+    _In_   void* pAsset,
+    _In_   const INT iIndex,
+    _In_z_ PCSTR pszFilename
+) {
+    if (!s_pMutex) {
+        return;
+    }
+
+    WatchEntry entry = { 0 };
+    entry.kind = kind;
+    entry.pAsset = pAsset;
+    entry.iIndex = iIndex;
+    entry.pszFilename = _strdup(pszFilename);
+    if (!entry.pszFilename) {
+        return;
+    }
+    entry.pszBaseName = GetBaseName(entry.pszFilename);
+    GetFileStamp(entry.pszFilename, &entry.lModifiedTime, &entry.cbSize);
+#ifdef __linux__
+    entry.iWatchDescriptor = AddDirectoryWatch(entry.pszFilename, entry.pszBaseName);
+#else
+    entry.iWatchDescriptor = -1;
+#endif
+
+    sfMutex_lock(s_pMutex);
+    if (s_nEntries >= s_nEntriesCapacity) {
+        const INT nCapacity = s_nEntriesCapacity + 16;
+        WatchEntry* arrEntries = realloc(s_arrEntries, nCapacity * sizeof(WatchEntry));
+        if (!arrEntries) {
+            sfMutex_unlock(s_pMutex);
+            printf("Failed to allocate memory for watched assets\n");
+            SafeFree(entry.pszFilename);
+            return;
+        }
+        s_arrEntries = arrEntries;
+        s_nEntriesCapacity = nCapacity;
+    }
+
+    entry.uId = s_uNextId++;
+    s_arrEntries[s_nEntries++] = entry;
+    sfMutex_unlock(s_pMutex);
+}
+
+void AssetWatcher_Unwatch(
+    _In_ const void* pAsset
+) {
+    if (!s_pMutex) {
+        return;
+    }
+
+    // Reloads already queued for the asset are dropped by AssetWatcher_ApplyPending once their id is gone
+    sfMutex_lock(s_pMutex);
+    INT nKept = 0;
+    for (int i = 0; i < s_nEntries; i++) {
+        if (s_arrEntries[i].pAsset == pAsset) {
+            SafeFree(s_arrEntries[i].pszFilename);
+        } else {
+            s_arrEntries[nKept++] = s_arrEntries[i];
+        }
+    }
+    s_nEntries = nKept;
+    sfMutex_unlock(s_pMutex);
+}
+
+void AssetWatcher_ApplyPending(
+    void
+) {
+    if (!s_pMutex) {
+        return;
+    }
+
+    sfMutex_lock(s_pMutex);
+    if (s_nPending == 0) {
+        sfMutex_unlock(s_pMutex);
+        return;
+    }
+
+    PendingReload* arrPending = s_arrPending;
+    const INT nPending = s_nPending;
+    s_arrPending = NULL;
+    s_nPending = 0;
+    s_nPendingCapacity = 0;
+    sfMutex_unlock(s_pMutex);
+
+    PROFILE_BEGIN("AssetWatcher_ApplyPending");
+    for (int i = 0; i < nPending; i++) {
+        PendingReload* pReload = &arrPending[i];
+
+        // Entries are only added and removed on this thread, so the asset cannot go away after the lookup
+        void* pAsset = NULL;
+        INT iIndex = 0;
+        sfMutex_lock(s_pMutex);
+        for (int j = 0; j < s_nEntries; j++) {
+            if (s_arrEntries[j].uId == pReload->uId) {
+                pAsset = s_arrEntries[j].pAsset;
+                iIndex = s_arrEntries[j].iIndex;
+                break;
+            }
+        }
+        sfMutex_unlock(s_pMutex);
+
+        if (!pAsset) {
+            FreePayload(pReload);
+            continue;
+        }
+
+        switch (pReload->kind) {
+            case ASSET_KIND_TEXTURE:
+                Texture_ReloadFromImage(pAsset, pReload->pImage);
+                break;
+            case ASSET_KIND_LAYER:
+                Tilemap_ReplaceLayer(pAsset, iIndex, pReload->layer);
+                pReload->layer.arrTiles = NULL;
+                break;
+            case ASSET_KIND_ANIMATIONS:
+                AnimatedSprite_ReplaceAnimations(
+                    pAsset,
+                    pReload->animations.arrAnimations,
+                    pReload->animations.nCount
+                );
+                pReload->animations.arrAnimations = NULL;
+                break;
+        }
+
+        printf("Reloaded %s\n", pReload->pszFilename);
+        FreePayload(pReload);
+    }
+    PROFILE_END();
+
+    SafeFree(arrPending);
+}
@@ -0,0 +1,77 @@
+#ifndef ASSET_WATCHER_H
+#define ASSET_WATCHER_H
+
+#include "utils.h"
+
+#define ASSET_WATCHER_SETTLE_TIME 100   // << Milliseconds without further changes before a file is reloaded
+#define ASSET_WATCHER_POLL_INTERVAL 250 // << Milliseconds between modification time checks without inotify
+
+typedef enum _AssetKind {
+    ASSET_KIND_TEXTURE,     // << pAsset is a Texture*
+    ASSET_KIND_LAYER,       // << pAsset is a Tilemap*, iIndex the layer
+    ASSET_KIND_ANIMATIONS   // << pAsset is an AnimatedSprite*
+} AssetKind;
+
+/*
+ * Hot reloading of content files while the game runs.
+ *
+ * The loaders register every file they read. A background thread waits for changes (inotify on Linux, polling
+ * modification times elsewhere), decodes the changed file and queues the result. `AssetWatcher_ApplyPending`
+ * swaps the queued results into the live assets on the main thread, so an asset never changes in the middle of
+ * a frame and only the asset whose file changed is touched.
+ */
+
+/**
+ * @brief Starts the watcher thread.
+ *
+ * Files loaded before this call are not watched, so start the watcher before loading content.
+ *
+ * @return `true` if the watcher is running.
+ */
+_Check_return_opt_ bool AssetWatcher_Start(
+    void
+    );
+
+/**
+ * @brief Stops the watcher thread and drops all registrations and pending reloads.
+ */
+void AssetWatcher_Stop(
+    void
+    );
+
+/**
+ * @brief Registers a loaded asset for hot reloading.
+ *
+ * Does nothing if the watcher is not running. The same asset may be registered for several files.
+ *
+ * @param kind        What `pAsset` points to.
+ * @param pAsset      The live asset to update when the file changes.
+ * @param iIndex      Kind specific index, the layer index for `ASSET_KIND_LAYER`.
+ * @param pszFilename Path the asset was loaded from.
+ */
+void AssetWatcher_Watch(
+    _In_   AssetKind kind,
+    _In_   void* pAsset,
+    _In_   INT iIndex,
+    _In_z_ PCSTR pszFilename
+    );
+
+/**
+ * @brief Removes all registrations of an asset. Must be called before the asset is freed.
+ *
+ * @param pAsset The asset passed to `AssetWatcher_Watch`.
+ */
+void AssetWatcher_Unwatch(
+    _In_ const void* pAsset
+    );
+
+/**
+ * @brief Swaps every reload that finished decoding into its asset.
+ *
+ * Call once per frame on the main thread, outside of drawing.
+ */
+void AssetWatcher_ApplyPending(
+    void
+    );
+
+#endif //ASSET_WATCHER_H
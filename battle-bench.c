@@ -0,0 +1,193 @@
+#include <SFML/System.h>
+
+#include "utils.h"
+#include "terrain.h"
+#include "unit-state.h"
+#include "job-system.h"
+#include "ai-evaluator.h"
+#include "battle-sim.h"
+
+/*
+ * Plays generated AI-versus-AI battles without a window and reports the throughput.
+ *
+ *   battle-bench [battles] [units per side] [map size] [threads] [seed]
+ *
+ * Every battle gets its own seeded map and armies: faction 0 deploys on the left quarter of the map, faction 1
+ * on the right quarter. The checksum covers the outcome of every battle, so it must stay the same for any
+ * thread count, and only changes with the seed or when the rules or the AI change.
+ */
+
+#define BENCH_DEFAULT_BATTLES 200
+#define BENCH_DEFAULT_UNITS 32
+#define BENCH_DEFAULT_SIZE 48
+#define BENCH_MAX_TURNS 400
+#define BENCH_FACTIONS 2
+
+static UINT s_uRandomState;
+
+_Check_return_
+static UINT NextRandom(
+    void
+) {
+    // xorshift32, so every platform generates the same battles
+    s_uRandomState ^= s_uRandomState << 13;
+    s_uRandomState ^= s_uRandomState >> 17;
+    s_uRandomState ^= s_uRandomState << 5;
+    return s_uRandomState;
+}
+
+static void GenerateTerrain(
+    _Inout_ TerrainMap* pTerrain
+) {
+    for (INT i = 0; i < pTerrain->nWidth * pTerrain->nHeight; i++) {
+        const UINT uRoll = NextRandom() % 100;
+        pTerrain->arrCosts[i] = uRoll < 75 ? 1 : uRoll < 90 ? 2 : uRoll < 95 ? 3 : TERRAIN_COST_IMPASSABLE;
+    }
+}
+
+_Check_return_
+static bool DeployArmy(
+    _Inout_ BattleSim* pSim,
+    _In_    const INT iFaction,
+    _In_    const INT nUnits
+) {
+    const TerrainMap* pTerrain = pSim->pTerrain;
+    const INT nZoneWidth = pTerrain->nWidth / 4 > 0 ? pTerrain->nWidth / 4 : 1;
+    const INT xZone = iFaction == 0 ? 0 : pTerrain->nWidth - nZoneWidth;
+
+    for (INT i = 0; i < nUnits; i++) {
+        UnitState state = { 0 };
+        state.nHp = 10 + (INT)(NextRandom() % 21);
+        state.nAttack = 4 + (INT)(NextRandom() % 9);
+        state.nDefense = (INT)(NextRandom() % 6);
+        state.nMoveSpeed = 3 + (INT)(NextRandom() % 4);
+        state.nAttackRange = NextRandom() % 4 == 0 ? 2 + (INT)(NextRandom() % 2) : 1; // << One in four shoots
+
+        // Retry until the unit lands on an open tile; gives up on zones too crowded to hold the army
+        INT nAttempts = 0;
+        do {
+            if (++nAttempts > 1000) {
+                return false;
+            }
+            state.ptTilePosition.x = xZone + (INT)(NextRandom() % (UINT)nZoneWidth);
+            state.ptTilePosition.y = (INT)(NextRandom() % (UINT)pTerrain->nHeight);
+        } while (TerrainMap_GetCost(pTerrain, state.ptTilePosition) == TERRAIN_COST_IMPASSABLE ||
+            !BattleSim_AddUnit(pSim, &state, iFaction));
+    }
+
+    return true;
+}
+
+_Check_return_
+static UINT HashOutcome(
+    _In_ UINT uHash,
+    _In_ const BattleSim* pSim,
+    _In_ const INT iWinner
+) {
+    // FNV-1a over the winner, the turn count and every survivor
+    const INT arrHeader[2] = { iWinner, pSim->nTurns };
+    for (INT i = 0; i < 2; i++) {
+        uHash = (uHash ^ (UINT)arrHeader[i]) * 16777619u;
+    }
+    for (INT i = 0; i < pSim->pSnapshot->nUnits; i++) {
+        const UnitState* pState = &pSim->pSnapshot->arrUnits[i].state;
+        uHash = (uHash ^ (UINT)pState->ptTilePosition.x) * 16777619u;
+        uHash = (uHash ^ (UINT)pState->ptTilePosition.y) * 16777619u;
+        uHash = (uHash ^ (UINT)pState->nHp) * 16777619u;
+    }
+    return uHash;
+}
+
+/**
+ * Plays every battle and prints the report.
+ *
+ * @return `false` if the map was too small to deploy the armies.
+ */
+_Check_return_
+static bool RunBattles(
+    _Inout_ BattleSim* pSim,
+    _Inout_ TerrainMap* pTerrain,
+    _In_    const JobSystem* pJobs,
+    _In_    const INT nBattles,
+    _In_    const INT nUnits,
+    _In_    const UINT uSeed
+) {
+    INT arrWins[BENCH_FACTIONS] = { 0 };
+    INT nDraws = 0;
+    INT64 lTotalTurns = 0;
+    INT64 lTotalTime = 0;
+    UINT uChecksum = 2166136261u;
+    sfClock* pClock = sfClock_create();
+
+    for (INT iBattle = 0; iBattle < nBattles; iBattle++) {
+        // Each battle has its own seed, so a single battle can be replayed on its own
+        s_uRandomState = uSeed + (UINT)iBattle * 0x9E3779B9u;
+        if (s_uRandomState == 0) {
+            s_uRandomState = 1;
+        }
+
+        BattleSim_Reset(pSim);
+        GenerateTerrain(pTerrain);
+        if (!DeployArmy(pSim, 0, nUnits) || !DeployArmy(pSim, 1, nUnits)) {
+            printf("Map %dx%d is too small for %d units per side\n", pTerrain->nWidth, pTerrain->nHeight, nUnits);
+            sfClock_destroy(pClock);
+            return false;
+        }
+
+        sfClock_restart(pClock);
+        const INT iWinner = BattleSim_Run(pSim, BENCH_MAX_TURNS);
+        lTotalTime += sfTime_asMicroseconds(sfClock_getElapsedTime(pClock));
+
+        if (iWinner >= 0) {
+            arrWins[iWinner]++;
+        } else {
+            nDraws++;
+        }
+        lTotalTurns += pSim->nTurns;
+        uChecksum = HashOutcome(uChecksum, pSim, iWinner);
+    }
+
+    sfClock_destroy(pClock);
+
+    const DOUBLE fSeconds = (DOUBLE)lTotalTime / 1000000.0;
+    printf("map          %dx%d\n", pTerrain->nWidth, pTerrain->nHeight);
+    printf("threads      %d\n", JobSystem_GetThreadCount(pJobs));
+    printf("battles      %d (%d units per side)\n", nBattles, nUnits);
+    printf("outcome      %d / %d wins, %d draws\n", arrWins[0], arrWins[1], nDraws);
+    printf("avg turns    %.1f\n", (DOUBLE)lTotalTurns / nBattles);
+    printf("total time   %.3f s\n", fSeconds);
+    printf("battles/s    %.1f\n", fSeconds > 0.0 ? nBattles / fSeconds : 0.0);
+    printf("turns/s      %.0f\n", fSeconds > 0.0 ? (DOUBLE)lTotalTurns / fSeconds : 0.0);
+    printf("checksum     %08x\n", uChecksum);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const INT nBattles = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_BATTLES;
+    const INT nUnits = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_UNITS;
+    const INT nSize = argc > 3 ? atoi(argv[3]) : BENCH_DEFAULT_SIZE;
+    const INT nThreads = argc > 4 ? atoi(argv[4]) : 0;
+    const UINT uSeed = argc > 5 ? (UINT)strtoul(argv[5], NULL, 10) : 0x2545F491u;
+
+    if (nBattles <= 0 || nUnits <= 0 || nSize < 4 || nThreads < 0) {
+        printf("Usage: %s [battles] [units per side] [map size] [threads] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    TerrainMap* pTerrain = TerrainMap_Create(nSize, nSize);
+    JobSystem* pJobs = JobSystem_Create(nThreads);
+    BattleSim* pSim = pTerrain && pJobs ? BattleSim_Create(pJobs, pTerrain, BENCH_FACTIONS) : NULL;
+
+    // Failures fall through to the same cleanup as a finished run
+    INT iExitCode = 1;
+    if (!pSim) {
+        printf("Failed to allocate benchmark state\n");
+    } else if (RunBattles(pSim, pTerrain, pJobs, nBattles, nUnits, uSeed)) {
+        iExitCode = 0;
+    }
+
+    BattleSim_Destroy(pSim);
+    JobSystem_Destroy(pJobs);
+    TerrainMap_Destroy(pTerrain);
+    return iExitCode;
+}
@@ -0,0 +1,198 @@
+#include "battle-sim.h"
+
+#include "terrain.h"
+#include "ai-evaluator.h"
+
+_Check_return_ _Ret_maybenull_
+BattleSim* BattleSim_Create(
+    _In_ JobSystem* pJobs,
+    _In_ const TerrainMap* pTerrain,
+    _In_ const INT nFactions
+) {
+    if (nFactions < 2 || nFactions > BATTLE_MAX_FACTIONS) {
+        printf("Battles need 2 to %d factions, got %d\n", BATTLE_MAX_FACTIONS, nFactions);
+        return NULL;
+    }
+
+    BattleSim* pSim = calloc(1, sizeof(BattleSim));
+    if (!pSim) {
+        printf("Failed to allocate memory for BattleSim\n");
+        return NULL;
+    }
+
+    pSim->pTerrain = pTerrain;
+    pSim->nFactions = nFactions;
+    pSim->pSnapshot = AiSnapshot_Create(pTerrain);
+    pSim->pEvaluator = AiEvaluator_Create(pJobs, pTerrain->nWidth, pTerrain->nHeight);
+    if (!pSim->pSnapshot || !pSim->pEvaluator) {
+        BattleSim_Destroy(pSim);
+        return NULL;
+    }
+
+    return pSim;
+}
+
+void BattleSim_Reset(
+    _Inout_ BattleSim* pSim
+) {
+    AiSnapshot_Clear(pSim->pSnapshot);
+    for (INT i = 0; i < pSim->nFactions; i++) {
+        pSim->arrUnitCounts[i] = 0;
+    }
+    pSim->iActiveFaction = 0;
+    pSim->nTurns = 0;
+}
+
+_Check_return_opt_
+bool BattleSim_AddUnit(
+    _Inout_ BattleSim* pSim,
+    _In_    const UnitState* pState,
+    _In_    const INT iFaction
+) {
+    if (iFaction < 0 || iFaction >= pSim->nFactions || pState->nHp <= 0) {
+        return false;
+    }
+
+    if (AiSnapshot_AddUnit(pSim->pSnapshot, pState, iFaction, NULL) < 0) {
+        return false;
+    }
+
+    pSim->arrUnitCounts[iFaction]++;
+    return true;
+}
+
+_Check_return_
+INT BattleSim_GetWinner(
+    _In_ const BattleSim* pSim
+) {
+    INT iWinner = -1;
+    for (INT i = 0; i < pSim->nFactions; i++) {
+        if (pSim->arrUnitCounts[i] > 0) {
+            if (iWinner >= 0) {
+                return -1;
+            }
+            iWinner = i;
+        }
+    }
+    return iWinner;
+}
+
+static void ApplyAction(
+    _Inout_ BattleSim* pSim,
+    _In_    const AiAction* pAction
+) {
+    AiSnapshot* pSnapshot = pSim->pSnapshot;
+    AiUnitState* pUnit = &pSnapshot->arrUnits[pAction->iUnit];
+    const INT nWidth = pSnapshot->nWidth;
+
+    const POINT ptFrom = pUnit->state.ptTilePosition;
+    const POINT ptTo = pAction->ptMoveTo;
+    if (!Point_IsEqual(&ptFrom, &ptTo) && pSnapshot->arrOccupants[ptTo.y * nWidth + ptTo.x] < 0) {
+        pSnapshot->arrOccupants[ptFrom.y * nWidth + ptFrom.x] = -1;
+        pSnapshot->arrOccupants[ptTo.y * nWidth + ptTo.x] = pAction->iUnit;
+        pUnit->state.ptTilePosition = ptTo;
+    }
+
+    if (pAction->iTarget < 0) {
+        return;
+    }
+
+    AiUnitState* pTarget = &pSnapshot->arrUnits[pAction->iTarget];
+    if (pTarget->state.nHp <= 0 ||
+        !UnitState_CanAttackFrom(&pUnit->state, pUnit->state.ptTilePosition, pTarget->state.ptTilePosition)) {
+        return;
+    }
+
+    pTarget->state.nHp -= UnitState_GetDamage(&pUnit->state, &pTarget->state);
+    if (pTarget->state.nHp <= 0) {
+        const POINT ptTarget = pTarget->state.ptTilePosition;
+        pSnapshot->arrOccupants[ptTarget.y * nWidth + ptTarget.x] = -1;
+        pSim->arrUnitCounts[pTarget->iFaction]--;
+    }
+}
+
+static void RemoveDeadUnits(
+    _Inout_ AiSnapshot* pSnapshot
+) {
+    // Dead units already left their tiles; the survivors move down and their tiles are renumbered
+    INT nAlive = 0;
+    for (INT i = 0; i < pSnapshot->nUnits; i++) {
+        if (pSnapshot->arrUnits[i].state.nHp <= 0) {
+            continue;
+        }
+
+        const POINT ptTile = pSnapshot->arrUnits[i].state.ptTilePosition;
+        pSnapshot->arrUnits[nAlive] = pSnapshot->arrUnits[i];
+        pSnapshot->arrOccupants[ptTile.y * pSnapshot->nWidth + ptTile.x] = nAlive;
+        nAlive++;
+    }
+    pSnapshot->nUnits = nAlive;
+}
+
+_Check_return_opt_
+bool BattleSim_PlayTurn(
+    _Inout_ BattleSim* pSim
+) {
+    if (BattleSim_GetWinner(pSim) >= 0 || pSim->pSnapshot->nUnits == 0) {
+        return false;
+    }
+
+    if (pSim->pSnapshot->nUnits > pSim->nActionsCapacity) {
+        AiAction* arrActions = realloc(pSim->arrActions, pSim->pSnapshot->nUnits * sizeof(AiAction));
+        if (!arrActions) {
+            printf("Failed to allocate memory for battle actions\n");
+            return false;
+        }
+        pSim->arrActions = arrActions;
+        pSim->nActionsCapacity = pSim->pSnapshot->nUnits;
+    }
+
+    const INT nActions = AiEvaluator_Evaluate(
+        pSim->pEvaluator,
+        pSim->pSnapshot,
+        pSim->iActiveFaction,
+        pSim->arrActions,
+        pSim->nActionsCapacity
+    );
+    if (nActions < 0) {
+        return false;
+    }
+
+    for (INT i = 0; i < nActions; i++) {
+        ApplyAction(pSim, &pSim->arrActions[i]);
+    }
+    RemoveDeadUnits(pSim->pSnapshot);
+
+    // Factions without units left are skipped
+    do {
+        pSim->iActiveFaction = (pSim->iActiveFaction + 1) % pSim->nFactions;
+    } while (pSim->arrUnitCounts[pSim->iActiveFaction] == 0);
+
+    pSim->nTurns++;
+    return true;
+}
+
+_Check_return_opt_
+INT BattleSim_Run(
+    _Inout_ BattleSim* pSim,
+    _In_    const INT nMaxTurns
+) {
+    while (pSim->nTurns < nMaxTurns && BattleSim_PlayTurn(pSim)) {
+    }
+    return BattleSim_GetWinner(pSim);
+}
+
+_Check_return_opt_
+bool BattleSim_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ BattleSim* pSim
+) {
+    if (!pSim) {
+        return false;
+    }
+
+    AiEvaluator_Destroy(pSim->pEvaluator);
+    AiSnapshot_Destroy(pSim->pSnapshot);
+    SafeFree(pSim->arrActions);
+    SafeFree(pSim);
+    return true;
+}
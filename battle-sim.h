@@ -0,0 +1,116 @@
+#ifndef BATTLE_SIM_H
+#define BATTLE_SIM_H
+
+#include "utils.h"
+#include "unit-state.h"
+
+typedef struct _TerrainMap TerrainMap;
+typedef struct _JobSystem JobSystem;
+typedef struct _AiSnapshot AiSnapshot;
+typedef struct _AiEvaluator AiEvaluator;
+typedef struct _AiAction AiAction;
+
+#define BATTLE_MAX_FACTIONS 8
+
+/*
+ * Headless AI-versus-AI battle on a terrain map, for balance testing without a window.
+ *
+ * Units exist only as `UnitState`s inside an `AiSnapshot`, which the AI scores against directly. Factions take
+ * turns in order: the AI picks an action for every unit of the active faction, and the actions are applied one
+ * after another. A unit whose tile was taken by an earlier mover stays where it is, and an attack only lands if
+ * the target is still alive and in range. Dead units are removed at the end of each turn.
+ *
+ * The AI is deterministic for any number of job threads, so the same setup always plays out the same battle.
+ */
+typedef struct _BattleSim {
+    const TerrainMap* pTerrain;
+    AiSnapshot* pSnapshot;     // << Live state of every unit on the field
+    AiEvaluator* pEvaluator;
+    AiAction* arrActions;
+    INT nActionsCapacity;
+    INT nFactions;
+    INT arrUnitCounts[BATTLE_MAX_FACTIONS]; // << Living units per faction
+    INT iActiveFaction;        // << Faction that plays the next turn
+    INT nTurns;                // << Turns played since the last reset, one per faction move
+} BattleSim;
+
+/**
+ * @brief Creates a battle simulator for a terrain map.
+ *
+ * @param pJobs     Job system the AI runs on; it must outlive the simulator.
+ * @param pTerrain  Terrain to fight on. Its costs may change between battles, but not its size.
+ * @param nFactions Number of factions, from 2 to `BATTLE_MAX_FACTIONS`.
+ * @return A pointer to the new `BattleSim`, or `NULL` if it could not be created.
+ */
+_Check_return_ _Ret_maybenull_ BattleSim* BattleSim_Create(
+    _In_ JobSystem* pJobs,
+    _In_ const TerrainMap* pTerrain,
+    _In_ INT nFactions
+    );
+
+/**
+ * @brief Removes every unit and sets the turn counter back to zero, ready for a new battle.
+ *
+ * @param pSim Pointer to the `BattleSim`.
+ */
+void BattleSim_Reset(
+    _Inout_ BattleSim* pSim
+    );
+
+/**
+ * @brief Adds a unit to the battle.
+ *
+ * @param pSim     Pointer to the `BattleSim`.
+ * @param pState   State of the unit. Its tile must be on the map and free.
+ * @param iFaction Faction of the unit.
+ * @return `true` if the unit was added, `false` if its tile or faction is invalid or the allocation failed.
+ */
+_Check_return_opt_ bool BattleSim_AddUnit(
+    _Inout_ BattleSim* pSim,
+    _In_    const UnitState* pState,
+    _In_    INT iFaction
+    );
+
+/**
+ * @brief Plays the turn of the active faction.
+ *
+ * @param pSim Pointer to the `BattleSim`.
+ * @return `true` if a turn was played, `false` if the battle is already over or the AI failed.
+ */
+_Check_return_opt_ bool BattleSim_PlayTurn(
+    _Inout_ BattleSim* pSim
+    );
+
+/**
+ * @brief Gets the winner of the battle.
+ *
+ * @param pSim Pointer to the `BattleSim`.
+ * @return The only faction with units left, or `-1` while several factions remain or none does.
+ */
+_Check_return_ INT BattleSim_GetWinner(
+    _In_ const BattleSim* pSim
+    );
+
+/**
+ * @brief Plays turns until one faction is left or a turn limit is reached.
+ *
+ * @param pSim      Pointer to the `BattleSim`.
+ * @param nMaxTurns Turns after which the battle counts as a draw.
+ * @return The winning faction, or `-1` for a draw.
+ */
+_Check_return_opt_ INT BattleSim_Run(
+    _Inout_ BattleSim* pSim,
+    _In_    INT nMaxTurns
+    );
+
+/**
+ * @brief Destroys a battle simulator and frees its resources.
+ *
+ * @param pSim Pointer to the `BattleSim` to destroy.
+ * @return `true` if the simulator was destroyed, `false` if `pSim` was `NULL`.
+ */
+_Check_return_opt_ bool BattleSim_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ BattleSim* pSim
+    );
+
+#endif //BATTLE_SIM_H
@@ -0,0 +1,331 @@
+#include "binary-reader.h"
+
+#include <string.h>
+
+#include "file.h"
+
+_Check_return_ _Ret_maybenull_
+BinaryReader* BinaryReader_Create(
+    _In_ File* pFile
+) {
+    if (!File_IsOpen(pFile)) {
+        return NULL;
+    }
+
+    BinaryReader* pReader = malloc(sizeof(BinaryReader));
+    if (!pReader) {
+        printf("Failed to allocate memory for BinaryReader\n");
+        return NULL;
+    }
+
+    // Pack entries are already in memory, read them in place
+    if (pFile->pMemory) {
+        pReader->pFile = pFile;
+        pReader->pBuffer = NULL;
+        pReader->pCursor = pFile->pMemory + pFile->cbPosition;
+        pReader->pEnd = pFile->pMemory + pFile->cbSize;
+        pReader->bOwnsFile = false;
+        pReader->bError = false;
+        return pReader;
+    }
+
+    pReader->pBuffer = malloc(BINARY_READER_BUFFER_SIZE);
+    if (!pReader->pBuffer) {
+        printf("Failed to allocate memory for BinaryReader buffer\n");
+        SafeFree(pReader);
+        return NULL;
+    }
+
+    pReader->pFile = pFile;
+    pReader->pCursor = pReader->pBuffer;
+    pReader->pEnd = pReader->pBuffer;
+    pReader->bOwnsFile = false;
+    pReader->bError = false;
+
+    return pReader;
+}
+
+_Check_return_ _Ret_maybenull_
+BinaryReader* BinaryReader_Open(
+    _In_z_ PCSTR pszFilename
+) {
+    File* pFile = File_OpenBinary(pszFilename);
+    if (!pFile) {
+        return NULL;
+    }
+
+    BinaryReader* pReader = BinaryReader_Create(pFile);
+    if (!pReader) {
+        File_Close(pFile);
+        return NULL;
+    }
+
+    pReader->bOwnsFile = true;
+    return pReader;
+}
+
+_Check_return_ _Ret_maybenull_
+BinaryReader* BinaryReader_CreateFromMemory(
+    _In_reads_bytes_(cbSize) const void* pData,
+    _In_                     const ULONG cbSize
+) {
+    BinaryReader* pReader = malloc(sizeof(BinaryReader));
+    if (!pReader) {
+        printf("Failed to allocate memory for BinaryReader\n");
+        return NULL;
+    }
+
+    pReader->pFile = NULL;
+    pReader->pBuffer = NULL;
+    pReader->pCursor = pData;
+    pReader->pEnd = (const BYTE*)pData + cbSize;
+    pReader->bOwnsFile = false;
+    pReader->bError = false;
+
+    return pReader;
+}
+
+_Check_return_
+bool BinaryReader_Refill(
+    _Inout_ BinaryReader* pReader,
+    _In_    const ULONG cbNeeded
+) {
+    if (pReader->bError) {
+        return false;
+    }
+
+    if (!pReader->pBuffer || cbNeeded > BINARY_READER_BUFFER_SIZE) {
+        pReader->bError = true;
+        return false;
+    }
+
+    const ULONG cbRemaining = (ULONG)(pReader->pEnd - pReader->pCursor);
+    memmove(pReader->pBuffer, pReader->pCursor, cbRemaining);
+
+    const ULONG cbRead = fread(
+        pReader->pBuffer + cbRemaining,
+        sizeof(BYTE),
+        BINARY_READER_BUFFER_SIZE - cbRemaining,
+        pReader->pFile->pFileHandle
+    );
+
+    pReader->pCursor = pReader->pBuffer;
+    pReader->pEnd = pReader->pBuffer + cbRemaining + cbRead;
+
+    if (cbRemaining + cbRead < cbNeeded) {
+        pReader->bError = true;
+        return false;
+    }
+
+    return true;
+}
+
+_Check_return_opt_
+bool BinaryReader_ReadBytes(
+    _Inout_                    BinaryReader* pReader,
+    _Out_writes_bytes_(cbSize) void* pDest,
+    _In_                       const ULONG cbSize
+) {
+    if (pReader->bError) {
+        return false;
+    }
+
+    const ULONG cbBuffered = (ULONG)(pReader->pEnd - pReader->pCursor);
+    if (cbBuffered >= cbSize) {
+        memcpy(pDest, pReader->pCursor, cbSize);
+        pReader->pCursor += cbSize;
+        return true;
+    }
+
+    if (!pReader->pBuffer) {
+        pReader->bError = true;
+        return false;
+    }
+
+    memcpy(pDest, pReader->pCursor, cbBuffered);
+    pReader->pCursor = pReader->pEnd;
+
+    BYTE* pRest = (BYTE*)pDest + cbBuffered;
+    const ULONG cbRest = cbSize - cbBuffered;
+
+    // Small tails go through the buffer so the following reads stay cheap
+    if (cbRest < BINARY_READER_BUFFER_SIZE / 2) {
+        if (!BinaryReader_Refill(pReader, cbRest)) {
+            return false;
+        }
+        memcpy(pRest, pReader->pCursor, cbRest);
+        pReader->pCursor += cbRest;
+        return true;
+    }
+
+    if (fread(pRest, sizeof(BYTE), cbRest, pReader->pFile->pFileHandle) != cbRest) {
+        pReader->bError = true;
+        return false;
+    }
+
+    return true;
+}
+
+_Check_return_opt_
+bool BinaryReader_ReadArray(
+    _Inout_ BinaryReader* pReader,
+    _Out_   void* pDest,
+    _In_    const ULONG cbElement,
+    _In_    const ULONG nCount
+) {
+    if (!BinaryReader_ReadBytes(pReader, pDest, cbElement * nCount)) {
+        return false;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    BYTE* pBytes = pDest;
+    for (ULONG i = 0; i < nCount; i++) {
+        BYTE* pElement = pBytes + i * cbElement;
+        for (ULONG j = 0; j < cbElement / 2; j++) {
+            const BYTE byTemp = pElement[j];
+            pElement[j] = pElement[cbElement - 1 - j];
+            pElement[cbElement - 1 - j] = byTemp;
+        }
+    }
+#endif
+
+    return true;
+}
+
+_Check_return_opt_
+ULONG BinaryReader_ReadString(
+    _Inout_                 BinaryReader* pReader,
+    _Out_writes_(cchBuffer) PSTR pszBuffer,
+    _In_                    const ULONG cchBuffer
+) {
+    if (cchBuffer == 0) {
+        pReader->bError = true;
+        return 0;
+    }
+
+    pszBuffer[0] = '\0';
+
+    const UINT64 cchString = BinaryReader_ReadVarUInt(pReader);
+    if (pReader->bError) {
+        return 0;
+    }
+
+    if (cchString >= cchBuffer) {
+        BinaryReader_Skip(pReader, (ULONG)cchString);
+        pReader->bError = true;
+        return 0;
+    }
+
+    if (!BinaryReader_ReadBytes(pReader, pszBuffer, (ULONG)cchString)) {
+        return 0;
+    }
+
+    pszBuffer[cchString] = '\0';
+    return (ULONG)cchString;
+}
+
+_Check_return_ _Ret_maybenull_
+PSTR BinaryReader_ReadStringAlloc(
+    _Inout_   BinaryReader* pReader,
+    _Out_opt_ ULONG* pcchBufferSize
+) {
+    const UINT64 cchString = BinaryReader_ReadVarUInt(pReader);
+    if (pReader->bError || cchString >= UINT32_MAX) {
+        pReader->bError = true;
+        return NULL;
+    }
+
+    PSTR pszString = malloc(cchString + 1);
+    if (!pszString) {
+        pReader->bError = true;
+        return NULL;
+    }
+
+    if (!BinaryReader_ReadBytes(pReader, pszString, (ULONG)cchString)) {
+        SafeFree(pszString);
+        return NULL;
+    }
+
+    pszString[cchString] = '\0';
+    if (pcchBufferSize != NULL) {
+        *pcchBufferSize = cchString;
+    }
+
+    return pszString;
+}
+
+_Check_return_opt_
+bool BinaryReader_Skip(
+    _Inout_ BinaryReader* pReader,
+    _In_    const ULONG cbSize
+) {
+    if (pReader->bError) {
+        return false;
+    }
+
+    const ULONG cbBuffered = (ULONG)(pReader->pEnd - pReader->pCursor);
+    if (cbBuffered >= cbSize) {
+        pReader->pCursor += cbSize;
+        return true;
+    }
+
+    if (!pReader->pBuffer) {
+        pReader->bError = true;
+        return false;
+    }
+
+    // fseek happily moves past the end of the file, so check against its size like a short read would
+    const long lPosition = ftell(pReader->pFile->pFileHandle);
+    const LONG cbLeftInFile = lPosition < 0 ? -1 : pReader->pFile->cbSize - (LONG)lPosition;
+    const ULONG cbUnbuffered = cbSize - cbBuffered;
+    if (cbLeftInFile < 0 || cbUnbuffered > (ULONG)cbLeftInFile) {
+        pReader->bError = true;
+        return false;
+    }
+
+    pReader->pCursor = pReader->pEnd;
+    if (fseek(pReader->pFile->pFileHandle, (long)cbUnbuffered, SEEK_CUR) != 0) {
+        pReader->bError = true;
+        return false;
+    }
+
+    return true;
+}
+
+_Check_return_
+bool BinaryReader_IsEof(
+    _Inout_ BinaryReader* pReader
+) {
+    if (pReader->pCursor < pReader->pEnd) {
+        return false;
+    }
+
+    if (!pReader->pBuffer || pReader->bError) {
+        return true;
+    }
+
+    // A failed refill only means there is nothing left, it is not an error here
+    if (!BinaryReader_Refill(pReader, 1)) {
+        pReader->bError = false;
+        return true;
+    }
+
+    return false;
+}
+
+_Check_return_opt_
+bool BinaryReader_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ BinaryReader* pReader
+) {
+    if (!pReader) {
+        return false;
+    }
+
+    if (pReader->bOwnsFile) {
+        File_Close(pReader->pFile);
+    }
+
+    SafeFree(pReader->pBuffer);
+    SafeFree(pReader);
+    return true;
+}
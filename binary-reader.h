@@ -0,0 +1,319 @@
+#ifndef BINARY_READER_H
+#define BINARY_READER_H
+
+#include <string.h>
+
+#include "utils.h"
+
+typedef struct _File File;
+
+#define BINARY_READER_BUFFER_SIZE (64 * 1024)
+
+typedef struct _BinaryReader {
+    File* pFile;          // << Backing file, NULL for readers created from memory
+    const BYTE* pCursor;  // << Next unread byte
+    const BYTE* pEnd;     // << One past the last buffered byte
+    BYTE* pBuffer;        // << Refill buffer, NULL when the data is read in place
+    bool bOwnsFile;       // << Close pFile on destroy?
+    bool bError;          // << Sticky flag set by short reads and malformed data
+} BinaryReader;
+
+/**
+ * @brief Creates a binary reader on top of an already opened file.
+ *
+ * The reader pulls the file into an internal buffer of `BINARY_READER_BUFFER_SIZE` bytes and serves all reads
+ * from it, so reading many small values costs one `fread` per buffer instead of one per value. The file should
+ * be opened with `File_OpenBinary`, otherwise line endings may be translated on some platforms.
+ *
+ * @param pFile Pointer to the `File` to read from. The reader does not take ownership of it.
+ * @return A pointer to the new `BinaryReader`, or `NULL` if the creation failed.
+ */
+_Check_return_ _Ret_maybenull_ BinaryReader* BinaryReader_Create(
+    _In_ File* pFile
+    );
+
+/**
+ * @brief Opens a file in binary mode and creates a reader that owns it.
+ *
+ * @param pszFilename Path to the file to read.
+ * @return A pointer to the new `BinaryReader`, or `NULL` if the file could not be opened.
+ */
+_Check_return_ _Ret_maybenull_ BinaryReader* BinaryReader_Open(
+    _In_z_ PCSTR pszFilename
+    );
+
+/**
+ * @brief Creates a binary reader over a block of memory.
+ *
+ * No copy is made; the memory has to stay valid for the lifetime of the reader.
+ *
+ * @param pData  Pointer to the first byte to read.
+ * @param cbSize Number of readable bytes.
+ * @return A pointer to the new `BinaryReader`, or `NULL` if the creation failed.
+ */
+_Check_return_ _Ret_maybenull_ BinaryReader* BinaryReader_CreateFromMemory(
+    _In_reads_bytes_(cbSize) const void* pData,
+    _In_                     ULONG cbSize
+    );
+
+/**
+ * @brief Makes sure at least `cbNeeded` bytes are buffered.
+ *
+ * Called by the inline readers when the buffer runs dry. Unread bytes are moved to the front of the buffer
+ * and the rest is filled from the file.
+ *
+ * @param pReader  Pointer to the `BinaryReader`.
+ * @param cbNeeded Number of bytes the caller wants to read next. Must not exceed `BINARY_READER_BUFFER_SIZE`.
+ * @return `true` if `cbNeeded` bytes are available, otherwise `false` and the error flag is set.
+ */
+_Check_return_ bool BinaryReader_Refill(
+    _Inout_ BinaryReader* pReader,
+    _In_    ULONG cbNeeded
+    );
+
+/**
+ * @brief Reads `cbSize` raw bytes into caller memory.
+ *
+ * Large reads bypass the internal buffer and go straight from the file into `pDest`.
+ *
+ * @param pReader Pointer to the `BinaryReader`.
+ * @param pDest   Destination buffer of at least `cbSize` bytes.
+ * @param cbSize  Number of bytes to read.
+ * @return `true` if all bytes were read, otherwise `false` and the error flag is set.
+ */
+_Check_return_opt_ bool BinaryReader_ReadBytes(
+    _Inout_                   BinaryReader* pReader,
+    _Out_writes_bytes_(cbSize) void* pDest,
+    _In_                      ULONG cbSize
+    );
+
+/**
+ * @brief Reads an array of little-endian fixed-width values into caller memory.
+ *
+ * @param pReader    Pointer to the `BinaryReader`.
+ * @param pDest      Destination array of at least `nCount` elements.
+ * @param cbElement  Size of one element in bytes (1, 2, 4 or 8).
+ * @param nCount     Number of elements to read.
+ * @return `true` if all elements were read, otherwise `false` and the error flag is set.
+ */
+_Check_return_opt_ bool BinaryReader_ReadArray(
+    _Inout_ BinaryReader* pReader,
+    _Out_   void* pDest,
+    _In_    ULONG cbElement,
+    _In_    ULONG nCount
+    );
+
+/**
+ * @brief Reads a length-prefixed string into a caller supplied buffer.
+ *
+ * The string is stored as a varint byte count followed by the bytes, without a terminator. The result in
+ * `pszBuffer` is always zero-terminated. If the string does not fit, it is skipped and the error flag is set.
+ *
+ * @param pReader   Pointer to the `BinaryReader`.
+ * @param pszBuffer Destination buffer.
+ * @param cchBuffer Size of `pszBuffer` in characters, including the terminator.
+ * @return The length of the string, or `0` on failure.
+ */
+_Check_return_opt_ ULONG BinaryReader_ReadString(
+    _Inout_                  BinaryReader* pReader,
+    _Out_writes_(cchBuffer)  PSTR pszBuffer,
+    _In_                     ULONG cchBuffer
+    );
+
+/**
+ * @brief Reads a length-prefixed string into newly allocated memory.
+ *
+ * @param pReader        Pointer to the `BinaryReader`.
+ * @param pcchBufferSize Optional output for the length of the string.
+ * @return A zero-terminated string that the caller must free, or `NULL` on failure.
+ */
+_Check_return_ _Ret_maybenull_ PSTR BinaryReader_ReadStringAlloc(
+    _Inout_   BinaryReader* pReader,
+    _Out_opt_ ULONG* pcchBufferSize
+    );
+
+/**
+ * @brief Skips `cbSize` bytes.
+ *
+ * @param pReader Pointer to the `BinaryReader`.
+ * @param cbSize  Number of bytes to skip.
+ * @return `true` if the bytes were skipped, otherwise `false` and the error flag is set. Skipping past the end of
+ *         the data fails like a short read.
+ */
+_Check_return_opt_ bool BinaryReader_Skip(
+    _Inout_ BinaryReader* pReader,
+    _In_    ULONG cbSize
+    );
+
+/**
+ * @brief Checks whether all input has been consumed.
+ *
+ * @param pReader Pointer to the `BinaryReader`.
+ * @return `true` if no more bytes can be read.
+ */
+_Check_return_ bool BinaryReader_IsEof(
+    _Inout_ BinaryReader* pReader
+    );
+
+/**
+ * @brief Destroys a binary reader and closes its file if it owns one.
+ *
+ * @param pReader Pointer to the `BinaryReader` to destroy.
+ * @return `true` if the reader was destroyed, `false` otherwise.
+ */
+_Check_return_opt_ bool BinaryReader_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ BinaryReader* pReader
+    );
+
+/**
+ * @brief Checks whether any read on the reader has failed.
+ *
+ * All read functions return zero once the error flag is set, so callers can read a whole record and check
+ * for errors once at the end.
+ */
+_Check_return_
+static inline bool BinaryReader_HasError(
+    _In_ const BinaryReader* pReader
+) {
+    return pReader->bError;
+}
+
+_Check_return_
+static inline bool BinaryReader_Ensure(
+    _Inout_ BinaryReader* pReader,
+    _In_    const ULONG cbNeeded
+) {
+    if ((ULONG)(pReader->pEnd - pReader->pCursor) >= cbNeeded) {
+        return true;
+    }
+    return BinaryReader_Refill(pReader, cbNeeded);
+}
+
+_Check_return_
+static inline UINT8 BinaryReader_ReadU8(
+    _Inout_ BinaryReader* pReader
+) {
+    if (!BinaryReader_Ensure(pReader, 1)) {
+        return 0;
+    }
+    return *pReader->pCursor++;
+}
+
+_Check_return_
+static inline UINT16 BinaryReader_ReadU16(
+    _Inout_ BinaryReader* pReader
+) {
+    if (!BinaryReader_Ensure(pReader, 2)) {
+        return 0;
+    }
+    const BYTE* p = pReader->pCursor;
+    pReader->pCursor += 2;
+    return (UINT16)(p[0] | (p[1] << 8));
+}
+
+_Check_return_
+static inline UINT BinaryReader_ReadU32(
+    _Inout_ BinaryReader* pReader
+) {
+    if (!BinaryReader_Ensure(pReader, 4)) {
+        return 0;
+    }
+    const BYTE* p = pReader->pCursor;
+    pReader->pCursor += 4;
+    return (UINT)p[0] | ((UINT)p[1] << 8) | ((UINT)p[2] << 16) | ((UINT)p[3] << 24);
+}
+
+_Check_return_
+static inline UINT64 BinaryReader_ReadU64(
+    _Inout_ BinaryReader* pReader
+) {
+    const UINT64 u64Low = BinaryReader_ReadU32(pReader);
+    const UINT64 u64High = BinaryReader_ReadU32(pReader);
+    return u64Low | (u64High << 32);
+}
+
+_Check_return_
+static inline INT8 BinaryReader_ReadI8(
+    _Inout_ BinaryReader* pReader
+) {
+    return (INT8)BinaryReader_ReadU8(pReader);
+}
+
+_Check_return_
+static inline INT16 BinaryReader_ReadI16(
+    _Inout_ BinaryReader* pReader
+) {
+    return (INT16)BinaryReader_ReadU16(pReader);
+}
+
+_Check_return_
+static inline INT32 BinaryReader_ReadI32(
+    _Inout_ BinaryReader* pReader
+) {
+    return (INT32)BinaryReader_ReadU32(pReader);
+}
+
+_Check_return_
+static inline INT64 BinaryReader_ReadI64(
+    _Inout_ BinaryReader* pReader
+) {
+    return (INT64)BinaryReader_ReadU64(pReader);
+}
+
+_Check_return_
+static inline FLOAT32 BinaryReader_ReadF32(
+    _Inout_ BinaryReader* pReader
+) {
+    const UINT uBits = BinaryReader_ReadU32(pReader);
+    FLOAT32 fValue;
+    memcpy(&fValue, &uBits, sizeof(fValue));
+    return fValue;
+}
+
+_Check_return_
+static inline FLOAT64 BinaryReader_ReadF64(
+    _Inout_ BinaryReader* pReader
+) {
+    const UINT64 u64Bits = BinaryReader_ReadU64(pReader);
+    FLOAT64 fValue;
+    memcpy(&fValue, &u64Bits, sizeof(fValue));
+    return fValue;
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint of up to 64 bits.
+ *
+ * Each byte carries 7 bits of the value, least significant group first. The high bit marks that another
+ * byte follows. Encodings longer than 10 bytes set the error flag.
+ */
+_Check_return_
+static inline UINT64 BinaryReader_ReadVarUInt(
+    _Inout_ BinaryReader* pReader
+) {
+    UINT64 u64Value = 0;
+    for (INT nShift = 0; nShift < 64; nShift += 7) {
+        const BYTE byte = BinaryReader_ReadU8(pReader);
+        if (pReader->bError) {
+            return 0;
+        }
+        u64Value |= (UINT64)(byte & 0x7F) << nShift;
+        if ((byte & 0x80) == 0) {
+            return u64Value;
+        }
+    }
+    pReader->bError = true;
+    return 0;
+}
+
+/**
+ * @brief Reads a zigzag encoded signed varint, so small negative values stay short.
+ */
+_Check_return_
+static inline INT64 BinaryReader_ReadVarInt(
+    _Inout_ BinaryReader* pReader
+) {
+    const UINT64 u64Value = BinaryReader_ReadVarUInt(pReader);
+    return (INT64)(u64Value >> 1) ^ -(INT64)(u64Value & 1);
+}
+
+#endif //BINARY_READER_H
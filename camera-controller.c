@@ -0,0 +1,330 @@
+#include "camera-controller.h"
+
+#include <math.h>
+
+#include "camera.h"
+#include "arena.h"
+
+_Check_return_ _Ret_maybenull_
+CameraController* CameraController_Create(
+    _In_ Camera* pCamera
+) {
+    CameraController* pController = calloc(1, sizeof(CameraController));
+    if (!pController) {
+        printf("Failed to allocate memory for CameraController\n");
+        return NULL;
+    }
+
+    pController->pCamera = pCamera;
+    pController->motion = CAMERA_MOTION_NONE;
+    pController->vPosition = CreateVector2(pCamera->x, pCamera->y);
+    pController->fZoom = pCamera->fZoom;
+    pController->fSmoothTime = CAMERA_DEFAULT_SMOOTH_TIME;
+
+    return pController;
+}
+
+void CameraController_Follow(
+    _Inout_ CameraController* pController,
+    _In_    const VECTOR2 vTarget,
+    _In_    const FLOAT fSmoothTime
+) {
+    if (pController->motion != CAMERA_MOTION_FOLLOW) {
+        pController->vVelocity = Vector2Zero();
+    }
+
+    pController->motion = CAMERA_MOTION_FOLLOW;
+    pController->vFollowTarget = vTarget;
+    pController->fSmoothTime = fSmoothTime > 0.0f ? fSmoothTime : CAMERA_DEFAULT_SMOOTH_TIME;
+}
+
+_Check_return_
+static VECTOR2 CatmullRom(
+    _In_ const VECTOR2 p0,
+    _In_ const VECTOR2 p1,
+    _In_ const VECTOR2 p2,
+    _In_ const VECTOR2 p3,
+    _In_ const FLOAT t
+) {
+    const FLOAT t2 = t * t;
+    const FLOAT t3 = t2 * t;
+    return (VECTOR2) {
+        0.5f * (2.0f * p1.x + (p2.x - p0.x) * t + (2.0f * p0.x - 5.0f * p1.x + 4.0f * p2.x - p3.x) * t2
+            + (3.0f * p1.x - p0.x - 3.0f * p2.x + p3.x) * t3),
+        0.5f * (2.0f * p1.y + (p2.y - p0.y) * t + (2.0f * p0.y - 5.0f * p1.y + 4.0f * p2.y - p3.y) * t2
+            + (3.0f * p1.y - p0.y - 3.0f * p2.y + p3.y) * t3)
+    };
+}
+
+/**
+ * Reports the regions the camera will show along the sampled pan: one wherever the camera has moved a quarter of
+ * a screen since the last, and one at the end. Views are sized for the widest zoom the pan reaches.
+ */
+static void PrefetchPanRegions(
+    _In_ const CameraController* pController
+) {
+    const Camera* pCamera = pController->pCamera;
+    FLOAT fZoom = pController->fZoom;
+    if (pController->bZooming && pController->fZoomTo < fZoom) {
+        fZoom = pController->fZoomTo;
+    }
+
+    // Half extents of the box around the rotated view
+    const FLOAT fRadians = pCamera->fRotation * 3.14159265f / 180.0f;
+    const FLOAT fCos = fabsf(cosf(fRadians));
+    const FLOAT fSin = fabsf(sinf(fRadians));
+    const FLOAT fHalfWidth = pCamera->fWidth / fZoom / 2.0f;
+    const FLOAT fHalfHeight = pCamera->fHeight / fZoom / 2.0f;
+    const FLOAT fExtentX = fCos * fHalfWidth + fSin * fHalfHeight;
+    const FLOAT fExtentY = fSin * fHalfWidth + fCos * fHalfHeight;
+
+    Arena* pScratch = Arena_GetScratch();
+    if (!pScratch) {
+        return;
+    }
+
+    const ArenaScope scope = Arena_BeginScope(pScratch);
+    RECTF* arrRegions = Arena_Alloc(pScratch, sizeof(RECTF) * (size_t)pController->nPanSamples);
+    if (!arrRegions) {
+        Arena_EndScope(scope);
+        return;
+    }
+
+    INT nRegions = 0;
+    VECTOR2 vLast = pController->arrPanSamples[0];
+    for (INT i = 1; i < pController->nPanSamples; i++) {
+        const VECTOR2 v = pController->arrPanSamples[i];
+        const bool bLast = i == pController->nPanSamples - 1;
+        if (!bLast && fabsf(v.x - vLast.x) < fExtentX / 2.0f && fabsf(v.y - vLast.y) < fExtentY / 2.0f) {
+            continue;
+        }
+
+        arrRegions[nRegions++] = (RECTF) { v.x - fExtentX, v.y - fExtentY, v.x + fExtentX, v.y + fExtentY };
+        vLast = v;
+    }
+
+    pController->pfnPrefetch(pController->pPrefetchUserData, arrRegions, nRegions);
+    Arena_EndScope(scope);
+}
+
+_Check_return_opt_
+bool CameraController_PanTo(
+    _Inout_             CameraController* pController,
+    _In_reads_(nPoints) const VECTOR2* arrPoints,
+    _In_                const INT nPoints,
+    _In_                const FLOAT fDuration
+) {
+    if (nPoints < 1) {
+        return false;
+    }
+
+    const INT nSamples = nPoints * CAMERA_PAN_SAMPLES_PER_SEGMENT + 1;
+    if (nSamples > pController->nPanCapacity) {
+        VECTOR2* arrSamples = realloc(pController->arrPanSamples, sizeof(VECTOR2) * (size_t)nSamples);
+        if (!arrSamples) {
+            printf("Failed to allocate memory for the camera pan\n");
+            return false;
+        }
+        pController->arrPanSamples = arrSamples;
+
+        FLOAT* arrDistances = realloc(pController->arrPanDistances, sizeof(FLOAT) * (size_t)nSamples);
+        if (!arrDistances) {
+            printf("Failed to allocate memory for the camera pan\n");
+            return false;
+        }
+        pController->arrPanDistances = arrDistances;
+        pController->nPanCapacity = nSamples;
+    }
+
+    // The path starts where the camera is; the end points are repeated so the spline ends at them
+    const VECTOR2 vStart = pController->vPosition;
+#define PAN_POINT(i) ((i) <= 0 ? vStart : arrPoints[((i) > nPoints ? nPoints : (i)) - 1])
+
+    INT nWritten = 0;
+    for (INT iSegment = 0; iSegment < nPoints; iSegment++) {
+        const VECTOR2 p0 = PAN_POINT(iSegment - 1);
+        const VECTOR2 p1 = PAN_POINT(iSegment);
+        const VECTOR2 p2 = PAN_POINT(iSegment + 1);
+        const VECTOR2 p3 = PAN_POINT(iSegment + 2);
+        for (INT i = 0; i < CAMERA_PAN_SAMPLES_PER_SEGMENT; i++) {
+            const FLOAT t = (FLOAT)i / CAMERA_PAN_SAMPLES_PER_SEGMENT;
+            pController->arrPanSamples[nWritten++] = CatmullRom(p0, p1, p2, p3, t);
+        }
+    }
+    pController->arrPanSamples[nWritten++] = PAN_POINT(nPoints);
+
+#undef PAN_POINT
+
+    pController->arrPanDistances[0] = 0.0f;
+    for (INT i = 1; i < nWritten; i++) {
+        const VECTOR2 a = pController->arrPanSamples[i - 1];
+        const VECTOR2 b = pController->arrPanSamples[i];
+        const FLOAT fStep = sqrtf((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+        pController->arrPanDistances[i] = pController->arrPanDistances[i - 1] + fStep;
+    }
+
+    pController->nPanSamples = nWritten;
+    pController->fPanElapsed = 0.0;
+    pController->fPanDuration = fDuration;
+    pController->motion = CAMERA_MOTION_PAN;
+    pController->vVelocity = Vector2Zero();
+
+    if (pController->pfnPrefetch) {
+        PrefetchPanRegions(pController);
+    }
+
+    return true;
+}
+
+_Check_return_
+bool CameraController_IsPanning(
+    _In_ const CameraController* pController
+) {
+    return pController->motion == CAMERA_MOTION_PAN;
+}
+
+void CameraController_ZoomTo(
+    _Inout_ CameraController* pController,
+    _In_    const FLOAT fZoom,
+    _In_    const FLOAT fDuration
+) {
+    if (fZoom <= 0.0f) {
+        printf("Ignoring invalid camera zoom %f\n", fZoom);
+        return;
+    }
+
+    pController->bZooming = true;
+    pController->fZoomFrom = pController->fZoom;
+    pController->fZoomTo = fZoom;
+    pController->fZoomElapsed = 0.0;
+    pController->fZoomDuration = fDuration;
+}
+
+void CameraController_SetPrefetchCallback(
+    _Inout_  CameraController* pController,
+    _In_opt_ const CameraPrefetchCallback pfnPrefetch,
+    _In_opt_ void* pUserData
+) {
+    pController->pfnPrefetch = pfnPrefetch;
+    pController->pPrefetchUserData = pUserData;
+}
+
+/**
+ * Critically damped spring towards the target. Each update applies the spring's exact solution over the frame, but
+ * with `exp(-x)` replaced by `1 / (1 + x + 0.48x^2 + 0.235x^3)`. That stays within 0.2% of the exponential for
+ * steps up to half the smooth time (x <= 1) and within 0.02 of it beyond. Like the exponential, it stays below 1
+ * and falls towards 0 as the step grows, so a long frame cannot make the camera diverge.
+ */
+static void UpdateFollow(
+    _Inout_ CameraController* pController,
+    _In_    const FLOAT fDeltaSeconds
+) {
+    const FLOAT fOmega = 2.0f / pController->fSmoothTime;
+    const FLOAT x = fOmega * fDeltaSeconds;
+    const FLOAT fDecay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+
+    const VECTOR2 vTarget = pController->vFollowTarget;
+    const VECTOR2 vOffset = { pController->vPosition.x - vTarget.x, pController->vPosition.y - vTarget.y };
+    const VECTOR2 vTemp = {
+        (pController->vVelocity.x + fOmega * vOffset.x) * fDeltaSeconds,
+        (pController->vVelocity.y + fOmega * vOffset.y) * fDeltaSeconds
+    };
+
+    pController->vVelocity.x = (pController->vVelocity.x - fOmega * vTemp.x) * fDecay;
+    pController->vVelocity.y = (pController->vVelocity.y - fOmega * vTemp.y) * fDecay;
+    pController->vPosition.x = vTarget.x + (vOffset.x + vTemp.x) * fDecay;
+    pController->vPosition.y = vTarget.y + (vOffset.y + vTemp.y) * fDecay;
+}
+
+static void UpdatePan(
+    _Inout_ CameraController* pController,
+    _In_    const DOUBLE fDeltaSeconds
+) {
+    pController->fPanElapsed += fDeltaSeconds;
+
+    FLOAT t = pController->fPanDuration > 0.0f ? (FLOAT)(pController->fPanElapsed / pController->fPanDuration) : 1.0f;
+    if (t >= 1.0f) {
+        pController->vPosition = pController->arrPanSamples[pController->nPanSamples - 1];
+        pController->motion = CAMERA_MOTION_NONE;
+        return;
+    }
+
+    // Ease in and out, then find the sample pair around that share of the path's length
+    const FLOAT fEased = t * t * (3.0f - 2.0f * t);
+    const FLOAT fDistance = fEased * pController->arrPanDistances[pController->nPanSamples - 1];
+
+    INT iLow = 0;
+    INT iHigh = pController->nPanSamples - 1;
+    while (iHigh - iLow > 1) {
+        const INT iMid = (iLow + iHigh) / 2;
+        if (pController->arrPanDistances[iMid] <= fDistance) {
+            iLow = iMid;
+        } else {
+            iHigh = iMid;
+        }
+    }
+
+    const FLOAT fSpan = pController->arrPanDistances[iHigh] - pController->arrPanDistances[iLow];
+    const FLOAT fFraction = fSpan > 0.0f ? (fDistance - pController->arrPanDistances[iLow]) / fSpan : 0.0f;
+    pController->vPosition = Vector2Lerp(
+        pController->arrPanSamples[iLow],
+        pController->arrPanSamples[iHigh],
+        fFraction
+    );
+}
+
+static void UpdateZoom(
+    _Inout_ CameraController* pController,
+    _In_    const DOUBLE fDeltaSeconds
+) {
+    pController->fZoomElapsed += fDeltaSeconds;
+
+    FLOAT t = pController->fZoomDuration > 0.0f
+        ? (FLOAT)(pController->fZoomElapsed / pController->fZoomDuration)
+        : 1.0f;
+    if (t >= 1.0f) {
+        pController->fZoom = pController->fZoomTo;
+        pController->bZooming = false;
+        return;
+    }
+
+    const FLOAT fEased = t * t * (3.0f - 2.0f * t);
+    pController->fZoom = pController->fZoomFrom * powf(pController->fZoomTo / pController->fZoomFrom, fEased);
+}
+
+void CameraController_Update(
+    _Inout_ CameraController* pController,
+    _In_    const DOUBLE fDeltaSeconds
+) {
+    switch (pController->motion) {
+        case CAMERA_MOTION_NONE:
+            break;
+        case CAMERA_MOTION_FOLLOW:
+            UpdateFollow(pController, (FLOAT)fDeltaSeconds);
+            break;
+        case CAMERA_MOTION_PAN:
+            UpdatePan(pController, fDeltaSeconds);
+            break;
+    }
+
+    if (pController->bZooming) {
+        UpdateZoom(pController, fDeltaSeconds);
+    }
+
+    Camera_SetPositionV(pController->pCamera, pController->vPosition);
+    Camera_SetZoom(pController->pCamera, pController->fZoom);
+}
+
+_Check_return_opt_
+bool CameraController_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ CameraController* pController
+) {
+    if (!pController) {
+        return false;
+    }
+
+    SafeFree(pController->arrPanSamples);
+    SafeFree(pController->arrPanDistances);
+    SafeFree(pController);
+    return true;
+}
@@ -0,0 +1,168 @@
+#ifndef CAMERA_CONTROLLER_H
+#define CAMERA_CONTROLLER_H
+
+#include "utils.h"
+#include "vector2.h"
+#include "rect.h"
+
+typedef struct _Camera Camera;
+
+#define CAMERA_PAN_SAMPLES_PER_SEGMENT 16 // << Points sampled on each spline segment to measure its length
+#define CAMERA_DEFAULT_SMOOTH_TIME 0.15f  // << Seconds a follow takes to close most of the distance
+
+/**
+ * @brief Asks the game to load whatever lies in the given parts of the world.
+ *
+ * @param pUserData User data given with the callback.
+ * @param arrRegions World rectangles the camera will show during the pan, in the order it reaches them. Only valid
+ *                   during the call.
+ * @param nRegions   Number of rectangles.
+ */
+typedef void (*CameraPrefetchCallback)(void* pUserData, const RECTF* arrRegions, INT nRegions);
+
+typedef enum _CameraMotion {
+    CAMERA_MOTION_NONE,        // << The camera stays where it is
+    CAMERA_MOTION_FOLLOW,      // << The camera eases towards a target that may move every frame
+    CAMERA_MOTION_PAN          // << The camera travels along a spline in a fixed time
+} CameraMotion;
+
+/*
+ * Moves a camera smoothly instead of jumping it to each new position.
+ *
+ * Follow uses a critically damped spring, so the camera catches up as fast as possible without overshooting and
+ * a target that keeps changing never makes it jerk. Pans run through a list of points on a Catmull-Rom spline that
+ * is sampled once when the pan starts; the samples are spaced by arc length, so the camera moves at an even speed
+ * along curves, easing in and out at the ends. Zoom tweens run independently of both.
+ *
+ * Everything is advanced by `CameraController_Update` with the real frame delta, which writes the result to the
+ * camera once. When a pan starts, the regions the camera will show along the way are handed to the prefetch
+ * callback, so the game can load them before the camera gets there.
+ */
+typedef struct _CameraController {
+    Camera* pCamera;
+    CameraMotion motion;
+    VECTOR2 vPosition;         // << Position written to the camera on the last update
+    VECTOR2 vVelocity;         // << Follow spring velocity, in world units per second
+
+    VECTOR2 vFollowTarget;
+    FLOAT fSmoothTime;
+
+    VECTOR2* arrPanSamples;    // << Spline sampled at CAMERA_PAN_SAMPLES_PER_SEGMENT points per segment
+    FLOAT* arrPanDistances;    // << Arc length from the start of the pan to each sample
+    INT nPanSamples;
+    INT nPanCapacity;
+    DOUBLE fPanElapsed;
+    FLOAT fPanDuration;
+
+    bool bZooming;
+    FLOAT fZoom;               // << Zoom written to the camera on the last update
+    FLOAT fZoomFrom;
+    FLOAT fZoomTo;
+    DOUBLE fZoomElapsed;
+    FLOAT fZoomDuration;
+
+    CameraPrefetchCallback pfnPrefetch;
+    void* pPrefetchUserData;
+} CameraController;
+
+/**
+ * @brief Creates a controller for a camera, starting at the camera's current position and zoom.
+ *
+ * @param pCamera The camera to move. Must outlive the controller.
+ * @return A pointer to the new `CameraController`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ CameraController* CameraController_Create(
+    _In_ Camera* pCamera
+    );
+
+/**
+ * @brief Makes the camera follow a target. Call again whenever the target moves.
+ *
+ * Cancels a running pan.
+ *
+ * @param pController Pointer to the `CameraController`.
+ * @param vTarget     Position to follow.
+ * @param fSmoothTime Roughly the time the camera needs to reach a target that stopped, or `0` for
+ *                    `CAMERA_DEFAULT_SMOOTH_TIME`.
+ */
+void CameraController_Follow(
+    _Inout_ CameraController* pController,
+    _In_    VECTOR2 vTarget,
+    _In_    FLOAT fSmoothTime
+    );
+
+/**
+ * @brief Pans the camera from where it is through the given points.
+ *
+ * The path is precomputed here and the prefetch callback, if any, is called with the regions along it.
+ *
+ * @param pController Pointer to the `CameraController`.
+ * @param arrPoints   Points to pass through; the camera stops at the last one.
+ * @param nPoints     Number of points, at least one.
+ * @param fDuration   Length of the pan in seconds.
+ * @return `true` if the pan started, `false` if the path could not be allocated.
+ */
+_Check_return_opt_ bool CameraController_PanTo(
+    _Inout_            CameraController* pController,
+    _In_reads_(nPoints) const VECTOR2* arrPoints,
+    _In_               INT nPoints,
+    _In_               FLOAT fDuration
+    );
+
+/**
+ * @brief Checks whether a pan is still running.
+ */
+_Check_return_ bool CameraController_IsPanning(
+    _In_ const CameraController* pController
+    );
+
+/**
+ * @brief Changes the zoom gradually.
+ *
+ * The zoom changes by the same factor each moment, so zooming from 1 to 4 looks as even as from 0.5 to 2.
+ *
+ * @param pController Pointer to the `CameraController`.
+ * @param fZoom       Zoom to reach.
+ * @param fDuration   Length of the tween in seconds, or `0` to change the zoom on the next update.
+ */
+void CameraController_ZoomTo(
+    _Inout_ CameraController* pController,
+    _In_    FLOAT fZoom,
+    _In_    FLOAT fDuration
+    );
+
+/**
+ * @brief Sets the function told which regions a pan will show.
+ *
+ * @param pController Pointer to the `CameraController`.
+ * @param pfnPrefetch The callback, or `NULL` to not prefetch.
+ * @param pUserData   Passed to the callback.
+ */
+void CameraController_SetPrefetchCallback(
+    _Inout_  CameraController* pController,
+    _In_opt_ CameraPrefetchCallback pfnPrefetch,
+    _In_opt_ void* pUserData
+    );
+
+/**
+ * @brief Advances the motion and writes the camera's position and zoom. Call once per rendered frame.
+ *
+ * @param pController   Pointer to the `CameraController`.
+ * @param fDeltaSeconds Time since the last update, e.g. `GetFrameTimeSeconds()`.
+ */
+void CameraController_Update(
+    _Inout_ CameraController* pController,
+    _In_    DOUBLE fDeltaSeconds
+    );
+
+/**
+ * @brief Destroys a camera controller. The camera it drives is not destroyed.
+ *
+ * @param pController Pointer to the `CameraController` to destroy.
+ * @return `true` if the controller was destroyed, `false` if `pController` was `NULL`.
+ */
+_Check_return_opt_ bool CameraController_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ CameraController* pController
+    );
+
+#endif //CAMERA_CONTROLLER_H
@@ -9,8 +9,92 @@
 #include <SFML/Graphics.h>
 
 #include "window.h"
+#include "render-stats.h"
 
 static Camera* s_pCurrentCamera;
+static const sfView* s_pAppliedView; // << View last handed to the render window; NULL before the first draw
+
+static void SyncView(
+    _Inout_ Camera* pCamera
+) {
+    sfView_setCenter(pCamera->pView, (sfVector2f) { pCamera->x, pCamera->y });
+    sfView_setSize(pCamera->pView, (sfVector2f) { pCamera->fWidth / pCamera->fZoom, pCamera->fHeight / pCamera->fZoom });
+    sfView_setRotation(pCamera->pView, pCamera->fRotation);
+    pCamera->bViewDirty = false;
+}
+
+static void MarkDirty(
+    _Inout_ Camera* pCamera
+) {
+    pCamera->bViewDirty = true;
+    pCamera->bMatricesDirty = true;
+}
+
+/**
+ * Rebuilds the cached transforms and visible bounds if the camera or the window changed since they were built.
+ * The world-to-screen transform is the one SFML derives from the view: rotate around the center, scale the view
+ * size to the window and move the center to the middle of the window.
+ */
+static void UpdateMatrices(
+    _Inout_ Camera* pCamera
+) {
+    const INT iWindowWidth = Window_GetWidth();
+    const INT iWindowHeight = Window_GetHeight();
+    if (!pCamera->bMatricesDirty
+        && pCamera->iMatrixWindowWidth == iWindowWidth
+        && pCamera->iMatrixWindowHeight == iWindowHeight) {
+        return;
+    }
+
+    // SFML views rotate in degrees
+    const FLOAT fRadians = pCamera->fRotation * 3.14159265f / 180.0f;
+    const FLOAT fCos = cosf(fRadians);
+    const FLOAT fSin = sinf(fRadians);
+    const FLOAT fScaleX = (FLOAT)iWindowWidth * pCamera->fZoom / pCamera->fWidth;
+    const FLOAT fScaleY = (FLOAT)iWindowHeight * pCamera->fZoom / pCamera->fHeight;
+
+    FLOAT* m = pCamera->arrWorldToScreen;
+    m[0] = fScaleX * fCos;
+    m[1] = fScaleX * fSin;
+    m[2] = (FLOAT)iWindowWidth / 2.0f - (m[0] * pCamera->x + m[1] * pCamera->y);
+    m[3] = -fScaleY * fSin;
+    m[4] = fScaleY * fCos;
+    m[5] = (FLOAT)iWindowHeight / 2.0f - (m[3] * pCamera->x + m[4] * pCamera->y);
+
+    const FLOAT fInvDet = 1.0f / (m[0] * m[4] - m[1] * m[3]);
+    FLOAT* inv = pCamera->arrScreenToWorld;
+    inv[0] = m[4] * fInvDet;
+    inv[1] = -m[1] * fInvDet;
+    inv[2] = (m[1] * m[5] - m[4] * m[2]) * fInvDet;
+    inv[3] = -m[3] * fInvDet;
+    inv[4] = m[0] * fInvDet;
+    inv[5] = (m[3] * m[2] - m[0] * m[5]) * fInvDet;
+
+    // Bounding box of the window's corners in world space
+    const FLOAT arrCornersX[] = { 0.0f, (FLOAT)iWindowWidth, 0.0f, (FLOAT)iWindowWidth };
+    const FLOAT arrCornersY[] = { 0.0f, 0.0f, (FLOAT)iWindowHeight, (FLOAT)iWindowHeight };
+    RECTF* pVisible = &pCamera->rcVisible;
+    for (INT i = 0; i < 4; i++) {
+        const FLOAT x = inv[0] * arrCornersX[i] + inv[1] * arrCornersY[i] + inv[2];
+        const FLOAT y = inv[3] * arrCornersX[i] + inv[4] * arrCornersY[i] + inv[5];
+        if (i == 0 || x < pVisible->fLeft) {
+            pVisible->fLeft = x;
+        }
+        if (i == 0 || x > pVisible->fRight) {
+            pVisible->fRight = x;
+        }
+        if (i == 0 || y < pVisible->fTop) {
+            pVisible->fTop = y;
+        }
+        if (i == 0 || y > pVisible->fBottom) {
+            pVisible->fBottom = y;
+        }
+    }
+
+    pCamera->iMatrixWindowWidth = iWindowWidth;
+    pCamera->iMatrixWindowHeight = iWindowHeight;
+    pCamera->bMatricesDirty = false;
+}
 
 _Check_return_ _Ret_maybenull_
 Camera* Camera_Create(
@@ -20,23 +104,27 @@ Camera* Camera_Create(
     _In_ const FLOAT fHeight,
     _In_ const FLOAT fRotation
 ) {
-    Camera* pCamera = malloc(sizeof(Camera));
+    Camera* pCamera = calloc(1, sizeof(Camera));
     if (!pCamera) {
         printf("Failed to allocate memory for Camera\n");
         return NULL;
     }
 
-    pCamera->x = x;
-    pCamera->y = y;
+    pCamera->pView = sfView_create();
+    if (!pCamera->pView) {
+        printf("Failed to create camera view\n");
+        SafeFree(pCamera);
+        return NULL;
+    }
+
+    // The camera's position is the center of what it sees
+    pCamera->x = x + fWidth / 2.0f;
+    pCamera->y = y + fHeight / 2.0f;
     pCamera->fWidth = fWidth;
     pCamera->fHeight = fHeight;
     pCamera->fRotation = fRotation;
     pCamera->fZoom = 1.0f;
-    pCamera->pView = sfView_create();
-
-    sfView_setCenter(pCamera->pView, (sfVector2f) { x + fWidth / 2.0f, y + fHeight / 2.0f });
-    sfView_setRotation(pCamera->pView, fRotation);
-    sfView_setSize(pCamera->pView, (sfVector2f) { fWidth, fHeight });
+    MarkDirty(pCamera);
 
     return pCamera;
 }
@@ -45,8 +133,13 @@ void Camera_SetZoom(
     _Inout_ Camera* pCamera,
     _In_    const FLOAT fZoom
 ) {
-    pCamera->fZoom = fZoom;
+    if (fZoom <= 0.0f) {
+        printf("Ignoring invalid camera zoom %f\n", fZoom);
+        return;
+    }
 
+    pCamera->fZoom = fZoom;
+    MarkDirty(pCamera);
 }
 
 void Camera_SetRotation(
@@ -54,8 +147,7 @@ void Camera_SetRotation(
     _In_    const FLOAT fRotation
 ) {
     pCamera->fRotation = fRotation;
-    sfView_setRotation(pCamera->pView, fRotation);
-    sfRenderWindow_setView(Window_GetRenderWindow(), pCamera->pView);
+    MarkDirty(pCamera);
 }
 
 void Camera_SetPosition(
@@ -65,8 +157,7 @@ void Camera_SetPosition(
 ) {
     pCamera->x = x;
     pCamera->y = y;
-    sfView_setCenter(pCamera->pView, (sfVector2f) { x, y });
-    sfRenderWindow_setView(Window_GetRenderWindow(), pCamera->pView);
+    MarkDirty(pCamera);
 }
 
 void Camera_SetPositionV(
@@ -75,8 +166,7 @@ void Camera_SetPositionV(
 ) {
     pCamera->x = target.x;
     pCamera->y = target.y;
-    sfView_setCenter(pCamera->pView, (sfVector2f) { target.x, target.y });
-    sfRenderWindow_setView(Window_GetRenderWindow(), pCamera->pView);
+    MarkDirty(pCamera);
 }
 
 void Camera_MovePosition(
@@ -92,20 +182,33 @@ void Camera_MovePosition(
 
     pCamera->x += dx;
     pCamera->y += dy;
-    sfView_move(pCamera->pView, (sfVector2f) { dx, dy });
-    sfRenderWindow_setView(Window_GetRenderWindow(), pCamera->pView);
+    MarkDirty(pCamera);
 }
 
 void Camera_Use(
     _In_opt_ Camera* pCamera
 ) {
     s_pCurrentCamera = pCamera;
-    if (pCamera == NULL) {
-        const sfView* pView = sfRenderWindow_getDefaultView(Window_GetRenderWindow());
-        sfRenderWindow_setView(Window_GetRenderWindow(), pView);
-        return;
+}
+
+void Camera_Apply(
+    void
+) {
+    const sfView* pView;
+    if (s_pCurrentCamera) {
+        if (s_pCurrentCamera->bViewDirty) {
+            SyncView(s_pCurrentCamera);
+            s_pAppliedView = NULL; // << Same view object, but its contents changed
+        }
+        pView = s_pCurrentCamera->pView;
+    } else {
+        pView = sfRenderWindow_getDefaultView(Window_GetRenderWindow());
+    }
+
+    if (pView != s_pAppliedView) {
+        RenderStats_SetView(pView);
+        s_pAppliedView = pView;
     }
-    sfRenderWindow_setView(Window_GetRenderWindow(), pCamera->pView);
 }
 
 _Check_return_
@@ -113,26 +216,16 @@ VECTOR2 WorldToScreen(
     _In_ const FLOAT x,
     _In_ const FLOAT y
 ) {
-    const sfVector2i screen = sfRenderWindow_mapCoordsToPixel(
-        Window_GetRenderWindow(),
-        (sfVector2f) { x, y },
-        s_pCurrentCamera->pView
-    );
-
-    return (VECTOR2) { (FLOAT)screen.x, (FLOAT)screen.y };
+    UpdateMatrices(s_pCurrentCamera);
+    const FLOAT* m = s_pCurrentCamera->arrWorldToScreen;
+    return (VECTOR2) { m[0] * x + m[1] * y + m[2], m[3] * x + m[4] * y + m[5] };
 }
 
 _Check_return_
 VECTOR2 WorldToScreenV(
     _In_ const VECTOR2 world
 ) {
-    const sfVector2i screen = sfRenderWindow_mapCoordsToPixel(
-        Window_GetRenderWindow(),
-        (sfVector2f) { world.x, world.y },
-        s_pCurrentCamera->pView
-    );
-
-    return (VECTOR2) { (FLOAT)screen.x, (FLOAT)screen.y };
+    return WorldToScreen(world.x, world.y);
 }
 
 _Check_return_
@@ -140,26 +233,85 @@ VECTOR2 ScreenToWorld(
     _In_ const INT x,
     _In_ const INT y
 ) {
-    const sfVector2f world = sfRenderWindow_mapPixelToCoords(
-        Window_GetRenderWindow(),
-        (sfVector2i) { x, y },
-        s_pCurrentCamera->pView
-    );
-
-    return (VECTOR2) { world.x, world.y };
+    UpdateMatrices(s_pCurrentCamera);
+    const FLOAT* m = s_pCurrentCamera->arrScreenToWorld;
+    return (VECTOR2) {
+        m[0] * (FLOAT)x + m[1] * (FLOAT)y + m[2],
+        m[3] * (FLOAT)x + m[4] * (FLOAT)y + m[5]
+    };
 }
 
 _Check_return_
 VECTOR2 ScreenToWorldV(
     _In_ const POINT screen
 ) {
-    const sfVector2f world = sfRenderWindow_mapPixelToCoords(
-        Window_GetRenderWindow(),
-        (sfVector2i) { screen.x, screen.y },
-        s_pCurrentCamera->pView
-    );
+    return ScreenToWorld(screen.x, screen.y);
+}
+
+void WorldToScreenBatch(
+    _In_reads_(nCount)  const VECTOR2* RESTRICT arrWorld,
+    _Out_writes_(nCount) VECTOR2* RESTRICT arrScreen,
+    _In_                const INT nCount
+) {
+    UpdateMatrices(s_pCurrentCamera);
+
+    // Locals keep the matrix in registers; the stores to arrScreen could otherwise alias it
+    const FLOAT m0 = s_pCurrentCamera->arrWorldToScreen[0];
+    const FLOAT m1 = s_pCurrentCamera->arrWorldToScreen[1];
+    const FLOAT m2 = s_pCurrentCamera->arrWorldToScreen[2];
+    const FLOAT m3 = s_pCurrentCamera->arrWorldToScreen[3];
+    const FLOAT m4 = s_pCurrentCamera->arrWorldToScreen[4];
+    const FLOAT m5 = s_pCurrentCamera->arrWorldToScreen[5];
+
+    for (INT i = 0; i < nCount; i++) {
+        const FLOAT x = arrWorld[i].x;
+        const FLOAT y = arrWorld[i].y;
+        arrScreen[i].x = m0 * x + m1 * y + m2;
+        arrScreen[i].y = m3 * x + m4 * y + m5;
+    }
+}
+
+void ScreenToWorldBatch(
+    _In_reads_(nCount)  const POINT* RESTRICT arrScreen,
+    _Out_writes_(nCount) VECTOR2* RESTRICT arrWorld,
+    _In_                const INT nCount
+) {
+    UpdateMatrices(s_pCurrentCamera);
+
+    const FLOAT m0 = s_pCurrentCamera->arrScreenToWorld[0];
+    const FLOAT m1 = s_pCurrentCamera->arrScreenToWorld[1];
+    const FLOAT m2 = s_pCurrentCamera->arrScreenToWorld[2];
+    const FLOAT m3 = s_pCurrentCamera->arrScreenToWorld[3];
+    const FLOAT m4 = s_pCurrentCamera->arrScreenToWorld[4];
+    const FLOAT m5 = s_pCurrentCamera->arrScreenToWorld[5];
+
+    for (INT i = 0; i < nCount; i++) {
+        const FLOAT x = (FLOAT)arrScreen[i].x;
+        const FLOAT y = (FLOAT)arrScreen[i].y;
+        arrWorld[i].x = m0 * x + m1 * y + m2;
+        arrWorld[i].y = m3 * x + m4 * y + m5;
+    }
+}
+
+_Check_return_
+RECTF Camera_GetVisibleBounds(
+    void
+) {
+    if (!s_pCurrentCamera) {
+        // The default view keeps the window's initial area and stretches it when the window is resized
+        const sfView* pView = sfRenderWindow_getDefaultView(Window_GetRenderWindow());
+        const sfVector2f vCenter = sfView_getCenter(pView);
+        const sfVector2f vSize = sfView_getSize(pView);
+        return (RECTF) {
+            vCenter.x - vSize.x / 2.0f,
+            vCenter.y - vSize.y / 2.0f,
+            vCenter.x + vSize.x / 2.0f,
+            vCenter.y + vSize.y / 2.0f
+        };
+    }
 
-    return (VECTOR2) { world.x, world.y };
+    UpdateMatrices(s_pCurrentCamera);
+    return s_pCurrentCamera->rcVisible;
 }
 
 _Check_return_
@@ -198,6 +350,13 @@ bool Camera_Destroy(
         return false;
     }
 
+    if (s_pCurrentCamera == pCamera) {
+        s_pCurrentCamera = NULL;
+    }
+    if (s_pAppliedView == pCamera->pView) {
+        s_pAppliedView = NULL;
+    }
+
     sfView_destroy(pCamera->pView);
 
     SafeFree(pCamera);
@@ -8,17 +8,31 @@
 #include "utils.h"
 #include "point.h"
 #include "vector2.h"
+#include "rect.h"
 
 typedef struct sfView sfView;
 
+/*
+ * Setters only record the new values. The `sfView` is brought up to date and handed to the render window by
+ * `Camera_Apply`, right before the first draw that needs it, so moving the camera several times in a frame costs
+ * a single view change. The transforms used by `WorldToScreen` and `ScreenToWorld`, and the visible bounds, are
+ * likewise rebuilt only after the camera changed.
+ */
 typedef struct _Camera {
-    FLOAT x;
+    FLOAT x;                   // << Center of the view in world space
     FLOAT y;
     FLOAT fWidth;
     FLOAT fHeight;
-    FLOAT fRotation;
+    FLOAT fRotation;           // << Degrees, clockwise on screen
     FLOAT fZoom;
     sfView* pView;
+    bool bViewDirty;           // << `pView` does not match the fields above yet
+    bool bMatricesDirty;       // << The cached transforms do not match the fields above yet
+    INT iMatrixWindowWidth;    // << Window size the cached transforms were built for
+    INT iMatrixWindowHeight;
+    FLOAT arrWorldToScreen[6]; // << Row-major 2x3 affine transform from world space to window pixels
+    FLOAT arrScreenToWorld[6]; // << Inverse of `arrWorldToScreen`
+    RECTF rcVisible;           // << World-space bounds of the window, cached with the transforms
 } Camera;
 
 /**
@@ -27,12 +41,11 @@ typedef struct _Camera {
  * This function initializes a `Camera` struct with the specified position, size, rotation, and zoom level.
  * The camera can be used for viewing and rendering parts of the scene with specific transformations.
  *
- * @param x        X coordinate for the camera's position.
- * @param y        Y coordinate for the camera's position.
+ * @param x        X coordinate of the left edge of the camera's view; the camera's position is the view's center.
+ * @param y        Y coordinate of the top edge of the camera's view.
  * @param fWidth   Width of the camera's viewing area.
  * @param fHeight  Height of the camera's viewing area.
- * @param fRotation Rotation angle (in radians) for the camera.
- * @param fZoom    Zoom factor for the camera (1.0 for no zoom, greater than 1.0 for zoom-in, less than 1.0 for zoom-out).
+ * @param fRotation Rotation angle (in degrees) for the camera.
  * @return A `Camera` struct initialized with the provided properties.
  */
 _Check_return_ _Ret_maybenull_ Camera* Camera_Create(
@@ -61,12 +74,12 @@ void Camera_SetZoom(
 /**
  * @brief Sets the rotation of the camera.
  *
- * This function updates the rotation angle for the specified camera. The rotation is applied in radians,
- * where a value of 0.0 represents no rotation. Positive values rotate the camera counterclockwise,
- * while negative values rotate it clockwise.
+ * This function updates the rotation angle for the specified camera. The rotation is applied in degrees,
+ * where a value of 0.0 represents no rotation. Positive values rotate the camera clockwise, so the scene
+ * appears to turn counterclockwise.
  *
  * @param pCamera Pointer to the `Camera` whose rotation will be updated.
- * @param fRotation New rotation angle for the camera in radians. A value of 0.0 means no rotation.
+ * @param fRotation New rotation angle for the camera in degrees. A value of 0.0 means no rotation.
  */
 void Camera_SetRotation(
     _Inout_ Camera* pCamera,
@@ -123,16 +136,25 @@ void Camera_MovePosition(
 /**
  * @brief Activates the specified camera for rendering.
  *
- * This function applies the transformations (position, rotation, zoom, etc.) of the specified camera
- * to the rendering context. Once this function is called, subsequent rendering operations will be affected
- * by the camera's properties, such as its position and zoom level.
+ * Subsequent rendering operations will be affected by the camera's properties, such as its position and zoom
+ * level. The view itself is applied lazily by `Camera_Apply`, so switching cameras without drawing is free.
  *
- * @param pCamera Pointer to the `Camera` to be used for rendering.
+ * @param pCamera Pointer to the `Camera` to be used for rendering, or `NULL` for the window's default view.
  */
 void Camera_Use(
     _In_opt_ Camera* pCamera
     );
 
+/**
+ * @brief Hands the active camera's view to the render window if it is not already there.
+ *
+ * The draw functions in render-stats.h call this before every draw, so the view is set at most once per camera
+ * change rather than once per camera mutation.
+ */
+void Camera_Apply(
+    void
+    );
+
 /**
  * @brief Converts world coordinates to screen coordinates.
  *
@@ -193,6 +215,48 @@ _Check_return_ VECTOR2 ScreenToWorldV(
     _In_ POINT screen
     );
 
+/**
+ * @brief Converts many points from world to screen coordinates at once.
+ *
+ * Uses the active camera's cached transform in a plain loop the compiler can vectorise, which is much cheaper than
+ * calling `WorldToScreen` per point when projecting e.g. every unit's health bar.
+ *
+ * @param arrWorld  Points in world space.
+ * @param arrScreen Receives the points in screen space. Must not overlap `arrWorld`.
+ * @param nCount    Number of points.
+ */
+void WorldToScreenBatch(
+    _In_reads_(nCount)  const VECTOR2* RESTRICT arrWorld,
+    _Out_writes_(nCount) VECTOR2* RESTRICT arrScreen,
+    _In_                INT nCount
+    );
+
+/**
+ * @brief Converts many points from screen to world coordinates at once.
+ *
+ * @param arrScreen Points in screen space, in pixels.
+ * @param arrWorld  Receives the points in world space.
+ * @param nCount    Number of points.
+ */
+void ScreenToWorldBatch(
+    _In_reads_(nCount)  const POINT* RESTRICT arrScreen,
+    _Out_writes_(nCount) VECTOR2* RESTRICT arrWorld,
+    _In_                INT nCount
+    );
+
+/**
+ * @brief Gets the part of the world the active camera shows.
+ *
+ * With a rotated camera the window covers a rotated rectangle of the world; the bounds enclose it, so anything
+ * outside them is certainly off screen. The bounds are cached and only recomputed after the camera moved, zoomed
+ * or rotated, so culling code may call this freely. Without an active camera the window's default view is used.
+ *
+ * @return The world-space rectangle covered by the window.
+ */
+_Check_return_ RECTF Camera_GetVisibleBounds(
+    void
+    );
+
 /**
  * @brief Gets the current zoom level of the camera.
  *
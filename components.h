@@ -0,0 +1,53 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "utils.h"
+#include "point.h"
+#include "vector2.h"
+
+#define UNIT_MAX_PATH_LENGTH 64
+
+/*
+ * Component types an entity can have. Each has its own dense array in an `EcsWorld`, holding the type named
+ * in the comment. Adding a type here and its size in `ecs.c` is all a new component needs.
+ */
+typedef enum _EcsComponent {
+    ECS_COMPONENT_POSITION,    // << WorldPosition
+    ECS_COMPONENT_MOTION,      // << UnitMotion
+    ECS_COMPONENT_PATH,        // << UnitPath
+    ECS_COMPONENT_UNIT,        // << Unit*, the unit the entity belongs to
+    ECS_COMPONENT_SPRITE,      // << Sprite*, drawn at the entity's position, or where it is if the entity has none
+    ECS_COMPONENT_ANIMATION,   // << AnimatedSprite*, whose frames advance every rendered frame
+    ECS_COMPONENT_COUNT
+} EcsComponent;
+
+/*
+ * Where an entity is in the world. Written by the simulation and read when drawing, so sprites follow it.
+ */
+typedef struct _WorldPosition {
+    VECTOR2 vPosition;     // << World position after the latest tick
+    VECTOR2 vPrevPosition; // << World position after the tick before, drawing blends from it to vPosition
+} WorldPosition;
+
+/*
+ * How an entity is moving between tiles. Read and written by every simulation tick.
+ */
+typedef struct _UnitMotion {
+    VECTOR2 vStart;       // << Moving start vector in world space eg. (16, 16)
+    VECTOR2 vTarget;      // << Moving target vector in world space eg. (48, 32)
+    FLOAT fMoveDuration;  // << Time it should take to move
+    FLOAT fMoveElapsed;   // << Time spent moving so far
+    FLOAT fMoveSpeed;     // << Speed of the unit in pixels per second
+    bool bIsMoving;       // << Is the unit currently moving?
+} UnitMotion;
+
+/*
+ * The path an entity is walking. Only read when a step ends, so it is kept apart from `UnitMotion`.
+ */
+typedef struct _UnitPath {
+    POINT arrPath[UNIT_MAX_PATH_LENGTH]; // << Tiles of the path being walked, one step each
+    INT nPathLength;      // << Number of tiles in arrPath, 0 when not walking a path
+    INT iPathStep;        // << Index in arrPath of the tile currently being moved to
+} UnitPath;
+
+#endif //COMPONENTS_H
@@ -0,0 +1,332 @@
+#include "ecs.h"
+
+#include <string.h>
+
+#include "job-system.h"
+
+static const size_t s_arrComponentSizes[ECS_COMPONENT_COUNT] = {
+    [ECS_COMPONENT_POSITION] = sizeof(WorldPosition),
+    [ECS_COMPONENT_MOTION] = sizeof(UnitMotion),
+    [ECS_COMPONENT_PATH] = sizeof(UnitPath),
+    [ECS_COMPONENT_UNIT] = sizeof(void*),
+    [ECS_COMPONENT_SPRITE] = sizeof(void*),
+    [ECS_COMPONENT_ANIMATION] = sizeof(void*)
+};
+
+/*
+ * One `Ecs_Each` call, shared by the batches of `Ecs_EachParallel`.
+ */
+typedef struct _EcsEach {
+    EcsWorld* pWorld;
+    const EcsStorage* arrStorages[ECS_MAX_QUERY_COMPONENTS];
+    INT nComponents;
+    const EcsStorage* pDriver; // << Storage with the fewest components, whose entities are walked
+    EcsEachFunction pfnEach;
+    void* pUserData;
+} EcsEach;
+
+_Check_return_ _Ret_maybenull_
+EcsWorld* Ecs_Create(
+    void
+) {
+    EcsWorld* pWorld = calloc(1, sizeof(EcsWorld));
+    if (!pWorld) {
+        printf("Failed to allocate memory for EcsWorld\n");
+        return NULL;
+    }
+
+    pWorld->iFreeHead = -1;
+    for (INT i = 0; i < ECS_COMPONENT_COUNT; i++) {
+        pWorld->arrStorages[i].cbComponent = s_arrComponentSizes[i];
+    }
+    return pWorld;
+}
+
+_Check_return_
+static bool GrowEntities(
+    _Inout_ EcsWorld* pWorld
+) {
+    const INT nCapacity = pWorld->nEntityCapacity ? pWorld->nEntityCapacity * 2 : 64;
+
+    UINT* arrGenerations = realloc(pWorld->arrGenerations, nCapacity * sizeof(UINT));
+    if (!arrGenerations) {
+        return false;
+    }
+    pWorld->arrGenerations = arrGenerations;
+
+    UINT* arrNextFree = realloc(pWorld->arrNextFree, nCapacity * sizeof(UINT));
+    if (!arrNextFree) {
+        return false;
+    }
+    pWorld->arrNextFree = arrNextFree;
+
+    for (INT i = 0; i < ECS_COMPONENT_COUNT; i++) {
+        EcsStorage* pStorage = &pWorld->arrStorages[i];
+        INT* arrSparse = realloc(pStorage->arrSparse, nCapacity * sizeof(INT));
+        if (!arrSparse) {
+            return false;
+        }
+        pStorage->arrSparse = arrSparse;
+        memset(arrSparse + pWorld->nEntityCapacity, 0xFF, (nCapacity - pWorld->nEntityCapacity) * sizeof(INT));
+    }
+
+    // Chain the new indices so they are handed out in order
+    for (INT i = nCapacity - 1; i >= pWorld->nEntityCapacity; i--) {
+        pWorld->arrGenerations[i] = 0;
+        pWorld->arrNextFree[i] = (UINT)pWorld->iFreeHead;
+        pWorld->iFreeHead = i;
+    }
+    pWorld->nEntityCapacity = nCapacity;
+    return true;
+}
+
+_Check_return_
+Entity Ecs_CreateEntity(
+    _Inout_ EcsWorld* pWorld
+) {
+    if (pWorld->iFreeHead < 0 && !GrowEntities(pWorld)) {
+        printf("Failed to allocate memory for entity\n");
+        return (Entity) { 0 };
+    }
+
+    const INT iEntity = pWorld->iFreeHead;
+    pWorld->iFreeHead = (INT)pWorld->arrNextFree[iEntity];
+    pWorld->arrGenerations[iEntity]++;
+    pWorld->nAlive++;
+
+    return (Entity) { (UINT)iEntity, pWorld->arrGenerations[iEntity] };
+}
+
+_Check_return_
+bool Ecs_IsAlive(
+    _In_ const EcsWorld* pWorld,
+    _In_ const Entity entity
+) {
+    return entity.uIndex < (UINT)pWorld->nEntityCapacity
+        && (entity.uGeneration & 1) != 0
+        && pWorld->arrGenerations[entity.uIndex] == entity.uGeneration;
+}
+
+static void RemoveFromStorage(
+    _Inout_ EcsStorage* pStorage,
+    _In_    const UINT uEntity
+) {
+    const INT iDense = pStorage->arrSparse[uEntity];
+    if (iDense < 0) {
+        return;
+    }
+
+    const INT iLast = --pStorage->nCount;
+    if (iDense != iLast) {
+        memcpy(pStorage->arrData + (size_t)iDense * pStorage->cbComponent,
+            pStorage->arrData + (size_t)iLast * pStorage->cbComponent,
+            pStorage->cbComponent);
+        pStorage->arrEntities[iDense] = pStorage->arrEntities[iLast];
+        pStorage->arrSparse[pStorage->arrEntities[iDense]] = iDense;
+    }
+    pStorage->arrSparse[uEntity] = -1;
+}
+
+void Ecs_DestroyEntity(
+    _Inout_ EcsWorld* pWorld,
+    _In_    const Entity entity
+) {
+    if (!Ecs_IsAlive(pWorld, entity)) {
+        return;
+    }
+
+    for (INT i = 0; i < ECS_COMPONENT_COUNT; i++) {
+        RemoveFromStorage(&pWorld->arrStorages[i], entity.uIndex);
+    }
+
+    pWorld->arrGenerations[entity.uIndex]++;
+    pWorld->arrNextFree[entity.uIndex] = (UINT)pWorld->iFreeHead;
+    pWorld->iFreeHead = (INT)entity.uIndex;
+    pWorld->nAlive--;
+}
+
+_Check_return_ _Ret_maybenull_
+void* Ecs_AddComponent(
+    _Inout_ EcsWorld* pWorld,
+    _In_    const Entity entity,
+    _In_    const EcsComponent component
+) {
+    if (!Ecs_IsAlive(pWorld, entity)) {
+        return NULL;
+    }
+
+    EcsStorage* pStorage = &pWorld->arrStorages[component];
+    const INT iExisting = pStorage->arrSparse[entity.uIndex];
+    if (iExisting >= 0) {
+        return pStorage->arrData + (size_t)iExisting * pStorage->cbComponent;
+    }
+
+    if (pStorage->nCount >= pStorage->nCapacity) {
+        const INT nCapacity = pStorage->nCapacity ? pStorage->nCapacity * 2 : 16;
+        BYTE* arrData = realloc(pStorage->arrData, (size_t)nCapacity * pStorage->cbComponent);
+        if (!arrData) {
+            printf("Failed to allocate memory for component\n");
+            return NULL;
+        }
+        pStorage->arrData = arrData;
+
+        UINT* arrEntities = realloc(pStorage->arrEntities, nCapacity * sizeof(UINT));
+        if (!arrEntities) {
+            printf("Failed to allocate memory for component\n");
+            return NULL;
+        }
+        pStorage->arrEntities = arrEntities;
+        pStorage->nCapacity = nCapacity;
+    }
+
+    const INT iDense = pStorage->nCount++;
+    pStorage->arrEntities[iDense] = entity.uIndex;
+    pStorage->arrSparse[entity.uIndex] = iDense;
+
+    BYTE* pComponent = pStorage->arrData + (size_t)iDense * pStorage->cbComponent;
+    memset(pComponent, 0, pStorage->cbComponent);
+    return pComponent;
+}
+
+void Ecs_RemoveComponent(
+    _Inout_ EcsWorld* pWorld,
+    _In_    const Entity entity,
+    _In_    const EcsComponent component
+) {
+    if (Ecs_IsAlive(pWorld, entity)) {
+        RemoveFromStorage(&pWorld->arrStorages[component], entity.uIndex);
+    }
+}
+
+_Check_return_ _Ret_maybenull_
+void* Ecs_GetComponent(
+    _In_ const EcsWorld* pWorld,
+    _In_ const Entity entity,
+    _In_ const EcsComponent component
+) {
+    if (!Ecs_IsAlive(pWorld, entity)) {
+        return NULL;
+    }
+
+    const EcsStorage* pStorage = &pWorld->arrStorages[component];
+    const INT iDense = pStorage->arrSparse[entity.uIndex];
+    return iDense >= 0 ? pStorage->arrData + (size_t)iDense * pStorage->cbComponent : NULL;
+}
+
+_Check_return_
+static bool BeginEach(
+    _Out_                   EcsEach* pEach,
+    _Inout_                 EcsWorld* pWorld,
+    _In_reads_(nComponents) const EcsComponent* arrComponents,
+    _In_                    const INT nComponents,
+    _In_                    const EcsEachFunction pfnEach,
+    _In_opt_                void* pUserData
+) {
+    if (nComponents <= 0 || nComponents > ECS_MAX_QUERY_COMPONENTS) {
+        printf("Ecs_Each needs between 1 and %d components, got %d\n", ECS_MAX_QUERY_COMPONENTS, nComponents);
+        return false;
+    }
+
+    pEach->pWorld = pWorld;
+    pEach->nComponents = nComponents;
+    pEach->pfnEach = pfnEach;
+    pEach->pUserData = pUserData;
+    pEach->pDriver = NULL;
+    for (INT i = 0; i < nComponents; i++) {
+        pEach->arrStorages[i] = &pWorld->arrStorages[arrComponents[i]];
+        if (!pEach->pDriver || pEach->arrStorages[i]->nCount < pEach->pDriver->nCount) {
+            pEach->pDriver = pEach->arrStorages[i];
+        }
+    }
+    return true;
+}
+
+static void RunEach(
+    _In_ const EcsEach* pEach,
+    _In_ const INT iBegin,
+    _In_ const INT iEnd
+) {
+    void* arrComponents[ECS_MAX_QUERY_COMPONENTS];
+
+    for (INT iDriver = iBegin; iDriver < iEnd; iDriver++) {
+        const UINT uEntity = pEach->pDriver->arrEntities[iDriver];
+
+        bool bMatch = true;
+        for (INT i = 0; i < pEach->nComponents; i++) {
+            const EcsStorage* pStorage = pEach->arrStorages[i];
+            const INT iDense = pStorage->arrSparse[uEntity];
+            if (iDense < 0) {
+                bMatch = false;
+                break;
+            }
+            arrComponents[i] = pStorage->arrData + (size_t)iDense * pStorage->cbComponent;
+        }
+
+        if (bMatch) {
+            const Entity entity = { uEntity, pEach->pWorld->arrGenerations[uEntity] };
+            pEach->pfnEach(pEach->pUserData, entity, arrComponents);
+        }
+    }
+}
+
+static void RunEachJob(
+    _Inout_ void* pData,
+    _In_    const INT iBegin,
+    _In_    const INT iEnd,
+    _In_    const INT iThread
+) {
+    UnusedParam(iThread);
+    RunEach(pData, iBegin, iEnd);
+}
+
+void Ecs_Each(
+    _Inout_                   EcsWorld* pWorld,
+    _In_reads_(nComponents)   const EcsComponent* arrComponents,
+    _In_                      const INT nComponents,
+    _In_                      const EcsEachFunction pfnEach,
+    _In_opt_                  void* pUserData
+) {
+    EcsEach each;
+    if (BeginEach(&each, pWorld, arrComponents, nComponents, pfnEach, pUserData)) {
+        RunEach(&each, 0, each.pDriver->nCount);
+    }
+}
+
+void Ecs_EachParallel(
+    _Inout_                   EcsWorld* pWorld,
+    _Inout_opt_               JobSystem* pJobs,
+    _In_reads_(nComponents)   const EcsComponent* arrComponents,
+    _In_                      const INT nComponents,
+    _In_                      const EcsEachFunction pfnEach,
+    _In_opt_                  void* pUserData
+) {
+    EcsEach each;
+    if (!BeginEach(&each, pWorld, arrComponents, nComponents, pfnEach, pUserData)) {
+        return;
+    }
+
+    if (pJobs) {
+        JobSystem_ParallelFor(pJobs, each.pDriver->nCount, 0, RunEachJob, &each);
+    } else {
+        RunEach(&each, 0, each.pDriver->nCount);
+    }
+}
+
+_Check_return_opt_
+bool Ecs_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ EcsWorld* pWorld
+) {
+    if (!pWorld) {
+        return false;
+    }
+
+    for (INT i = 0; i < ECS_COMPONENT_COUNT; i++) {
+        SafeFree(pWorld->arrStorages[i].arrData);
+        SafeFree(pWorld->arrStorages[i].arrEntities);
+        SafeFree(pWorld->arrStorages[i].arrSparse);
+    }
+    SafeFree(pWorld->arrGenerations);
+    SafeFree(pWorld->arrNextFree);
+    SafeFree(pWorld);
+    return true;
+}
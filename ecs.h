@@ -0,0 +1,178 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include "utils.h"
+#include "components.h"
+
+typedef struct _JobSystem JobSystem;
+
+#define ECS_MAX_QUERY_COMPONENTS 4
+
+/*
+ * Handle of an entity. The index is reused once the entity is destroyed; the generation tells the old and the
+ * new entity apart. A zeroed handle never refers to a live entity.
+ */
+typedef struct _Entity {
+    UINT uIndex;
+    UINT uGeneration;          // << Odd while the entity is alive
+} Entity;
+
+/*
+ * All components of one type, as a sparse set. `arrData` holds them packed with no gaps, and `arrEntities` says
+ * which entity each belongs to; `arrSparse` goes the other way, from entity index to position in `arrData`.
+ * Removing a component moves the last one into its place.
+ */
+typedef struct _EcsStorage {
+    size_t cbComponent;
+    BYTE* arrData;
+    UINT* arrEntities;         // << Entity index of each component in arrData
+    INT* arrSparse;            // << Position in arrData for each entity index, -1 if the entity has none
+    INT nCount;
+    INT nCapacity;
+} EcsStorage;
+
+/*
+ * Entities and their components. An entity is only an index; what it is comes from the components it has, and
+ * systems act on every entity that has the components they need, by walking the packed arrays.
+ *
+ * Component pointers stay valid until a component of the same type is added or removed. Systems must not add or
+ * remove components or entities while they iterate. Not thread-safe, except that the function given to
+ * `Ecs_EachParallel` may run on several threads.
+ */
+typedef struct _EcsWorld {
+    UINT* arrGenerations;      // << Per entity index, see `Entity`
+    UINT* arrNextFree;         // << Next free entity index for each free index
+    INT nEntityCapacity;
+    INT iFreeHead;             // << First free entity index, -1 if none
+    INT nAlive;
+    EcsStorage arrStorages[ECS_COMPONENT_COUNT];
+} EcsWorld;
+
+/**
+ * @brief Function a system runs for each matching entity.
+ *
+ * @param pUserData     User data given to `Ecs_Each`.
+ * @param entity        The entity.
+ * @param arrComponents The entity's components, in the order they were asked for.
+ */
+typedef void (*EcsEachFunction)(void* pUserData, Entity entity, void* const* arrComponents);
+
+/**
+ * @brief Creates an empty world.
+ *
+ * @return A pointer to the new `EcsWorld`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ EcsWorld* Ecs_Create(
+    void
+    );
+
+/**
+ * @brief Creates an entity with no components.
+ *
+ * @param pWorld Pointer to the `EcsWorld`.
+ * @return The new entity, or a zeroed handle if the allocation failed.
+ */
+_Check_return_ Entity Ecs_CreateEntity(
+    _Inout_ EcsWorld* pWorld
+    );
+
+/**
+ * @brief Destroys an entity and all its components. Does nothing if the entity is already gone.
+ */
+void Ecs_DestroyEntity(
+    _Inout_ EcsWorld* pWorld,
+    _In_    Entity entity
+    );
+
+/**
+ * @brief Checks whether an entity has not been destroyed.
+ */
+_Check_return_ bool Ecs_IsAlive(
+    _In_ const EcsWorld* pWorld,
+    _In_ Entity entity
+    );
+
+/**
+ * @brief Adds a component to an entity.
+ *
+ * @param pWorld     Pointer to the `EcsWorld`.
+ * @param entity     A live entity.
+ * @param component  Type of the component.
+ * @return The zeroed component, the existing one if the entity already has it, or `NULL` if the entity is gone
+ *         or the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ void* Ecs_AddComponent(
+    _Inout_ EcsWorld* pWorld,
+    _In_    Entity entity,
+    _In_    EcsComponent component
+    );
+
+/**
+ * @brief Removes a component from an entity, if it has it.
+ */
+void Ecs_RemoveComponent(
+    _Inout_ EcsWorld* pWorld,
+    _In_    Entity entity,
+    _In_    EcsComponent component
+    );
+
+/**
+ * @brief Gets a component of an entity.
+ *
+ * @return The component, or `NULL` if the entity is gone or does not have it.
+ */
+_Check_return_ _Ret_maybenull_ void* Ecs_GetComponent(
+    _In_ const EcsWorld* pWorld,
+    _In_ Entity entity,
+    _In_ EcsComponent component
+    );
+
+/**
+ * @brief Runs a function for every entity that has all the given components.
+ *
+ * Walks the smallest of the component arrays and looks the others up, so the cost follows the rarest component.
+ *
+ * @param pWorld        Pointer to the `EcsWorld`.
+ * @param arrComponents Components the entity must have; at most `ECS_MAX_QUERY_COMPONENTS`.
+ * @param nComponents   Number of components.
+ * @param pfnEach       Function to run.
+ * @param pUserData     Passed to `pfnEach`.
+ */
+void Ecs_Each(
+    _Inout_                   EcsWorld* pWorld,
+    _In_reads_(nComponents)   const EcsComponent* arrComponents,
+    _In_                      INT nComponents,
+    _In_                      EcsEachFunction pfnEach,
+    _In_opt_                  void* pUserData
+    );
+
+/**
+ * @brief Like `Ecs_Each`, but spreads the entities over a job system's threads.
+ *
+ * `pfnEach` may only change the components it is given and must not touch anything shared with other entities.
+ * Must be called from the job system's owning thread.
+ *
+ * @param pJobs Job system to run on, or `NULL` to run on the calling thread.
+ */
+void Ecs_EachParallel(
+    _Inout_                   EcsWorld* pWorld,
+    _Inout_opt_               JobSystem* pJobs,
+    _In_reads_(nComponents)   const EcsComponent* arrComponents,
+    _In_                      INT nComponents,
+    _In_                      EcsEachFunction pfnEach,
+    _In_opt_                  void* pUserData
+    );
+
+/**
+ * @brief Destroys a world with all its entities and components.
+ *
+ * Components that point at other objects, like sprites and units, do not own them; free those first.
+ *
+ * @param pWorld Pointer to the `EcsWorld` to destroy.
+ * @return `true` if the world was destroyed, `false` if `pWorld` was `NULL`.
+ */
+_Check_return_opt_ bool Ecs_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ EcsWorld* pWorld
+    );
+
+#endif //ECS_H
@@ -2,17 +2,30 @@
 
 #include <string.h>
 
+#ifdef _WIN32
+#include "win32.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pack.h"
+#include "arena.h"
+
 _Check_return_ _Ret_maybenull_
-File* File_Open(
-    _In_z_ PCSTR pszFilename
+static File* OpenFromDisk(
+    _In_z_ PCSTR pszFilename,
+    _In_z_ PCSTR pszMode
 ) {
     FILE* pFileHandle = NULL;
-    fopen_s(&pFileHandle, pszFilename, "r");
+    fopen_s(&pFileHandle, pszFilename, pszMode);
     if (pFileHandle == NULL) {
         return NULL;
     }
 
-    File* pFile = malloc(sizeof(File));
+    File* pFile = calloc(1, sizeof(File));
     if (pFile == NULL) {
         fclose(pFileHandle);
         return NULL;
@@ -24,30 +37,117 @@ File* File_Open(
 
     pFile->pszFilename = strdup(pszFilename);
     pFile->pFileHandle = pFileHandle;
+    pFile->bText = strchr(pszMode, 'b') == NULL;
+
+    return pFile;
+}
 
+_Check_return_ _Ret_maybenull_
+static File* OpenFromPack(
+    _In_z_ PCSTR pszFilename,
+    _In_z_ PCSTR pszMode
+) {
+    const BYTE* pData;
+    ULONG cbSize;
+    BYTE* pOwnedBuffer;
+    if (!Pack_Lookup(pszFilename, &pData, &cbSize, &pOwnedBuffer)) {
+        return NULL;
+    }
+
+    File* pFile = calloc(1, sizeof(File));
+    if (pFile == NULL) {
+        SafeFree(pOwnedBuffer);
+        return NULL;
+    }
+
+    pFile->pszFilename = strdup(pszFilename);
+    pFile->cbSize = (LONG)cbSize;
+    pFile->pMemory = pData;
+    pFile->pOwnedMemory = pOwnedBuffer;
+    pFile->bText = strchr(pszMode, 'b') == NULL;
+
+    return pFile;
+}
+
+_Check_return_ _Ret_maybenull_
+static File* OpenWithMode(
+    _In_z_ PCSTR pszFilename,
+    _In_z_ PCSTR pszMode
+) {
+    File* pFile;
+    if (Pack_GetLooseFilesFirst()) {
+        pFile = OpenFromDisk(pszFilename, pszMode);
+        if (!pFile) {
+            pFile = OpenFromPack(pszFilename, pszMode);
+        }
+    } else {
+        pFile = OpenFromPack(pszFilename, pszMode);
+        if (!pFile) {
+            pFile = OpenFromDisk(pszFilename, pszMode);
+        }
+    }
     return pFile;
 }
 
+_Check_return_
+static ULONG ReadMemory(
+    _In_                       const File* pFile,
+    _Out_writes_bytes_(cbSize) void* pDest,
+    _In_                       const ULONG cbSize
+) {
+    // Reads never change what the caller sees of the file, only where the next read starts
+    File* pMutableFile = (File*)pFile;
+
+    const ULONG cbRemaining = (ULONG)(pFile->cbSize - pFile->cbPosition);
+    const ULONG cbRead = cbSize < cbRemaining ? cbSize : cbRemaining;
+    memcpy(pDest, pFile->pMemory + pFile->cbPosition, cbRead);
+    pMutableFile->cbPosition += (LONG)cbRead;
+    return cbRead;
+}
+
+_Check_return_ _Ret_maybenull_
+File* File_Open(
+    _In_z_ PCSTR pszFilename
+) {
+    return OpenWithMode(pszFilename, "r");
+}
+
+_Check_return_ _Ret_maybenull_
+File* File_OpenBinary(
+    _In_z_ PCSTR pszFilename
+) {
+    return OpenWithMode(pszFilename, "rb");
+}
+
 _Check_return_
 bool File_Exists(
     _In_z_ PCSTR pszFilename
 ) {
+    if (!Pack_GetLooseFilesFirst() && Pack_Contains(pszFilename)) {
+        return true;
+    }
+
     FILE* pFileHandle = NULL;
     fopen_s(&pFileHandle, pszFilename, "r");
     if (pFileHandle) {
         fclose(pFileHandle);
         return true;
     }
-    return false;
+
+    return Pack_Contains(pszFilename);
 }
 
 _Check_return_
 BYTE File_ReadByte(
     _In_ const File* pFile
 ) {
-    if (!pFile || !pFile->pFileHandle) {
+    if (!File_IsOpen(pFile)) {
         return 0;
     }
+    if (pFile->pMemory) {
+        BYTE byte = 0;
+        return ReadMemory(pFile, &byte, sizeof(BYTE)) == sizeof(BYTE) ? byte : 0;
+    }
     const BYTE byte = (BYTE)fgetc(pFile->pFileHandle);
     if (feof(pFile->pFileHandle)) {
         return 0;
@@ -59,10 +159,13 @@ _Check_return_
 INT File_ReadInt(
     _In_ const File* pFile
 ) {
-    if (!pFile || !pFile->pFileHandle) {
+    if (!File_IsOpen(pFile)) {
         return 0;
     }
     INT value = 0;
+    if (pFile->pMemory) {
+        return ReadMemory(pFile, &value, sizeof(INT)) == sizeof(INT) ? value : 0;
+    }
     fread(&value, sizeof(INT), 1, pFile->pFileHandle);
     if (feof(pFile->pFileHandle)) {
         return 0;
@@ -74,10 +177,13 @@ _Check_return_
 FLOAT File_ReadFloat(
     _In_ const File* pFile
 ) {
-    if (!pFile || !pFile->pFileHandle) {
+    if (!File_IsOpen(pFile)) {
         return 0.0f;
     }
     FLOAT value = 0.0f;
+    if (pFile->pMemory) {
+        return ReadMemory(pFile, &value, sizeof(FLOAT)) == sizeof(FLOAT) ? value : 0.0f;
+    }
     fread(&value, sizeof(FLOAT), 1, pFile->pFileHandle);
     if (feof(pFile->pFileHandle)) {
         return 0.0f;
@@ -85,16 +191,107 @@ FLOAT File_ReadFloat(
     return value;
 }
 
+_Check_return_ _Ret_maybenull_
+_Success_(return != NULL)
+static PSTR ReadLineFromMemory(
+    _In_      const File* pFile,
+    _In_opt_  Arena* pArena,
+    _Out_opt_ ULONG* pcchBufferSize
+) {
+    File* pMutableFile = (File*)pFile;
+
+    if (pFile->cbPosition >= pFile->cbSize) {
+        return NULL;
+    }
+
+    const char* pLine = (const char*)pFile->pMemory + pFile->cbPosition;
+    const ULONG cbRemaining = (ULONG)(pFile->cbSize - pFile->cbPosition);
+    const char* pNewline = memchr(pLine, '\n', cbRemaining);
+    const ULONG cchLine = pNewline ? (ULONG)(pNewline - pLine) + 1 : cbRemaining;
+
+    PSTR pstrBuffer = pArena ? Arena_AllocAligned(pArena, cchLine + 1, 1) : malloc(cchLine + 1);
+    if (!pstrBuffer) {
+        return NULL;
+    }
+
+    memcpy(pstrBuffer, pLine, cchLine);
+    ULONG cchBuffer = cchLine;
+    if (pFile->bText && cchBuffer >= 2 && pstrBuffer[cchBuffer - 1] == '\n' && pstrBuffer[cchBuffer - 2] == '\r') {
+        pstrBuffer[cchBuffer - 2] = '\n';
+        cchBuffer--;
+    }
+    pstrBuffer[cchBuffer] = '\0';
+
+    pMutableFile->cbPosition += (LONG)cchLine;
+
+    if (pcchBufferSize != NULL) {
+        *pcchBufferSize = cchBuffer;
+    }
+
+    return pstrBuffer;
+}
+
+/**
+ * An arena cannot grow the last allocation, so the line is measured first and then read in one go.
+ */
+_Check_return_ _Ret_maybenull_
+static PSTR ReadLineIntoArena(
+    _In_      const File* pFile,
+    _Inout_   Arena* pArena,
+    _Out_opt_ ULONG* pcchBufferSize
+) {
+    const long lStart = ftell(pFile->pFileHandle);
+    if (lStart < 0) {
+        return NULL;
+    }
+
+    ULONG cchLine = 0;
+    int ch;
+    while ((ch = fgetc(pFile->pFileHandle)) != EOF) {
+        cchLine++;
+        if (ch == '\n') {
+            break;
+        }
+    }
+
+    if (cchLine == 0) {
+        return NULL;
+    }
+
+    PSTR pstrBuffer = Arena_AllocAligned(pArena, cchLine + 1, 1);
+    if (!pstrBuffer || fseek(pFile->pFileHandle, lStart, SEEK_SET) != 0) {
+        return NULL;
+    }
+
+    const ULONG cchRead = (ULONG)fread(pstrBuffer, 1, cchLine, pFile->pFileHandle);
+    pstrBuffer[cchRead] = '\0';
+
+    if (pcchBufferSize != NULL) {
+        *pcchBufferSize = cchRead;
+    }
+
+    return pstrBuffer;
+}
+
 _Check_return_ _Ret_maybenull_
 _Success_(return != NULL)
 PSTR File_ReadLine(
     _In_      const File* pFile,
+    _In_opt_  Arena* pArena,
     _Out_opt_ ULONG* pcchBufferSize
 ) {
-    if (!pFile || !pFile->pFileHandle) {
+    if (!File_IsOpen(pFile)) {
         return NULL;
     }
 
+    if (pFile->pMemory) {
+        return ReadLineFromMemory(pFile, pArena, pcchBufferSize);
+    }
+
+    if (pArena) {
+        return ReadLineIntoArena(pFile, pArena, pcchBufferSize);
+    }
+
     ULONG nMaxBufferSize = 128;
     ULONG iCurrentChar = 0;
     PSTR pstrBuffer = malloc(nMaxBufferSize * sizeof(char));
@@ -140,7 +337,7 @@ PSTR File_ReadAllBytes(
     _In_      const File* pFile,
     _Out_opt_ ULONG* pcchBufferSize
 ) {
-    if (!pFile || !pFile->pFileHandle) {
+    if (!File_IsOpen(pFile)) {
         return NULL;
     }
 
@@ -150,6 +347,15 @@ PSTR File_ReadAllBytes(
         return NULL;
     }
 
+    if (pFile->pMemory) {
+        const ULONG cchBuffer = ReadMemory(pFile, pstrBuffer, pFile->cbSize);
+        pstrBuffer[cchBuffer] = '\0';
+        if (pcchBufferSize != NULL) {
+            *pcchBufferSize = cchBuffer;
+        }
+        return pstrBuffer;
+    }
+
     const ULONG cchBuffer = fread(pstrBuffer, sizeof(char), pFile->cbSize, pFile->pFileHandle);
     if (cchBuffer == 0 && ferror(pFile->pFileHandle)) {
         SafeFree(pstrBuffer);
@@ -168,7 +374,7 @@ _Check_return_
 bool File_IsOpen(
     _In_ const File* pFile
 ) {
-    return pFile != NULL && pFile->pFileHandle != NULL;
+    return pFile != NULL && (pFile->pFileHandle != NULL || pFile->pMemory != NULL);
 }
 
 _Check_return_ _Ret_z_
@@ -198,7 +404,189 @@ bool File_Close(
         pFile->pFileHandle = NULL;
     }
 
+    pFile->pMemory = NULL;
+    SafeFree(pFile->pOwnedMemory);
     SafeFree(pFile->pszFilename);
     SafeFree(pFile);
     return true;
 }
+
+_Check_return_ _Ret_maybenull_
+static FileView* MapFromPack(
+    _In_z_ PCSTR pszFilename
+) {
+    const BYTE* pData;
+    ULONG cbSize;
+    BYTE* pOwnedBuffer;
+    if (!Pack_Lookup(pszFilename, &pData, &cbSize, &pOwnedBuffer)) {
+        return NULL;
+    }
+
+    FileView* pView = calloc(1, sizeof(FileView));
+    if (!pView) {
+        SafeFree(pOwnedBuffer);
+        return NULL;
+    }
+
+    // Either points into the pack mapping, which stays valid while the pack is mounted, or at a decompressed copy
+    pView->pData = pData;
+    pView->cbSize = cbSize;
+    pView->pOwnedData = pOwnedBuffer;
+    pView->pszFilename = strdup(pszFilename);
+
+    return pView;
+}
+
+_Check_return_ _Ret_maybenull_
+static FileView* MapFromDisk(
+    _In_z_ PCSTR pszFilename
+) {
+    FileView* pView = calloc(1, sizeof(FileView));
+    if (!pView) {
+        return NULL;
+    }
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(
+        pszFilename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL
+    );
+    if (hFile == INVALID_HANDLE_VALUE) {
+        SafeFree(pView);
+        return NULL;
+    }
+
+    LARGE_INTEGER liSize;
+    if (!GetFileSizeEx(hFile, &liSize)) {
+        CloseHandle(hFile);
+        SafeFree(pView);
+        return NULL;
+    }
+
+    if (liSize.QuadPart > 0) {
+        HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!hMapping) {
+            CloseHandle(hFile);
+            SafeFree(pView);
+            return NULL;
+        }
+
+        pView->pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        if (!pView->pData) {
+            CloseHandle(hMapping);
+            CloseHandle(hFile);
+            SafeFree(pView);
+            return NULL;
+        }
+        pView->hMapping = hMapping;
+    }
+
+    pView->hFile = hFile;
+    pView->cbSize = (ULONG)liSize.QuadPart;
+#else
+    const int fd = open(pszFilename, O_RDONLY);
+    if (fd < 0) {
+        SafeFree(pView);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        SafeFree(pView);
+        return NULL;
+    }
+
+    if (st.st_size > 0) {
+        void* pData = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pData == MAP_FAILED) {
+            close(fd);
+            SafeFree(pView);
+            return NULL;
+        }
+        pView->pData = pData;
+        pView->hMapping = pData;
+    }
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+    pView->cbSize = (ULONG)st.st_size;
+#endif
+
+    pView->pszFilename = strdup(pszFilename);
+
+    return pView;
+}
+
+_Check_return_ _Ret_maybenull_
+FileView* File_Map(
+    _In_z_ PCSTR pszFilename
+) {
+    FileView* pView;
+    if (Pack_GetLooseFilesFirst()) {
+        pView = MapFromDisk(pszFilename);
+        if (!pView) {
+            pView = MapFromPack(pszFilename);
+        }
+    } else {
+        pView = MapFromPack(pszFilename);
+        if (!pView) {
+            pView = MapFromDisk(pszFilename);
+        }
+    }
+    return pView;
+}
+
+_Check_return_ _Ret_maybenull_
+const BYTE* FileView_GetData(
+    _In_ const FileView* pView
+) {
+    return pView->pData;
+}
+
+_Check_return_
+ULONG FileView_GetSize(
+    _In_ const FileView* pView
+) {
+    return pView->cbSize;
+}
+
+_Check_return_ _Ret_z_
+PCSTR FileView_GetFilename(
+    _In_ const FileView* pView
+) {
+    return pView->pszFilename;
+}
+
+_Check_return_opt_
+bool File_Unmap(
+    _Inout_ _Pre_valid_ _Post_invalid_ FileView* pView
+) {
+    if (pView == NULL) {
+        return false;
+    }
+
+#ifdef _WIN32
+    if (pView->hMapping != NULL) {
+        UnmapViewOfFile(pView->pData);
+        CloseHandle(pView->hMapping);
+    }
+    if (pView->hFile != NULL) {
+        CloseHandle(pView->hFile);
+    }
+#else
+    if (pView->hMapping != NULL) {
+        munmap(pView->hMapping, pView->cbSize);
+    }
+#endif
+
+    SafeFree(pView->pOwnedData);
+    SafeFree(pView->pszFilename);
+    SafeFree(pView);
+    return true;
+}
@@ -3,17 +3,37 @@
 
 #include "utils.h"
 
+typedef struct _Arena Arena;
+
 typedef struct _File {
     PSTR pszFilename;
     LONG cbSize;
-    FILE* pFileHandle;
+    FILE* pFileHandle;    // << Handle for files on disk, NULL for pack entries
+    const BYTE* pMemory;  // << Entry data for files resolved through a mounted pack
+    BYTE* pOwnedMemory;   // << Decompressed copy of a compressed pack entry, freed on close
+    LONG cbPosition;      // << Read position inside pMemory
+    bool bText;           // << Opened in text mode? Memory reads then drop '\r' before '\n'
 } File;
 
+typedef struct _FileView {
+    PSTR pszFilename;
+    const BYTE* pData;   // << Read-only view of the whole file, NULL for empty files
+    ULONG cbSize;
+    void* hFile;         // << Platform file handle kept open while the view is mapped (Windows only)
+    void* hMapping;      // << Mapping handle or base address, NULL for empty files and pack entries
+    BYTE* pOwnedData;    // << Decompressed copy of a compressed pack entry, freed on unmap
+} FileView;
+
 _Check_return_ _Ret_maybenull_
 File* File_Open(
     _In_z_ PCSTR pszFilename
     );
 
+_Check_return_ _Ret_maybenull_
+File* File_OpenBinary(
+    _In_z_ PCSTR pszFilename
+    );
+
 _Check_return_
 bool File_Exists(
     _In_z_ PCSTR pszFilename
@@ -34,10 +54,20 @@ FLOAT File_ReadFloat(
     _In_ const File* pFile
     );
 
+/**
+ * @brief Reads the next line, including its '\n'.
+ *
+ * @param pFile          The file to read from.
+ * @param pArena         Arena to allocate the line from, e.g. `Arena_GetScratch()`, or `NULL` to return heap
+ *                       memory the caller frees.
+ * @param pcchBufferSize Receives the length of the line.
+ * @return The null-terminated line, or `NULL` at the end of the file or if it could not be allocated.
+ */
 _Check_return_ _Ret_maybenull_
 _Success_(return != NULL)
 PSTR File_ReadLine(
     _In_      const File* pFile,
+    _In_opt_  Arena* pArena,
     _Out_opt_ ULONG* pcchBufferSize
     );
 
@@ -68,4 +98,48 @@ bool File_Close(
     _Inout_ _Pre_valid_ _Post_invalid_ File* pFile
     );
 
+/**
+ * @brief Maps a whole file into memory as a read-only view.
+ *
+ * Unlike `File_ReadAllBytes`, no buffer is allocated and nothing is copied; pages are loaded by the operating
+ * system on first access. The view stays valid until `File_Unmap` is called, just like a `File` stays open
+ * until `File_Close`.
+ *
+ * @param pszFilename Path to the file to map.
+ * @return A pointer to the new `FileView`, or `NULL` if the file could not be opened or mapped.
+ *
+ * @note The data is not zero-terminated. Use `FileView_GetSize` instead of `strlen`.
+ * @note Compressed pack entries cannot be viewed in place; they are decompressed into a buffer owned by the view.
+ */
+_Check_return_ _Ret_maybenull_
+FileView* File_Map(
+    _In_z_ PCSTR pszFilename
+    );
+
+_Check_return_ _Ret_maybenull_
+const BYTE* FileView_GetData(
+    _In_ const FileView* pView
+    );
+
+_Check_return_
+ULONG FileView_GetSize(
+    _In_ const FileView* pView
+    );
+
+_Check_return_ _Ret_z_
+PCSTR FileView_GetFilename(
+    _In_ const FileView* pView
+    );
+
+/**
+ * @brief Unmaps a file view and releases its handles.
+ *
+ * @param pView Pointer to the `FileView` to unmap. Any pointer obtained from `FileView_GetData` becomes invalid.
+ * @return `true` if the view was unmapped, `false` if `pView` was `NULL`.
+ */
+_Check_return_opt_
+bool File_Unmap(
+    _Inout_ _Pre_valid_ _Post_invalid_ FileView* pView
+    );
+
 #endif //FILE_H
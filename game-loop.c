@@ -0,0 +1,85 @@
+#include "game-loop.h"
+
+#include "window.h"
+#include "profiler.h"
+
+_Check_return_ _Ret_maybenull_
+GameLoop* GameLoop_Create(
+    _In_ INT nTicksPerSecond
+) {
+    if (nTicksPerSecond <= 0) {
+        nTicksPerSecond = GAME_LOOP_DEFAULT_TICK_RATE;
+    }
+
+    GameLoop* pLoop = calloc(1, sizeof(GameLoop));
+    if (!pLoop) {
+        printf("Failed to allocate memory for GameLoop\n");
+        return NULL;
+    }
+
+    pLoop->lTickUs = 1000000 / nTicksPerSecond;
+    return pLoop;
+}
+
+_Check_return_opt_
+INT GameLoop_Advance(
+    _Inout_  GameLoop* pLoop,
+    _In_     INT64 lFrameUs,
+    _In_     const GameLoopTick pfnTick,
+    _In_opt_ void* pUserData
+) {
+    if (lFrameUs > GAME_LOOP_MAX_FRAME_US) {
+        lFrameUs = GAME_LOOP_MAX_FRAME_US;
+    }
+    if (lFrameUs > 0) {
+        pLoop->lAccumulatorUs += lFrameUs;
+    }
+
+    const FLOAT fTickSeconds = (FLOAT)pLoop->lTickUs / 1000000.0f;
+    INT nTicks = 0;
+    while (pLoop->lAccumulatorUs >= pLoop->lTickUs) {
+        if (nTicks == GAME_LOOP_MAX_TICKS_PER_FRAME) {
+            // The simulation cannot keep up; drop the backlog rather than fall further behind every frame
+            pLoop->lAccumulatorUs %= pLoop->lTickUs;
+            break;
+        }
+
+        PROFILE_BEGIN("GameLoop_Tick");
+        pfnTick(pUserData, fTickSeconds);
+        PROFILE_END();
+        pLoop->lAccumulatorUs -= pLoop->lTickUs;
+        pLoop->lTicks++;
+        nTicks++;
+    }
+
+    pLoop->fAlpha = (FLOAT)pLoop->lAccumulatorUs / (FLOAT)pLoop->lTickUs;
+    return nTicks;
+}
+
+void GameLoop_Run(
+    _Inout_  GameLoop* pLoop,
+    _In_     const Window* pWindow,
+    _In_     const GameLoopTick pfnTick,
+    _In_     const GameLoopRender pfnRender,
+    _In_opt_ void* pUserData
+) {
+    while (Window_IsOpen(pWindow)) {
+        GameLoop_Advance(pLoop, GetFrameTimeMicroseconds(), pfnTick, pUserData);
+
+        Window_Clear(0, 0, 0);
+        pfnRender(pUserData, pLoop->fAlpha);
+        Window_Display();
+    }
+}
+
+_Check_return_opt_
+bool GameLoop_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ GameLoop* pLoop
+) {
+    if (!pLoop) {
+        return false;
+    }
+
+    SafeFree(pLoop);
+    return true;
+}
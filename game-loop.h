@@ -0,0 +1,102 @@
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+#include "utils.h"
+
+typedef struct _Window Window;
+
+#define GAME_LOOP_DEFAULT_TICK_RATE 60
+#define GAME_LOOP_MAX_FRAME_US 250000 // << Longer frames are cut short so a stall does not trigger a burst of ticks
+#define GAME_LOOP_MAX_TICKS_PER_FRAME 8
+
+/**
+ * @brief Advances the simulation by one tick.
+ *
+ * @param pUserData    User data given to the loop.
+ * @param fTickSeconds Length of a tick; the same on every call.
+ */
+typedef void (*GameLoopTick)(void* pUserData, FLOAT fTickSeconds);
+
+/**
+ * @brief Draws one frame.
+ *
+ * @param pUserData User data given to the loop.
+ * @param fAlpha    How far the frame lies between the previous tick and the current one, from 0 to 1. Draw each
+ *                  object at its previous state blended towards its current state by this factor.
+ */
+typedef void (*GameLoopRender)(void* pUserData, FLOAT fAlpha);
+
+/*
+ * Fixed-timestep main loop. Frame time goes into an accumulator and the simulation runs in whole ticks of fixed
+ * length, so gameplay is the same at 30 and at 240 frames per second. Rendering runs once per frame, as often as
+ * the display allows, and interpolates between the last two ticks instead of simulating more.
+ *
+ * Time is kept in integer microseconds from the window's monotonic clock, so frames shorter than a millisecond
+ * still count and the accumulator never drifts.
+ */
+typedef struct _GameLoop {
+    INT64 lTickUs;             // << Length of a tick
+    INT64 lAccumulatorUs;      // << Frame time not yet simulated, always less than a tick after a frame
+    INT64 lTicks;              // << Ticks run since the loop was created
+    FLOAT fAlpha;              // << lAccumulatorUs as a fraction of a tick, passed to the render callback
+} GameLoop;
+
+/**
+ * @brief Creates a game loop.
+ *
+ * @param nTicksPerSecond Simulation rate, or `0` for `GAME_LOOP_DEFAULT_TICK_RATE`.
+ * @return A pointer to the new `GameLoop`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ GameLoop* GameLoop_Create(
+    _In_ INT nTicksPerSecond
+    );
+
+/**
+ * @brief Feeds one frame's worth of time into the loop and runs the ticks it covers.
+ *
+ * Called by `GameLoop_Run` every frame; call it directly to drive the loop from another clock, e.g. in tests.
+ *
+ * @param pLoop       Pointer to the `GameLoop`.
+ * @param lFrameUs    Time since the previous frame, in microseconds.
+ * @param pfnTick     Function that advances the simulation by one tick.
+ * @param pUserData   User data passed to `pfnTick`.
+ * @return The number of ticks run.
+ */
+_Check_return_opt_ INT GameLoop_Advance(
+    _Inout_  GameLoop* pLoop,
+    _In_     INT64 lFrameUs,
+    _In_     GameLoopTick pfnTick,
+    _In_opt_ void* pUserData
+    );
+
+/**
+ * @brief Runs ticks and frames until the window closes.
+ *
+ * Each frame polls the window, runs the ticks the elapsed time covers, clears the window, calls `pfnRender` and
+ * displays the result.
+ *
+ * @param pLoop     Pointer to the `GameLoop`.
+ * @param pWindow   Window to run in.
+ * @param pfnTick   Function that advances the simulation by one tick.
+ * @param pfnRender Function that draws a frame.
+ * @param pUserData User data passed to both callbacks.
+ */
+void GameLoop_Run(
+    _Inout_  GameLoop* pLoop,
+    _In_     const Window* pWindow,
+    _In_     GameLoopTick pfnTick,
+    _In_     GameLoopRender pfnRender,
+    _In_opt_ void* pUserData
+    );
+
+/**
+ * @brief Destroys a game loop and frees its resources.
+ *
+ * @param pLoop Pointer to the `GameLoop` to destroy.
+ * @return `true` if the loop was destroyed, `false` if `pLoop` was `NULL`.
+ */
+_Check_return_opt_ bool GameLoop_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ GameLoop* pLoop
+    );
+
+#endif //GAME_LOOP_H
@@ -12,8 +12,11 @@ GuiElement* GuiImage_Create(
     _In_ const FLOAT x,
     _In_ const FLOAT y
 ) {
-    GuiElement* element = malloc(sizeof(GuiElement));
-    element->type = GUI_TYPE_IMAGE;
+    GuiElement* element = GuiElement_Alloc(GUI_TYPE_IMAGE);
+    if (!element) {
+        return NULL;
+    }
+
     element->image.pSprite = Sprite_Create(pTexture, x, y);
     return element;
 }
@@ -0,0 +1,159 @@
+#include "gui-profiler.h"
+
+#include <SFML/Graphics.h>
+
+#include "file.h"
+#include "gui.h"
+#include "profiler.h"
+#include "render-stats.h"
+
+#define GUI_PROFILER_LABEL_WIDTH 220.0f
+#define GUI_PROFILER_INDENT 8.0f
+
+static const sfColor s_arrDepthColors[] = {
+    { 230, 120, 60, 255 },
+    { 90, 180, 230, 255 },
+    { 140, 210, 90, 255 },
+    { 210, 110, 200, 255 }
+};
+
+_Check_return_
+static bool LoadFont(
+    _Inout_    GuiProfiler* pGuiProfiler,
+    _In_opt_z_ PCSTR pszFontPath
+) {
+    if (!pszFontPath) {
+        return false;
+    }
+
+    FileView* pView = File_Map(pszFontPath);
+    if (!pView) {
+        return false;
+    }
+
+    pGuiProfiler->pFont = sfFont_createFromMemory(FileView_GetData(pView), FileView_GetSize(pView));
+    if (!pGuiProfiler->pFont) {
+        printf("Failed to load profiler font %s\n", pszFontPath);
+        File_Unmap(pView);
+        return false;
+    }
+
+    pGuiProfiler->pFontView = pView;
+    return true;
+}
+
+_Check_return_ _Ret_maybenull_
+GuiElement* GuiProfiler_Create(
+    _In_       const FLOAT x,
+    _In_       const FLOAT y,
+    _In_       const FLOAT fWidth,
+    _In_opt_z_ PCSTR pszFontPath
+) {
+    GuiElement* pElement = GuiElement_Alloc(GUI_TYPE_PROFILER);
+    if (!pElement) {
+        return NULL;
+    }
+
+    GuiProfiler* pProfiler = &pElement->profiler;
+    pProfiler->x = x;
+    pProfiler->y = y;
+    pProfiler->fWidth = fWidth;
+    pProfiler->pShape = sfRectangleShape_create();
+    if (!pProfiler->pShape) {
+        printf("Failed to create profiler overlay shape\n");
+        GuiElement_Free(pElement);
+        return NULL;
+    }
+
+    // The system font keeps the labels when the game ships without its own
+    if (!LoadFont(pProfiler, pszFontPath) && !LoadFont(pProfiler, GUI_PROFILER_FALLBACK_FONT)) {
+        printf("Failed to load a profiler font, drawing bars only\n");
+    } else {
+        pProfiler->pText = sfText_create();
+        if (pProfiler->pText) {
+            sfText_setFont(pProfiler->pText, pProfiler->pFont);
+            sfText_setCharacterSize(pProfiler->pText, (unsigned int)(GUI_PROFILER_ROW_HEIGHT - 3.0f));
+            sfText_setFillColor(pProfiler->pText, sfWhite);
+        }
+    }
+
+    return pElement;
+}
+
+static void DrawRow(
+    _In_   const GuiProfiler* pGuiProfiler,
+    _In_   const INT iRow,
+    _In_   const INT iDepth,
+    _In_   const DOUBLE fMs,
+    _In_z_ PCSTR pszName
+) {
+    const FLOAT y = pGuiProfiler->y + (FLOAT)iRow * GUI_PROFILER_ROW_HEIGHT;
+    const FLOAT xBar = pGuiProfiler->x + GUI_PROFILER_LABEL_WIDTH + (FLOAT)iDepth * GUI_PROFILER_INDENT;
+
+    // Bars over budget are cut at twice the width so one spike cannot cover the screen
+    FLOAT fBarWidth = (FLOAT)(fMs / GUI_PROFILER_BUDGET_MS) * pGuiProfiler->fWidth;
+    if (fBarWidth > pGuiProfiler->fWidth * 2.0f) {
+        fBarWidth = pGuiProfiler->fWidth * 2.0f;
+    }
+
+    sfRectangleShape_setPosition(pGuiProfiler->pShape, (sfVector2f) { xBar, y + 2.0f });
+    sfRectangleShape_setSize(pGuiProfiler->pShape, (sfVector2f) { fBarWidth, GUI_PROFILER_ROW_HEIGHT - 4.0f });
+    sfRectangleShape_setFillColor(
+        pGuiProfiler->pShape,
+        s_arrDepthColors[iDepth % (INT)ArraySize(s_arrDepthColors)]
+    );
+    RenderStats_DrawRectangleShape(pGuiProfiler->pShape);
+
+    if (pGuiProfiler->pText) {
+        char szLabel[96];
+        snprintf(szLabel, sizeof(szLabel), "%*s%s %.2f ms", iDepth * 2, "", pszName, fMs);
+        sfText_setString(pGuiProfiler->pText, szLabel);
+        sfText_setPosition(pGuiProfiler->pText, (sfVector2f) { pGuiProfiler->x + 4.0f, y });
+        RenderStats_DrawText(pGuiProfiler->pText);
+    }
+}
+
+void GuiProfiler_Draw(
+    _In_ const GuiProfiler* pGuiProfiler
+) {
+    if (!Profiler_IsRunning()) {
+        return;
+    }
+
+    const ProfileScopeStats* arrStats;
+    const INT nStats = Profiler_GetScopeStats(&arrStats);
+
+    sfRectangleShape_setPosition(pGuiProfiler->pShape, (sfVector2f) { pGuiProfiler->x, pGuiProfiler->y });
+    sfRectangleShape_setSize(
+        pGuiProfiler->pShape,
+        (sfVector2f) {
+            GUI_PROFILER_LABEL_WIDTH + pGuiProfiler->fWidth * 2.0f,
+            (FLOAT)(nStats + 1) * GUI_PROFILER_ROW_HEIGHT
+        }
+    );
+    sfRectangleShape_setFillColor(pGuiProfiler->pShape, (sfColor) { 0, 0, 0, 160 });
+    RenderStats_DrawRectangleShape(pGuiProfiler->pShape);
+
+    DrawRow(pGuiProfiler, 0, 0, (DOUBLE)Profiler_GetFrameTimeNanoseconds() / 1000000.0, "Frame");
+    for (INT i = 0; i < nStats; i++) {
+        DrawRow(pGuiProfiler, i + 1, arrStats[i].iDepth, arrStats[i].fAverageMs, arrStats[i].pszName);
+    }
+}
+
+bool GuiProfiler_Destroy(
+    _Inout_ GuiProfiler* pGuiProfiler
+) {
+    if (!pGuiProfiler) {
+        return false;
+    }
+
+    if (pGuiProfiler->pText) {
+        sfText_destroy(pGuiProfiler->pText);
+    }
+    if (pGuiProfiler->pFont) {
+        sfFont_destroy(pGuiProfiler->pFont);
+    }
+    File_Unmap(pGuiProfiler->pFontView);
+    sfRectangleShape_destroy(pGuiProfiler->pShape);
+    return true;
+}
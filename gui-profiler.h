@@ -0,0 +1,73 @@
+#ifndef GUI_PROFILER_H
+#define GUI_PROFILER_H
+
+#include "utils.h"
+
+typedef struct _GuiElement GuiElement;
+typedef struct sfRectangleShape sfRectangleShape;
+typedef struct sfFont sfFont;
+typedef struct sfText sfText;
+typedef struct _FileView FileView;
+
+#define GUI_PROFILER_ROW_HEIGHT 14.0f
+#define GUI_PROFILER_BUDGET_MS 16.6667 // << Frame time that fills a bar, one frame at 60 fps
+#ifdef _WIN32
+#define GUI_PROFILER_FALLBACK_FONT "C:/Windows/Fonts/consola.ttf"
+#else
+#define GUI_PROFILER_FALLBACK_FONT "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf"
+#endif
+
+/*
+ * Overlay with one bar per profiler scope, sized by the scope's smoothed time per frame against
+ * GUI_PROFILER_BUDGET_MS. Nested scopes are indented. Names and times are written next to the bars; only the bars
+ * are drawn if neither the given font nor GUI_PROFILER_FALLBACK_FONT could be loaded.
+ */
+typedef struct _GuiProfiler {
+    FLOAT x;
+    FLOAT y;
+    FLOAT fWidth;              // << Width of a bar at the full frame budget
+    sfRectangleShape* pShape;  // << Reused for the background and every bar
+    FileView* pFontView;       // << Font data, SFML reads glyphs from it for as long as the font lives
+    sfFont* pFont;             // << NULL without labels
+    sfText* pText;
+} GuiProfiler;
+
+/**
+ * @brief Creates a profiler overlay element.
+ *
+ * @param x          Left edge in screen space.
+ * @param y          Top edge in screen space.
+ * @param fWidth     Width of a bar at the full frame budget.
+ * @param pszFontPath Font for the labels, resolved through mounted packs like any asset, or `NULL` to use
+ *                    GUI_PROFILER_FALLBACK_FONT.
+ * @return A pointer to the new `GuiElement`, or `NULL` if it could not be created.
+ */
+_Check_return_ _Ret_maybenull_ GuiElement* GuiProfiler_Create(
+    _In_     FLOAT x,
+    _In_     FLOAT y,
+    _In_     FLOAT fWidth,
+    _In_opt_z_ PCSTR pszFontPath
+    );
+
+/**
+ * @brief Draws the frame time and the last frame's scope statistics. Draws nothing while the profiler is stopped.
+ *
+ * Called by `Gui_Draw` for elements of type `GUI_TYPE_PROFILER`.
+ *
+ * @param pGuiProfiler Pointer to the `GuiProfiler` to draw.
+ */
+void GuiProfiler_Draw(
+    _In_ const GuiProfiler* pGuiProfiler
+    );
+
+/**
+ * @brief Frees the shape, font and text of the overlay. The element itself is freed by its owner.
+ *
+ * @param pGuiProfiler Pointer to the `GuiProfiler` to destroy.
+ * @return `true` if the overlay was destroyed, `false` if `pGuiProfiler` was `NULL`.
+ */
+bool GuiProfiler_Destroy(
+    _Inout_ GuiProfiler* pGuiProfiler
+    );
+
+#endif //GUI_PROFILER_H
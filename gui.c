@@ -3,6 +3,10 @@
 #include <SFML/Graphics.h>
 
 #include "sprite.h"
+#include "profiler.h"
+#include "pool.h"
+
+static Pool s_elementPool = POOL_INIT(GuiElement);
 
 _Check_return_ _Ret_maybenull_
 Gui* Gui_Create(
@@ -45,16 +49,43 @@ void Gui_AddElement(
 void Gui_Draw(
     _In_ const Gui* pGui
 ) {
+    PROFILE_BEGIN("Gui_Draw");
+
     for (INT i = 0; i < pGui->cElements; i++) {
         const GuiElement* pCurrentElement = pGui->arrElements[i];
         switch (pCurrentElement->type) {
             case GUI_TYPE_IMAGE:
                 GuiImage_Draw(&pCurrentElement->image);
                 break;
+            case GUI_TYPE_PROFILER:
+                GuiProfiler_Draw(&pCurrentElement->profiler);
+                break;
             default:
                 break;
         }
     }
+
+    PROFILE_END();
+}
+
+_Check_return_ _Ret_maybenull_
+GuiElement* GuiElement_Alloc(
+    _In_ const GuiType type
+) {
+    GuiElement* pElement = Pool_Alloc(&s_elementPool);
+    if (!pElement) {
+        printf("Failed to allocate memory for GUI element\n");
+        return NULL;
+    }
+
+    pElement->type = type;
+    return pElement;
+}
+
+void GuiElement_Free(
+    _Inout_ _Pre_valid_ _Post_invalid_ GuiElement* pGuiElement
+) {
+    Pool_Free(&s_elementPool, pGuiElement);
 }
 
 _Check_return_opt_
@@ -69,11 +100,14 @@ bool GuiElement_Destroy(
         case GUI_TYPE_IMAGE:
             GuiImage_Destroy(&pGuiElement->image);
             break;
+        case GUI_TYPE_PROFILER:
+            GuiProfiler_Destroy(&pGuiElement->profiler);
+            break;
         default:
             break;
     }
 
-    SafeFree(pGuiElement);
+    GuiElement_Free(pGuiElement);
 
     return true;
 }
@@ -95,3 +129,9 @@ bool Gui_Destroy(
 
     return true;
 }
+
+void Gui_Shutdown(
+    void
+) {
+    Pool_Release(&s_elementPool);
+}
@@ -3,17 +3,20 @@
 
 #include "utils.h"
 #include "gui-image.h"
+#include "gui-profiler.h"
 
 typedef enum _GuiType {
     GUI_TYPE_IMAGE,
     GUI_TYPE_TEXT,
-    GUI_TYPE_BUTTON
+    GUI_TYPE_BUTTON,
+    GUI_TYPE_PROFILER
 } GuiType;
 
 typedef struct _GuiElement {
     GuiType type;
     union {
         GuiImage image;
+        GuiProfiler profiler;
     };
 } GuiElement;
 
@@ -53,6 +56,23 @@ void Gui_Draw(
     _In_ const Gui* pGui
     );
 
+/**
+ * @brief Allocates an element from the GUI element pool. Used by the `Gui*_Create` functions.
+ *
+ * @param type Type of the element.
+ * @return A zeroed element of the given type, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ GuiElement* GuiElement_Alloc(
+    _In_ GuiType type
+    );
+
+/**
+ * @brief Returns an element to the pool without destroying its contents, for `Gui*_Create` failure paths.
+ */
+void GuiElement_Free(
+    _Inout_ _Pre_valid_ _Post_invalid_ GuiElement* pGuiElement
+    );
+
 _Check_return_opt_ bool GuiElement_Destroy(
     _Inout_ _Pre_valid_ _Post_invalid_ GuiElement* pGuiElement
     );
@@ -69,4 +89,13 @@ _Check_return_opt_ bool Gui_Destroy(
     _Inout_ _Pre_valid_ _Post_invalid_ Gui* pGui
     );
 
+/**
+ * @brief Frees the memory pool that GUI elements are allocated from.
+ *
+ * Call once at shutdown, after every one of them is destroyed.
+ */
+void Gui_Shutdown(
+    void
+    );
+
 #endif //GUI_H
@@ -0,0 +1,325 @@
+#include "job-system.h"
+
+#include <SFML/System.h>
+
+#ifdef _WIN32
+#include "win32.h"
+#else
+#include <unistd.h>
+#endif
+
+#include "profiler.h"
+
+#define JOB_IDLE_SPINS 64          // << Empty polls before an idle worker starts sleeping
+#define JOB_IDLE_SLEEP_US 200
+
+_Check_return_
+static INT GetProcessorCount(
+    void
+) {
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return (INT)systemInfo.dwNumberOfProcessors;
+#else
+    const long nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    return nProcessors > 0 ? (INT)nProcessors : 1;
+#endif
+}
+
+_Check_return_
+static bool PushBack(
+    _Inout_ JobDeque* pDeque,
+    _In_    const Job* pJob
+) {
+    sfMutex_lock(pDeque->pMutex);
+
+    if (pDeque->nCount == pDeque->nCapacity) {
+        const INT nCapacity = pDeque->nCapacity * 2;
+        Job* arrJobs = malloc(nCapacity * sizeof(Job));
+        if (!arrJobs) {
+            sfMutex_unlock(pDeque->pMutex);
+            printf("Failed to grow job deque\n");
+            return false;
+        }
+        for (INT i = 0; i < pDeque->nCount; i++) {
+            arrJobs[i] = pDeque->arrJobs[(pDeque->iFront + i) % pDeque->nCapacity];
+        }
+        SafeFree(pDeque->arrJobs);
+        pDeque->arrJobs = arrJobs;
+        pDeque->nCapacity = nCapacity;
+        pDeque->iFront = 0;
+    }
+
+    pDeque->arrJobs[(pDeque->iFront + pDeque->nCount) % pDeque->nCapacity] = *pJob;
+    pDeque->nCount++;
+
+    sfMutex_unlock(pDeque->pMutex);
+    return true;
+}
+
+_Check_return_
+static bool PopBack(
+    _Inout_ JobDeque* pDeque,
+    _Out_   Job* pJob
+) {
+    sfMutex_lock(pDeque->pMutex);
+    const bool bFound = pDeque->nCount > 0;
+    if (bFound) {
+        pDeque->nCount--;
+        *pJob = pDeque->arrJobs[(pDeque->iFront + pDeque->nCount) % pDeque->nCapacity];
+    }
+    sfMutex_unlock(pDeque->pMutex);
+    return bFound;
+}
+
+_Check_return_
+static bool PopFront(
+    _Inout_ JobDeque* pDeque,
+    _Out_   Job* pJob
+) {
+    sfMutex_lock(pDeque->pMutex);
+    const bool bFound = pDeque->nCount > 0;
+    if (bFound) {
+        *pJob = pDeque->arrJobs[pDeque->iFront];
+        pDeque->iFront = (pDeque->iFront + 1) % pDeque->nCapacity;
+        pDeque->nCount--;
+    }
+    sfMutex_unlock(pDeque->pMutex);
+    return bFound;
+}
+
+_Check_return_
+static bool FindJob(
+    _Inout_ JobSystem* pSystem,
+    _In_    const INT iThread,
+    _Out_   Job* pJob
+) {
+    if (PopBack(&pSystem->arrDeques[iThread], pJob)) {
+        return true;
+    }
+
+    // Victims are tried in a fixed order starting after the thief, so threads spread over different deques
+    for (INT i = 1; i < pSystem->nThreads; i++) {
+        if (PopFront(&pSystem->arrDeques[(iThread + i) % pSystem->nThreads], pJob)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void RunJob(
+    _Inout_ JobSystem* pSystem,
+    _In_    const Job* pJob,
+    _In_    const INT iThread
+) {
+    pJob->pfnRun(pJob->pData, pJob->iBegin, pJob->iEnd, iThread);
+
+    if (pJob->pCounter) {
+        sfMutex_lock(pSystem->pMutex);
+        pJob->pCounter->nRemaining--;
+        sfMutex_unlock(pSystem->pMutex);
+    }
+}
+
+static void WorkerThread(
+    _Inout_ void* pUserData
+) {
+    JobWorker* pWorker = pUserData;
+    JobSystem* pSystem = pWorker->pSystem;
+    INT nIdle = 0;
+
+    for (;;) {
+        Job job;
+        if (FindJob(pSystem, pWorker->iThread, &job)) {
+            RunJob(pSystem, &job, pWorker->iThread);
+            nIdle = 0;
+            continue;
+        }
+
+        sfMutex_lock(pSystem->pMutex);
+        const bool bRunning = pSystem->bRunning;
+        sfMutex_unlock(pSystem->pMutex);
+        if (!bRunning) {
+            break;
+        }
+
+        sfSleep(sfMicroseconds(++nIdle < JOB_IDLE_SPINS ? 0 : JOB_IDLE_SLEEP_US));
+    }
+
+    // Jobs may have opened profiler scopes on this thread
+    PROFILE_THREAD_EXIT();
+}
+
+_Check_return_ _Ret_maybenull_
+JobSystem* JobSystem_Create(
+    _In_ INT nThreads
+) {
+    if (nThreads <= 0) {
+        nThreads = GetProcessorCount();
+    }
+    if (nThreads > JOB_SYSTEM_MAX_THREADS) {
+        nThreads = JOB_SYSTEM_MAX_THREADS;
+    }
+
+    JobSystem* pSystem = calloc(1, sizeof(JobSystem));
+    if (!pSystem) {
+        printf("Failed to allocate memory for JobSystem\n");
+        return NULL;
+    }
+
+    pSystem->pMutex = sfMutex_create();
+    if (!pSystem->pMutex) {
+        printf("Failed to create job system mutex\n");
+        SafeFree(pSystem);
+        return NULL;
+    }
+
+    pSystem->nThreads = nThreads;
+    pSystem->bRunning = true;
+
+    for (INT i = 0; i < nThreads; i++) {
+        JobDeque* pDeque = &pSystem->arrDeques[i];
+        pDeque->pMutex = sfMutex_create();
+        pDeque->arrJobs = malloc(JOB_DEQUE_INITIAL_CAPACITY * sizeof(Job));
+        pDeque->nCapacity = JOB_DEQUE_INITIAL_CAPACITY;
+        if (!pDeque->pMutex || !pDeque->arrJobs) {
+            printf("Failed to create job deque %d\n", i);
+            JobSystem_Destroy(pSystem);
+            return NULL;
+        }
+    }
+
+    // Thread 0 is the caller; a worker that fails to start just leaves its deque to be drained by stealing
+    for (INT i = 1; i < nThreads; i++) {
+        JobWorker* pWorker = &pSystem->arrWorkers[i];
+        pWorker->pSystem = pSystem;
+        pWorker->iThread = i;
+        pWorker->pThread = sfThread_create(WorkerThread, pWorker);
+        if (pWorker->pThread) {
+            sfThread_launch(pWorker->pThread);
+        }
+    }
+
+    return pSystem;
+}
+
+_Check_return_
+INT JobSystem_GetThreadCount(
+    _In_ const JobSystem* pSystem
+) {
+    return pSystem->nThreads;
+}
+
+_Check_return_opt_
+bool JobSystem_Submit(
+    _Inout_ JobSystem* pSystem,
+    _In_    const INT iThread,
+    _In_    const Job job
+) {
+    if (job.pCounter) {
+        sfMutex_lock(pSystem->pMutex);
+        job.pCounter->nRemaining++;
+        sfMutex_unlock(pSystem->pMutex);
+    }
+
+    if (!PushBack(&pSystem->arrDeques[iThread], &job)) {
+        RunJob(pSystem, &job, iThread); // << Rather than lose it
+        return false;
+    }
+    return true;
+}
+
+void JobSystem_Wait(
+    _Inout_ JobSystem* pSystem,
+    _In_    const INT iThread,
+    _Inout_ JobCounter* pCounter
+) {
+    for (;;) {
+        sfMutex_lock(pSystem->pMutex);
+        const INT nRemaining = pCounter->nRemaining;
+        sfMutex_unlock(pSystem->pMutex);
+        if (nRemaining == 0) {
+            return;
+        }
+
+        Job job;
+        if (FindJob(pSystem, iThread, &job)) {
+            RunJob(pSystem, &job, iThread);
+        } else {
+            sfSleep(sfMicroseconds(0)); // << The last jobs are running on other threads
+        }
+    }
+}
+
+void JobSystem_ParallelFor(
+    _Inout_  JobSystem* pSystem,
+    _In_     const INT nCount,
+    _In_     INT nBatch,
+    _In_     const JobFunction pfnRun,
+    _In_opt_ void* pData
+) {
+    if (nCount <= 0) {
+        return;
+    }
+    if (nBatch <= 0) {
+        nBatch = nCount / (pSystem->nThreads * 4);
+        if (nBatch < 1) {
+            nBatch = 1;
+        }
+    }
+
+    JobCounter counter = { 0 };
+    for (INT iBegin = 0; iBegin < nCount; iBegin += nBatch) {
+        const Job job = {
+            pfnRun,
+            pData,
+            iBegin,
+            iBegin + nBatch < nCount ? iBegin + nBatch : nCount,
+            &counter
+        };
+
+        sfMutex_lock(pSystem->pMutex);
+        counter.nRemaining++;
+        sfMutex_unlock(pSystem->pMutex);
+
+        JobDeque* pDeque = &pSystem->arrDeques[pSystem->iNextDeque];
+        pSystem->iNextDeque = (pSystem->iNextDeque + 1) % pSystem->nThreads;
+        if (!PushBack(pDeque, &job)) {
+            RunJob(pSystem, &job, 0);
+        }
+    }
+
+    JobSystem_Wait(pSystem, 0, &counter);
+}
+
+_Check_return_opt_
+bool JobSystem_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ JobSystem* pSystem
+) {
+    if (!pSystem) {
+        return false;
+    }
+
+    sfMutex_lock(pSystem->pMutex);
+    pSystem->bRunning = false;
+    sfMutex_unlock(pSystem->pMutex);
+
+    for (INT i = 1; i < pSystem->nThreads; i++) {
+        if (pSystem->arrWorkers[i].pThread) {
+            sfThread_wait(pSystem->arrWorkers[i].pThread);
+            sfThread_destroy(pSystem->arrWorkers[i].pThread);
+        }
+    }
+
+    for (INT i = 0; i < pSystem->nThreads; i++) {
+        if (pSystem->arrDeques[i].pMutex) {
+            sfMutex_destroy(pSystem->arrDeques[i].pMutex);
+        }
+        SafeFree(pSystem->arrDeques[i].arrJobs);
+    }
+
+    sfMutex_destroy(pSystem->pMutex);
+    SafeFree(pSystem);
+    return true;
+}
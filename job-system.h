@@ -0,0 +1,150 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "utils.h"
+
+typedef struct sfThread sfThread;
+typedef struct sfMutex sfMutex;
+
+#define JOB_SYSTEM_MAX_THREADS 32
+#define JOB_DEQUE_INITIAL_CAPACITY 64
+
+/**
+ * @brief Work function of a job.
+ *
+ * @param pData   User data given when the job was queued.
+ * @param iBegin  First index of the range this job covers.
+ * @param iEnd    One past the last index of the range.
+ * @param iThread Index of the thread running the job, from `0` (the thread that created the system) to
+ *                `JobSystem_GetThreadCount() - 1`. Use it to pick per-thread scratch memory.
+ */
+typedef void (*JobFunction)(void* pData, INT iBegin, INT iEnd, INT iThread);
+
+typedef struct _JobCounter {
+    INT nRemaining;            // << Jobs queued with this counter that have not finished; guarded by the system
+} JobCounter;
+
+typedef struct _Job {
+    JobFunction pfnRun;
+    void* pData;
+    INT iBegin;
+    INT iEnd;
+    JobCounter* pCounter;
+} Job;
+
+/*
+ * Double-ended queue of one thread. The owner pushes and pops at the back, so it keeps working on the most
+ * recent, cache-warm jobs; other threads steal from the front, taking the oldest and usually largest work.
+ */
+typedef struct _JobDeque {
+    sfMutex* pMutex;
+    Job* arrJobs;              // << Ring buffer
+    INT nCapacity;
+    INT iFront;
+    INT nCount;
+} JobDeque;
+
+typedef struct _JobSystem JobSystem;
+
+typedef struct _JobWorker {
+    JobSystem* pSystem;
+    INT iThread;
+    sfThread* pThread;
+} JobWorker;
+
+/*
+ * Fixed pool of worker threads with one deque per thread and work stealing.
+ *
+ * The thread that creates the system takes part as thread 0: it queues work into its own deque and runs jobs
+ * while it waits for them, so a system with no workers still runs everything, just serially. Idle workers back
+ * off to short sleeps, since CSFML offers no condition variable to park them on.
+ */
+struct _JobSystem {
+    INT nThreads;              // << Workers plus the owning thread
+    JobDeque arrDeques[JOB_SYSTEM_MAX_THREADS];
+    JobWorker arrWorkers[JOB_SYSTEM_MAX_THREADS];
+    sfMutex* pMutex;           // << Guards bRunning and every JobCounter
+    bool bRunning;
+    INT iNextDeque;            // << Round-robin target for JobSystem_ParallelFor
+};
+
+/**
+ * @brief Starts a job system.
+ *
+ * @param nThreads Total number of threads including the calling one, or `0` for one per processor. Clamped to
+ *                 `JOB_SYSTEM_MAX_THREADS`.
+ * @return A pointer to the new `JobSystem`, or `NULL` if it could not be created.
+ */
+_Check_return_ _Ret_maybenull_ JobSystem* JobSystem_Create(
+    _In_ INT nThreads
+    );
+
+/**
+ * @brief Gets the number of threads that run jobs, including the owning thread.
+ */
+_Check_return_ INT JobSystem_GetThreadCount(
+    _In_ const JobSystem* pSystem
+    );
+
+/**
+ * @brief Queues one job on a thread's deque.
+ *
+ * @param pSystem  Pointer to the `JobSystem`.
+ * @param iThread  Thread queuing the job; jobs queue on the caller's own deque so they can be stolen.
+ * @param job      The job. `pCounter` is incremented now and decremented when the job has run.
+ * @return `true` if the job was queued, `false` if the deque could not grow and the job ran right away.
+ */
+_Check_return_opt_ bool JobSystem_Submit(
+    _Inout_ JobSystem* pSystem,
+    _In_    INT iThread,
+    _In_    Job job
+    );
+
+/**
+ * @brief Runs jobs until a counter reaches zero.
+ *
+ * The waiting thread pops its own jobs and steals others' instead of blocking, so waiting inside a job is safe.
+ *
+ * @param pSystem  Pointer to the `JobSystem`.
+ * @param iThread  Thread that waits.
+ * @param pCounter Counter of the jobs to wait for.
+ */
+void JobSystem_Wait(
+    _Inout_ JobSystem* pSystem,
+    _In_    INT iThread,
+    _Inout_ JobCounter* pCounter
+    );
+
+/**
+ * @brief Runs `pfnRun` over `[0, nCount)` in batches spread over all threads, and waits for it.
+ *
+ * Batches are dealt to every deque up front, so workers start on their own share and only steal once they run
+ * out. Must be called from the owning thread.
+ *
+ * @param pSystem  Pointer to the `JobSystem`.
+ * @param nCount   Number of items.
+ * @param nBatch   Items per job; `0` picks a size that gives every thread several jobs.
+ * @param pfnRun   Function run for each batch.
+ * @param pData    User data passed to `pfnRun`.
+ */
+void JobSystem_ParallelFor(
+    _Inout_  JobSystem* pSystem,
+    _In_     INT nCount,
+    _In_     INT nBatch,
+    _In_     JobFunction pfnRun,
+    _In_opt_ void* pData
+    );
+
+/**
+ * @brief Stops the workers and destroys the job system.
+ *
+ * Workers drain the jobs that are still queued before they exit.
+ *
+ * @param pSystem Pointer to the `JobSystem` to destroy.
+ * @return `true` if the system was destroyed, `false` if `pSystem` was `NULL`.
+ */
+_Check_return_opt_ bool JobSystem_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ JobSystem* pSystem
+    );
+
+#endif //JOB_SYSTEM_H
@@ -0,0 +1,236 @@
+#include "lz4.h"
+
+#include <string.h>
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5  // << The last 5 bytes of a block are always literals
+#define LZ4_MF_LIMIT 12      // << No match may start in the last 12 bytes
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_LOG 12
+
+_Check_return_
+static inline UINT Read32(
+    _In_reads_bytes_(4) const BYTE* p
+) {
+    UINT uValue;
+    memcpy(&uValue, p, sizeof(uValue));
+    return uValue;
+}
+
+_Check_return_
+static inline UINT Hash32(
+    _In_ const UINT uValue
+) {
+    return (uValue * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+_Check_return_
+static BYTE* WriteLength(
+    _Inout_ BYTE* pOutput,
+    _In_    const BYTE* pOutputEnd,
+    _In_    ULONG cbLength
+) {
+    while (cbLength >= 255) {
+        if (pOutput >= pOutputEnd) {
+            return NULL;
+        }
+        *pOutput++ = 255;
+        cbLength -= 255;
+    }
+    if (pOutput >= pOutputEnd) {
+        return NULL;
+    }
+    *pOutput++ = (BYTE)cbLength;
+    return pOutput;
+}
+
+_Check_return_
+static BYTE* WriteSequence(
+    _Inout_ BYTE* pOutput,
+    _In_    const BYTE* pOutputEnd,
+    _In_    const BYTE* pLiterals,
+    _In_    const ULONG cbLiterals,
+    _In_    const UINT uOffset,
+    _In_    const ULONG cbMatch
+) {
+    if (pOutput >= pOutputEnd) {
+        return NULL;
+    }
+
+    BYTE* pToken = pOutput++;
+    *pToken = (BYTE)((cbLiterals >= 15 ? 15 : cbLiterals) << 4);
+    if (cbLiterals >= 15) {
+        pOutput = WriteLength(pOutput, pOutputEnd, cbLiterals - 15);
+        if (!pOutput) {
+            return NULL;
+        }
+    }
+
+    if ((ULONG)(pOutputEnd - pOutput) < cbLiterals) {
+        return NULL;
+    }
+    memcpy(pOutput, pLiterals, cbLiterals);
+    pOutput += cbLiterals;
+
+    // The final sequence carries literals only
+    if (cbMatch == 0) {
+        return pOutput;
+    }
+
+    if (pOutputEnd - pOutput < 2) {
+        return NULL;
+    }
+    *pOutput++ = (BYTE)(uOffset & 0xFF);
+    *pOutput++ = (BYTE)(uOffset >> 8);
+
+    const ULONG cbMatchCode = cbMatch - LZ4_MIN_MATCH;
+    *pToken |= (BYTE)(cbMatchCode >= 15 ? 15 : cbMatchCode);
+    if (cbMatchCode >= 15) {
+        pOutput = WriteLength(pOutput, pOutputEnd, cbMatchCode - 15);
+    }
+
+    return pOutput;
+}
+
+_Check_return_
+ULONG Lz4_CompressBlock(
+    _In_reads_bytes_(cbInput)    const BYTE* pInput,
+    _In_                         const ULONG cbInput,
+    _Out_writes_bytes_(cbOutput) BYTE* pOutput,
+    _In_                         const ULONG cbOutput
+) {
+    UINT arrHashTable[1 << LZ4_HASH_LOG] = { 0 };
+
+    const BYTE* pInputEnd = pInput + cbInput;
+    const BYTE* pOutputEnd = pOutput + cbOutput;
+    const BYTE* pAnchor = pInput;
+    BYTE* pOut = pOutput;
+
+    if (cbInput > LZ4_MF_LIMIT) {
+        const BYTE* pMatchStartLimit = pInputEnd - LZ4_MF_LIMIT;
+        const BYTE* pMatchEndLimit = pInputEnd - LZ4_LAST_LITERALS;
+        const BYTE* pCursor = pInput;
+
+        while (pCursor < pMatchStartLimit) {
+            const UINT uSequence = Read32(pCursor);
+            const UINT uHash = Hash32(uSequence);
+            const BYTE* pReference = pInput + arrHashTable[uHash];
+            arrHashTable[uHash] = (UINT)(pCursor - pInput);
+
+            if (pReference >= pCursor ||
+                pCursor - pReference > LZ4_MAX_OFFSET ||
+                Read32(pReference) != uSequence) {
+                pCursor++;
+                continue;
+            }
+
+            const BYTE* pMatchEnd = pCursor + LZ4_MIN_MATCH;
+            const BYTE* pReferenceEnd = pReference + LZ4_MIN_MATCH;
+            while (pMatchEnd < pMatchEndLimit && *pMatchEnd == *pReferenceEnd) {
+                pMatchEnd++;
+                pReferenceEnd++;
+            }
+
+            pOut = WriteSequence(
+                pOut,
+                pOutputEnd,
+                pAnchor,
+                (ULONG)(pCursor - pAnchor),
+                (UINT)(pCursor - pReference),
+                (ULONG)(pMatchEnd - pCursor)
+            );
+            if (!pOut) {
+                return 0;
+            }
+
+            pCursor = pMatchEnd;
+            pAnchor = pCursor;
+        }
+    }
+
+    pOut = WriteSequence(pOut, pOutputEnd, pAnchor, (ULONG)(pInputEnd - pAnchor), 0, 0);
+    if (!pOut) {
+        return 0;
+    }
+
+    return (ULONG)(pOut - pOutput);
+}
+
+_Check_return_
+LONG Lz4_DecompressBlock(
+    _In_reads_bytes_(cbInput)    const BYTE* pInput,
+    _In_                         const ULONG cbInput,
+    _Out_writes_bytes_(cbOutput) BYTE* pOutput,
+    _In_                         const ULONG cbOutput
+) {
+    const BYTE* pIn = pInput;
+    const BYTE* pInputEnd = pInput + cbInput;
+    BYTE* pOut = pOutput;
+    const BYTE* pOutputEnd = pOutput + cbOutput;
+
+    while (pIn < pInputEnd) {
+        const BYTE byToken = *pIn++;
+
+        ULONG cbLiterals = byToken >> 4;
+        if (cbLiterals == 15) {
+            BYTE byLength;
+            do {
+                if (pIn >= pInputEnd) {
+                    return -1;
+                }
+                byLength = *pIn++;
+                cbLiterals += byLength;
+            } while (byLength == 255);
+        }
+
+        if ((ULONG)(pInputEnd - pIn) < cbLiterals || (ULONG)(pOutputEnd - pOut) < cbLiterals) {
+            return -1;
+        }
+        memcpy(pOut, pIn, cbLiterals);
+        pOut += cbLiterals;
+        pIn += cbLiterals;
+
+        if (pIn >= pInputEnd) {
+            break;
+        }
+
+        if (pInputEnd - pIn < 2) {
+            return -1;
+        }
+        const UINT uOffset = pIn[0] | (pIn[1] << 8);
+        pIn += 2;
+        if (uOffset == 0 || uOffset > (UINT)(pOut - pOutput)) {
+            return -1;
+        }
+
+        ULONG cbMatch = byToken & 15;
+        if (cbMatch == 15) {
+            BYTE byLength;
+            do {
+                if (pIn >= pInputEnd) {
+                    return -1;
+                }
+                byLength = *pIn++;
+                cbMatch += byLength;
+            } while (byLength == 255);
+        }
+        cbMatch += LZ4_MIN_MATCH;
+
+        if ((ULONG)(pOutputEnd - pOut) < cbMatch) {
+            return -1;
+        }
+
+        // Matches may overlap their own output, e.g. an offset of 1 repeats a single byte
+        const BYTE* pMatch = pOut - uOffset;
+        if (uOffset >= cbMatch) {
+            memcpy(pOut, pMatch, cbMatch);
+        } else {
+            for (ULONG i = 0; i < cbMatch; i++) {
+                pOut[i] = pMatch[i];
+            }
+        }
+        pOut += cbMatch;
+    }
+
+    return (LONG)(pOut - pOutput);
+}
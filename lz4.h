@@ -0,0 +1,57 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include "utils.h"
+
+/*
+ * Minimal codec for the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ *
+ * Only raw blocks are supported, not the LZ4 frame format. Blocks written here can be decoded by the
+ * reference `LZ4_decompress_safe` and vice versa.
+ */
+
+/**
+ * @brief Returns the worst-case compressed size for `cbInput` bytes of input.
+ */
+_Check_return_
+static inline ULONG Lz4_CompressBound(
+    _In_ const ULONG cbInput
+) {
+    return cbInput + cbInput / 255 + 16;
+}
+
+/**
+ * @brief Compresses one block.
+ *
+ * @param pInput    Pointer to the data to compress.
+ * @param cbInput   Size of the input in bytes.
+ * @param pOutput   Destination buffer.
+ * @param cbOutput  Size of the destination buffer. `Lz4_CompressBound(cbInput)` always suffices.
+ * @return The compressed size in bytes, or `0` if the output buffer was too small.
+ */
+_Check_return_ ULONG Lz4_CompressBlock(
+    _In_reads_bytes_(cbInput)    const BYTE* pInput,
+    _In_                         ULONG cbInput,
+    _Out_writes_bytes_(cbOutput) BYTE* pOutput,
+    _In_                         ULONG cbOutput
+    );
+
+/**
+ * @brief Decompresses one block.
+ *
+ * All reads and writes are bounds checked, so corrupt input fails instead of overrunning a buffer.
+ *
+ * @param pInput    Pointer to the compressed block.
+ * @param cbInput   Size of the compressed block in bytes.
+ * @param pOutput   Destination buffer.
+ * @param cbOutput  Size of the destination buffer.
+ * @return The decompressed size in bytes, or `-1` if the block is malformed or does not fit.
+ */
+_Check_return_ LONG Lz4_DecompressBlock(
+    _In_reads_bytes_(cbInput)    const BYTE* pInput,
+    _In_                         ULONG cbInput,
+    _Out_writes_bytes_(cbOutput) BYTE* pOutput,
+    _In_                         ULONG cbOutput
+    );
+
+#endif //LZ4_H
@@ -4,12 +4,99 @@
 #include "gui.h"
 #include "keycodes.h"
 #include "sprite.h"
+#include "animated-sprite.h"
+#include "unit.h"
 #include "texture.h"
+#include "pack.h"
+#include "asset-watcher.h"
+#include "game-loop.h"
+#include "profiler.h"
+#include "camera-controller.h"
+#include "arena.h"
+
+#define CAMERA_PAN_SPEED 200.0f // << Pixels per second
+
+typedef struct _Game {
+    Camera* pCamera;
+    CameraController* pCameraController;
+    VECTOR2 vCameraPos;        // << Camera target after the latest tick
+    VECTOR2 vCameraPrevPos;    // << Camera target after the tick before
+    Sprite* pAhri;
+    Gui* pGui;
+    bool bTraceKeyDown;        // << Debounces the trace export key
+} Game;
+
+static void Game_Tick(
+    _Inout_ void* pUserData,
+    _In_    const FLOAT fTickSeconds
+) {
+    Game* pGame = pUserData;
+    pGame->vCameraPrevPos = pGame->vCameraPos;
+
+    const FLOAT fPan = CAMERA_PAN_SPEED * fTickSeconds;
+    if (IsKeyDown(KEYCODE_W)) {
+        pGame->vCameraPos.y -= fPan;
+    }
+
+    if (IsKeyDown(KEYCODE_S)) {
+        pGame->vCameraPos.y += fPan;
+    }
+
+    if (IsKeyDown(KEYCODE_A)) {
+        pGame->vCameraPos.x -= fPan;
+    }
+
+    if (IsKeyDown(KEYCODE_D)) {
+        pGame->vCameraPos.x += fPan;
+    }
+
+    const bool bTraceKeyDown = IsKeyDown(KEYCODE_P);
+    if (bTraceKeyDown && !pGame->bTraceKeyDown && Profiler_IsRunning()) {
+        if (Profiler_ExportChromeTrace("trace.json")) {
+            printf("Wrote trace.json\n");
+        }
+    }
+    pGame->bTraceKeyDown = bTraceKeyDown;
+}
+
+static void Game_Render(
+    _Inout_ void* pUserData,
+    _In_    const FLOAT fAlpha
+) {
+    Game* pGame = pUserData;
+
+    AssetWatcher_ApplyPending();
+
+    // The controller eases the camera after the target, using the real frame time rather than whole ticks
+    CameraController_Follow(
+        pGame->pCameraController,
+        Vector2Lerp(pGame->vCameraPrevPos, pGame->vCameraPos, fAlpha),
+        0.0f
+    );
+    CameraController_Update(pGame->pCameraController, GetFrameTimeSeconds());
+    Camera_Use(pGame->pCamera);
+
+    Sprite_Draw(pGame->pAhri);
+
+    Camera_Use(NULL);
+    Gui_Draw(pGame->pGui);
+}
 
 int main(void) {
     Window* window = Window_Create(500, 200, 1600, 900, "SFML window");
     assert(window);
 
+    // Optional; without it every asset is loaded from loose files
+    Pack_Mount("assets.pak");
+
+#ifndef NDEBUG
+    // Must run before anything is loaded, only files loaded afterwards are watched
+    AssetWatcher_Start();
+#endif
+
+    // Runs in release builds too, so frame-time breakdowns can be read on shipped builds
+    Profiler_Start();
+
     Camera* camera = Camera_Create(0, 0, 1600, 900, 0);
     assert(camera);
     Camera_Use(camera);
@@ -36,40 +123,43 @@ int main(void) {
     assert(hudFg);
     Gui_AddElement(gui, hudFg);
 
-    while (Window_IsOpen(window)) {
-        if (IsKeyDown(KEYCODE_W)) {
-            Camera_MovePosition(camera, 0.0f, -0.2f * (FLOAT)GetFrameTime());
-        }
-
-        if (IsKeyDown(KEYCODE_S)) {
-            Camera_MovePosition(camera, 0.0f, 0.2f * (FLOAT)GetFrameTime());
-        }
-
-        if (IsKeyDown(KEYCODE_A)) {
-            Camera_MovePosition(camera, -0.2f * (FLOAT)GetFrameTime(), 0.0f);
-        }
-
-        if (IsKeyDown(KEYCODE_D)) {
-            Camera_MovePosition(camera, 0.2f * (FLOAT)GetFrameTime(), 0.0f);
-        }
-
-        Window_Clear(0, 0, 0);
+    if (Profiler_IsRunning()) {
+        GuiElement* profilerOverlay = GuiProfiler_Create(10, 10, 200, "fonts/profiler.ttf");
+        assert(profilerOverlay);
+        Gui_AddElement(gui, profilerOverlay);
+    }
 
-        Sprite_Draw(ahri);
+    GameLoop* loop = GameLoop_Create(GAME_LOOP_DEFAULT_TICK_RATE);
+    assert(loop);
 
-        Camera_Use(NULL);
-        Gui_Draw(gui);
+    CameraController* cameraController = CameraController_Create(camera);
+    assert(cameraController);
 
-        Camera_Use(camera);
+    Game game = { 0 };
+    game.pCamera = camera;
+    game.pCameraController = cameraController;
+    game.vCameraPos = CreateVector2(camera->x, camera->y);
+    game.vCameraPrevPos = game.vCameraPos;
+    game.pAhri = ahri;
+    game.pGui = gui;
 
-        Window_Display();
-    }
+    GameLoop_Run(loop, window, Game_Tick, Game_Render, &game);
 
+    GameLoop_Destroy(loop);
+    CameraController_Destroy(cameraController);
     Sprite_Destroy(ahri);
     TextureManager_Destroy(textureManager);
     Camera_Destroy(camera);
     Gui_Destroy(gui);
     Window_Destroy(window);
+    AssetWatcher_Stop();
+    Profiler_Stop();
+    Pack_UnmountAll();
+    Unit_Shutdown();
+    AnimatedSprite_Shutdown();
+    Sprite_Shutdown();
+    Gui_Shutdown();
+    Arena_Shutdown();
 
     return 0;
 }
@@ -0,0 +1,225 @@
+#include "move-range.h"
+
+#include <string.h>
+
+#include "terrain.h"
+
+_Check_return_ _Ret_maybenull_
+MoveRange* MoveRange_Create(
+    _In_ const INT nWidth,
+    _In_ const INT nHeight
+) {
+    if (nWidth <= 0 || nHeight <= 0) {
+        return NULL;
+    }
+
+    MoveRange* pRange = calloc(1, sizeof(MoveRange));
+    if (!pRange) {
+        printf("Failed to allocate memory for MoveRange\n");
+        return NULL;
+    }
+
+    const size_t nTiles = (size_t)nWidth * nHeight;
+    pRange->nWidth = nWidth;
+    pRange->nHeight = nHeight;
+
+    // Every settled tile pushes at most four neighbours, plus the start tile
+    pRange->nEntriesCapacity = (INT)(nTiles * 4 + 1);
+
+    pRange->arrGenerations = calloc(nTiles, sizeof(UINT));
+    pRange->arrCosts = malloc(nTiles * sizeof(UINT16));
+    pRange->arrParents = malloc(nTiles * sizeof(INT));
+    pRange->arrReached = malloc(nTiles * sizeof(INT));
+    pRange->arrEntries = malloc(pRange->nEntriesCapacity * sizeof(MoveRangeEntry));
+    if (!pRange->arrGenerations || !pRange->arrCosts || !pRange->arrParents || !pRange->arrReached ||
+        !pRange->arrEntries) {
+        printf("Failed to allocate memory for movement range arrays\n");
+        MoveRange_Destroy(pRange);
+        return NULL;
+    }
+
+    return pRange;
+}
+
+_Check_return_opt_
+INT MoveRange_Compute(
+    _Inout_ MoveRange* pRange,
+    _In_    const TerrainMap* pTerrain,
+    _In_    const POINT ptStart,
+    _In_    INT nMovePoints
+) {
+    pRange->nReached = 0;
+
+    if (pTerrain->nWidth != pRange->nWidth || pTerrain->nHeight != pRange->nHeight) {
+        printf("MoveRange is %dx%d but the terrain is %dx%d\n",
+            pRange->nWidth, pRange->nHeight, pTerrain->nWidth, pTerrain->nHeight);
+        return 0;
+    }
+    if (ptStart.x < 0 || ptStart.y < 0 || ptStart.x >= pRange->nWidth || ptStart.y >= pRange->nHeight) {
+        return 0;
+    }
+
+    if (nMovePoints < 0) {
+        nMovePoints = 0;
+    } else if (nMovePoints > MOVE_RANGE_MAX_POINTS) {
+        nMovePoints = MOVE_RANGE_MAX_POINTS;
+    }
+
+    // Bumping the generation invalidates every tile at once; only a wrap-around needs a real clear
+    pRange->uGeneration++;
+    if (pRange->uGeneration == 0) {
+        memset(pRange->arrGenerations, 0, (size_t)pRange->nWidth * pRange->nHeight * sizeof(UINT));
+        pRange->uGeneration = 1;
+    }
+
+    pRange->ptStart = ptStart;
+    pRange->nMovePoints = nMovePoints;
+
+    for (INT nCost = 0; nCost <= nMovePoints; nCost++) {
+        pRange->arrBuckets[nCost] = -1;
+    }
+
+    const INT nWidth = pRange->nWidth;
+    const INT nHeight = pRange->nHeight;
+    const UINT uGeneration = pRange->uGeneration;
+    const BYTE* arrTerrain = pTerrain->arrCosts;
+    UINT* arrGenerations = pRange->arrGenerations;
+    UINT16* arrCosts = pRange->arrCosts;
+    INT* arrParents = pRange->arrParents;
+    MoveRangeEntry* arrEntries = pRange->arrEntries;
+    INT nEntries = 0;
+
+    const INT iStart = ptStart.y * nWidth + ptStart.x;
+    arrGenerations[iStart] = uGeneration;
+    arrCosts[iStart] = 0;
+    arrParents[iStart] = -1;
+    arrEntries[nEntries] = (MoveRangeEntry) { iStart, -1 };
+    pRange->arrBuckets[0] = nEntries++;
+
+    // Costs only grow, so the buckets are settled in order and each bucket is final once it is reached
+    for (INT nCost = 0; nCost <= nMovePoints; nCost++) {
+        while (pRange->arrBuckets[nCost] != -1) {
+            const MoveRangeEntry* pEntry = &arrEntries[pRange->arrBuckets[nCost]];
+            pRange->arrBuckets[nCost] = pEntry->iNext;
+
+            const INT iTile = pEntry->iTile;
+            if (arrCosts[iTile] != nCost) {
+                continue; // << A cheaper path was found after this entry was queued
+            }
+
+            pRange->arrReached[pRange->nReached++] = iTile;
+
+            const INT x = iTile % nWidth;
+            const INT y = iTile / nWidth;
+            const INT arrNeighbours[4] = {
+                x > 0 ? iTile - 1 : -1,
+                x < nWidth - 1 ? iTile + 1 : -1,
+                y > 0 ? iTile - nWidth : -1,
+                y < nHeight - 1 ? iTile + nWidth : -1
+            };
+
+            for (INT i = 0; i < 4; i++) {
+                const INT iNeighbour = arrNeighbours[i];
+                if (iNeighbour < 0 || arrTerrain[iNeighbour] == TERRAIN_COST_IMPASSABLE) {
+                    continue;
+                }
+
+                const INT nNewCost = nCost + arrTerrain[iNeighbour];
+                if (nNewCost > nMovePoints) {
+                    continue;
+                }
+                if (arrGenerations[iNeighbour] == uGeneration && arrCosts[iNeighbour] <= nNewCost) {
+                    continue;
+                }
+
+                arrGenerations[iNeighbour] = uGeneration;
+                arrCosts[iNeighbour] = (UINT16)nNewCost;
+                arrParents[iNeighbour] = iTile;
+                arrEntries[nEntries] = (MoveRangeEntry) { iNeighbour, pRange->arrBuckets[nNewCost] };
+                pRange->arrBuckets[nNewCost] = nEntries++;
+            }
+        }
+    }
+
+    return pRange->nReached;
+}
+
+_Check_return_
+INT MoveRange_GetCost(
+    _In_ const MoveRange* pRange,
+    _In_ const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pRange->nWidth || ptTile.y >= pRange->nHeight) {
+        return -1;
+    }
+
+    const INT iTile = ptTile.y * pRange->nWidth + ptTile.x;
+    if (pRange->arrGenerations[iTile] != pRange->uGeneration || pRange->nReached == 0) {
+        return -1;
+    }
+    return pRange->arrCosts[iTile];
+}
+
+_Check_return_
+bool MoveRange_IsReachable(
+    _In_ const MoveRange* pRange,
+    _In_ const POINT ptTile
+) {
+    return MoveRange_GetCost(pRange, ptTile) >= 0;
+}
+
+_Check_return_
+POINT MoveRange_GetReachedTile(
+    _In_ const MoveRange* pRange,
+    _In_ const INT i
+) {
+    const INT iTile = pRange->arrReached[i];
+    return (POINT) { iTile % pRange->nWidth, iTile / pRange->nWidth };
+}
+
+_Check_return_
+INT MoveRange_GetPath(
+    _In_                                const MoveRange* pRange,
+    _In_                                const POINT ptTarget,
+    _Out_writes_to_(nMaxLength, return) POINT* arrPath,
+    _In_                                const INT nMaxLength
+) {
+    if (!MoveRange_IsReachable(pRange, ptTarget)) {
+        return -1;
+    }
+
+    INT nLength = 0;
+    for (INT iTile = ptTarget.y * pRange->nWidth + ptTarget.x; pRange->arrParents[iTile] != -1;
+         iTile = pRange->arrParents[iTile]) {
+        nLength++;
+    }
+    if (nLength > nMaxLength) {
+        return -1;
+    }
+
+    // Walk the parents back from the target and fill the path from its end
+    INT i = nLength;
+    for (INT iTile = ptTarget.y * pRange->nWidth + ptTarget.x; pRange->arrParents[iTile] != -1;
+         iTile = pRange->arrParents[iTile]) {
+        arrPath[--i] = (POINT) { iTile % pRange->nWidth, iTile / pRange->nWidth };
+    }
+
+    return nLength;
+}
+
+_Check_return_opt_
+bool MoveRange_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ MoveRange* pRange
+) {
+    if (!pRange) {
+        return false;
+    }
+
+    SafeFree(pRange->arrGenerations);
+    SafeFree(pRange->arrCosts);
+    SafeFree(pRange->arrParents);
+    SafeFree(pRange->arrReached);
+    SafeFree(pRange->arrEntries);
+    SafeFree(pRange);
+    return true;
+}
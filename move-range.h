@@ -0,0 +1,128 @@
+#ifndef MOVE_RANGE_H
+#define MOVE_RANGE_H
+
+#include "utils.h"
+#include "point.h"
+
+typedef struct _TerrainMap TerrainMap;
+
+#define MOVE_RANGE_MAX_POINTS 254 // << Larger movement budgets are clamped
+
+typedef struct _MoveRangeEntry {
+    INT iTile;
+    INT iNext;  // << Next entry in the same bucket, or -1
+} MoveRangeEntry;
+
+/*
+ * Reusable state for "which tiles can this unit reach" queries.
+ *
+ * Every array is sized to the map once, when the context is created. Instead of clearing the arrays before each
+ * query, every tile carries the generation it was last written in; tiles from older generations count as
+ * unvisited. The open set is a Dial queue: one bucket per total cost, each bucket an intrusive list threaded
+ * through a preallocated entry pool, so a query never allocates.
+ */
+typedef struct _MoveRange {
+    INT nWidth;
+    INT nHeight;
+    UINT uGeneration;
+    UINT* arrGenerations;      // << Generation in which arrCosts/arrParents of a tile were written
+    UINT16* arrCosts;          // << Cheapest known cost from the start tile
+    INT* arrParents;           // << Previous tile on the cheapest path, or -1 for the start tile
+    INT* arrReached;           // << Every reachable tile, in the order it was settled
+    INT nReached;
+    MoveRangeEntry* arrEntries;
+    INT nEntriesCapacity;
+    INT arrBuckets[MOVE_RANGE_MAX_POINTS + 1];
+    POINT ptStart;
+    INT nMovePoints;
+} MoveRange;
+
+/**
+ * @brief Creates a movement range context for maps of the given size.
+ *
+ * @param nWidth  Width of the map in tiles.
+ * @param nHeight Height of the map in tiles.
+ * @return A pointer to the new `MoveRange`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ MoveRange* MoveRange_Create(
+    _In_ INT nWidth,
+    _In_ INT nHeight
+    );
+
+/**
+ * @brief Finds every tile reachable from a start tile with a movement budget.
+ *
+ * Movement is orthogonal. Entering a tile costs its terrain cost; the start tile itself is free. Results stay
+ * valid until the next call.
+ *
+ * @param pRange      Pointer to the `MoveRange` context, created with the size of the terrain.
+ * @param pTerrain    Pointer to the `TerrainMap` with the tile costs.
+ * @param ptStart     Tile the unit stands on.
+ * @param nMovePoints Movement budget, at most `MOVE_RANGE_MAX_POINTS`.
+ * @return The number of reachable tiles, including the start tile. `0` if the start is outside the map.
+ */
+_Check_return_opt_ INT MoveRange_Compute(
+    _Inout_ MoveRange* pRange,
+    _In_    const TerrainMap* pTerrain,
+    _In_    POINT ptStart,
+    _In_    INT nMovePoints
+    );
+
+/**
+ * @brief Gets the movement points needed to reach a tile in the last query.
+ *
+ * @return The cost, or `-1` if the tile is out of range.
+ */
+_Check_return_ INT MoveRange_GetCost(
+    _In_ const MoveRange* pRange,
+    _In_ POINT ptTile
+    );
+
+/**
+ * @brief Checks whether a tile was reachable in the last query.
+ */
+_Check_return_ bool MoveRange_IsReachable(
+    _In_ const MoveRange* pRange,
+    _In_ POINT ptTile
+    );
+
+/**
+ * @brief Gets the reachable tile with the given index, in the order the tiles were settled.
+ *
+ * @param pRange Pointer to the `MoveRange` context.
+ * @param i      Index between `0` and `nReached - 1`.
+ * @return The tile position.
+ */
+_Check_return_ POINT MoveRange_GetReachedTile(
+    _In_ const MoveRange* pRange,
+    _In_ INT i
+    );
+
+/**
+ * @brief Builds the cheapest path from the start tile to a reachable tile.
+ *
+ * @param pRange     Pointer to the `MoveRange` context.
+ * @param ptTarget   Reachable tile to walk to.
+ * @param arrPath    Receives the tiles from the first step to `ptTarget`; the start tile is not included.
+ * @param nMaxLength Capacity of `arrPath`.
+ * @return The number of steps, `0` if `ptTarget` is the start tile, or `-1` if it is not reachable or the path
+ *         does not fit.
+ */
+_Check_return_ INT MoveRange_GetPath(
+    _In_                                const MoveRange* pRange,
+    _In_                                POINT ptTarget,
+    _Out_writes_to_(nMaxLength, return) POINT* arrPath,
+    _In_                                INT nMaxLength
+    );
+
+/**
+ * @brief Destroys a movement range context and frees its resources.
+ *
+ * @param pRange Pointer to the `MoveRange` to destroy.
+ * @return `true` if the context was destroyed, `false` if `pRange` was `NULL`.
+ */
+_Check_return_opt_ bool MoveRange_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ MoveRange* pRange
+    );
+
+#endif //MOVE_RANGE_H
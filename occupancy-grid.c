@@ -0,0 +1,141 @@
+#include "occupancy-grid.h"
+
+#include "tilemap.h"
+#include "unit.h"
+
+_Check_return_ _Ret_maybenull_
+OccupancyGrid* OccupancyGrid_Create(
+    _In_ const INT nWidth,
+    _In_ const INT nHeight
+) {
+    if (nWidth <= 0 || nHeight <= 0) {
+        return NULL;
+    }
+
+    OccupancyGrid* pGrid = malloc(sizeof(OccupancyGrid));
+    if (!pGrid) {
+        printf("Failed to allocate memory for OccupancyGrid\n");
+        return NULL;
+    }
+
+    pGrid->nWidth = nWidth;
+    pGrid->nHeight = nHeight;
+    pGrid->nCount = 0;
+    pGrid->arrUnits = calloc((size_t)nWidth * nHeight, sizeof(Unit*));
+    if (!pGrid->arrUnits) {
+        printf("Failed to allocate memory for occupancy grid tiles\n");
+        SafeFree(pGrid);
+        return NULL;
+    }
+
+    return pGrid;
+}
+
+_Check_return_ _Ret_maybenull_
+OccupancyGrid* OccupancyGrid_CreateForTilemap(
+    _In_ const Tilemap* pTilemap
+) {
+    if (pTilemap->nCount <= 0 || !pTilemap->arrLayers[0].arrTiles) {
+        printf("Tilemap has no layer to size the occupancy grid from\n");
+        return NULL;
+    }
+
+    return OccupancyGrid_Create(pTilemap->arrLayers[0].usWidth, pTilemap->arrLayers[0].usHeight);
+}
+
+_Check_return_opt_
+bool OccupancyGrid_Place(
+    _Inout_ OccupancyGrid* pGrid,
+    _Inout_ Unit* pUnit
+) {
+    if (pUnit->pOccupancy) {
+        printf("Unit is already placed on an occupancy grid\n");
+        return false;
+    }
+    const POINT ptTile = Unit_GetState(pUnit)->ptTilePosition;
+    if (!OccupancyGrid_IsFree(pGrid, ptTile)) {
+        return false;
+    }
+
+    pGrid->arrUnits[ptTile.y * pGrid->nWidth + ptTile.x] = pUnit;
+    pGrid->nCount++;
+    pUnit->pOccupancy = pGrid;
+    return true;
+}
+
+void OccupancyGrid_Remove(
+    _Inout_ OccupancyGrid* pGrid,
+    _Inout_ Unit* pUnit
+) {
+    if (pUnit->pOccupancy != pGrid) {
+        return;
+    }
+
+    const POINT ptTile = Unit_GetState(pUnit)->ptTilePosition;
+    if (OccupancyGrid_Get(pGrid, ptTile) == pUnit) {
+        pGrid->arrUnits[ptTile.y * pGrid->nWidth + ptTile.x] = NULL;
+    }
+    pGrid->nCount--;
+    pUnit->pOccupancy = NULL;
+}
+
+_Check_return_opt_
+bool OccupancyGrid_Relocate(
+    _Inout_ OccupancyGrid* pGrid,
+    _In_    Unit* pUnit,
+    _In_    const POINT ptFrom,
+    _In_    const POINT ptTo
+) {
+    // Overwriting another unit would leave it placed but on no tile, so the move is refused instead
+    if (!OccupancyGrid_IsFree(pGrid, ptTo) && OccupancyGrid_Get(pGrid, ptTo) != pUnit) {
+        return false;
+    }
+
+    if (OccupancyGrid_Get(pGrid, ptFrom) == pUnit) {
+        pGrid->arrUnits[ptFrom.y * pGrid->nWidth + ptFrom.x] = NULL;
+    }
+    pGrid->arrUnits[ptTo.y * pGrid->nWidth + ptTo.x] = pUnit;
+    return true;
+}
+
+_Check_return_
+INT OccupancyGrid_GetNeighbours(
+    _In_                        const OccupancyGrid* pGrid,
+    _In_                        const POINT ptTile,
+    _Out_writes_to_(4, return)  Unit** arrUnits
+) {
+    const POINT arrNeighbours[4] = {
+        { ptTile.x - 1, ptTile.y },
+        { ptTile.x + 1, ptTile.y },
+        { ptTile.x, ptTile.y - 1 },
+        { ptTile.x, ptTile.y + 1 }
+    };
+
+    INT nCount = 0;
+    for (INT i = 0; i < 4; i++) {
+        Unit* pUnit = OccupancyGrid_Get(pGrid, arrNeighbours[i]);
+        if (pUnit) {
+            arrUnits[nCount++] = pUnit;
+        }
+    }
+    return nCount;
+}
+
+_Check_return_opt_
+bool OccupancyGrid_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ OccupancyGrid* pGrid
+) {
+    if (!pGrid) {
+        return false;
+    }
+
+    for (INT i = 0; i < pGrid->nWidth * pGrid->nHeight; i++) {
+        if (pGrid->arrUnits[i] && pGrid->arrUnits[i]->pOccupancy == pGrid) {
+            pGrid->arrUnits[i]->pOccupancy = NULL;
+        }
+    }
+
+    SafeFree(pGrid->arrUnits);
+    SafeFree(pGrid);
+    return true;
+}
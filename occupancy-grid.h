@@ -0,0 +1,145 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include "utils.h"
+#include "point.h"
+
+typedef struct _Unit Unit;
+typedef struct _Tilemap Tilemap;
+
+/*
+ * The unit standing on every tile of a map, stored as one flat row-major array so "who is on (x, y)" is a
+ * single load instead of a scan over all units.
+ *
+ * A placed unit keeps a pointer to its grid and updates it whenever its tile changes, so the grid never has to
+ * be rebuilt. A moving unit occupies the tile it is moving to.
+ */
+typedef struct _OccupancyGrid {
+    INT nWidth;
+    INT nHeight;
+    Unit** arrUnits;     // << nWidth * nHeight entries, NULL for empty tiles
+    INT nCount;          // << Number of placed units
+} OccupancyGrid;
+
+/**
+ * @brief Creates an empty occupancy grid.
+ *
+ * @param nWidth  Width of the map in tiles.
+ * @param nHeight Height of the map in tiles.
+ * @return A pointer to the new `OccupancyGrid`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ OccupancyGrid* OccupancyGrid_Create(
+    _In_ INT nWidth,
+    _In_ INT nHeight
+    );
+
+/**
+ * @brief Creates an empty occupancy grid with the size of the first layer of a tilemap.
+ *
+ * @param pTilemap Pointer to the `Tilemap` the units are placed on.
+ * @return A pointer to the new `OccupancyGrid`, or `NULL` if the tilemap has no layer or the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ OccupancyGrid* OccupancyGrid_CreateForTilemap(
+    _In_ const Tilemap* pTilemap
+    );
+
+/**
+ * @brief Places a unit on the tile it stands on.
+ *
+ * @param pGrid Pointer to the `OccupancyGrid`.
+ * @param pUnit Unit to place. It must not be placed on another grid.
+ * @return `true` if the unit was placed, `false` if its tile is outside the grid or taken by another unit.
+ */
+_Check_return_opt_ bool OccupancyGrid_Place(
+    _Inout_ OccupancyGrid* pGrid,
+    _Inout_ Unit* pUnit
+    );
+
+/**
+ * @brief Takes a unit off the grid, e.g. when it dies.
+ *
+ * @param pGrid Pointer to the `OccupancyGrid` the unit was placed on.
+ * @param pUnit Unit to remove.
+ */
+void OccupancyGrid_Remove(
+    _Inout_ OccupancyGrid* pGrid,
+    _Inout_ Unit* pUnit
+    );
+
+/**
+ * @brief Moves a placed unit's entry from one tile to another.
+ *
+ * Called by the unit functions that change `state.ptTilePosition`; game code does not need to call it. The old tile is
+ * only cleared if it still holds `pUnit`.
+ *
+ * @param pGrid  Pointer to the `OccupancyGrid`.
+ * @param pUnit  Unit that moves.
+ * @param ptFrom Tile the unit leaves.
+ * @param ptTo   Tile the unit moves to.
+ * @return `true` if the unit moved, `false` if `ptTo` is outside the grid or taken by another unit. The grid is
+ *         unchanged then.
+ */
+_Check_return_opt_ bool OccupancyGrid_Relocate(
+    _Inout_ OccupancyGrid* pGrid,
+    _In_    Unit* pUnit,
+    _In_    POINT ptFrom,
+    _In_    POINT ptTo
+    );
+
+/**
+ * @brief Collects the units on the four tiles next to a tile, e.g. for zone of control.
+ *
+ * @param pGrid     Pointer to the `OccupancyGrid`.
+ * @param ptTile    Tile whose neighbours are checked.
+ * @param arrUnits  Receives the units found, at most four.
+ * @return The number of units written to `arrUnits`.
+ */
+_Check_return_ INT OccupancyGrid_GetNeighbours(
+    _In_                        const OccupancyGrid* pGrid,
+    _In_                        POINT ptTile,
+    _Out_writes_to_(4, return)  Unit** arrUnits
+    );
+
+/**
+ * @brief Gets the unit on a tile.
+ *
+ * @return The unit, or `NULL` if the tile is empty or outside the grid.
+ */
+_Check_return_ _Ret_maybenull_
+static inline Unit* OccupancyGrid_Get(
+    _In_ const OccupancyGrid* pGrid,
+    _In_ const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pGrid->nWidth || ptTile.y >= pGrid->nHeight) {
+        return NULL;
+    }
+    return pGrid->arrUnits[ptTile.y * pGrid->nWidth + ptTile.x];
+}
+
+/**
+ * @brief Checks whether a tile is inside the grid and has no unit on it.
+ */
+_Check_return_
+static inline bool OccupancyGrid_IsFree(
+    _In_ const OccupancyGrid* pGrid,
+    _In_ const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pGrid->nWidth || ptTile.y >= pGrid->nHeight) {
+        return false;
+    }
+    return pGrid->arrUnits[ptTile.y * pGrid->nWidth + ptTile.x] == NULL;
+}
+
+/**
+ * @brief Destroys an occupancy grid and frees its resources.
+ *
+ * Units still placed on the grid are detached from it, but not destroyed.
+ *
+ * @param pGrid Pointer to the `OccupancyGrid` to destroy.
+ * @return `true` if the grid was destroyed, `false` if `pGrid` was `NULL`.
+ */
+_Check_return_opt_ bool OccupancyGrid_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ OccupancyGrid* pGrid
+    );
+
+#endif //OCCUPANCY_GRID_H
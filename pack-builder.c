@@ -0,0 +1,423 @@
+#include <string.h>
+#include <SFML/System.h>
+
+#include "utils.h"
+#include "pack.h"
+#include "lz4.h"
+
+/*
+ * Builds a pack archive from loose asset files.
+ *
+ *   pack-builder [-c] <output.pak> <file|@listfile>...
+ *   pack-builder --bench <pack>...
+ *
+ * Paths are stored exactly as given (relative to the game's working directory), with backslashes converted
+ * to forward slashes. A list file contains one path per line.
+ *
+ * With -c, entries are stored as LZ4 blocks when that saves at least an eighth of their size.
+ * --bench reads every entry of each pack a number of times and reports the load throughput, so a raw and a
+ * compressed build of the same assets can be compared.
+ */
+
+#define BENCH_PASSES 20
+
+typedef struct _BuilderEntry {
+    PSTR pszName;
+    UINT64 u64Offset;
+    UINT64 u64Size;
+    UINT64 u64StoredSize;
+    UINT uFlags;
+} BuilderEntry;
+
+typedef struct _Builder {
+    BuilderEntry* arrEntries;
+    INT nCount;
+    INT nCapacity;
+    bool bCompress;
+} Builder;
+
+_Check_return_
+static bool Builder_AddPath(
+    _Inout_ Builder* pBuilder,
+    _In_z_  PCSTR pszPath
+) {
+    while (pszPath[0] == '.' && (pszPath[1] == '/' || pszPath[1] == '\\')) {
+        pszPath += 2;
+    }
+
+    const size_t cchPath = strlen(pszPath);
+    if (cchPath == 0) {
+        return true;
+    }
+    if (cchPath >= PACK_MAX_PATH) {
+        printf("Path is too long: %s\n", pszPath);
+        return false;
+    }
+
+    if (pBuilder->nCount >= pBuilder->nCapacity) {
+        pBuilder->nCapacity += 64;
+        BuilderEntry* arrEntries = realloc(pBuilder->arrEntries, pBuilder->nCapacity * sizeof(BuilderEntry));
+        if (!arrEntries) {
+            printf("Failed to allocate memory for pack entries\n");
+            return false;
+        }
+        pBuilder->arrEntries = arrEntries;
+    }
+
+    PSTR pszName = strdup(pszPath);
+    if (!pszName) {
+        return false;
+    }
+    for (PSTR p = pszName; *p; p++) {
+        if (*p == '\\') {
+            *p = '/';
+        }
+    }
+
+    pBuilder->arrEntries[pBuilder->nCount].pszName = pszName;
+    pBuilder->arrEntries[pBuilder->nCount].u64Offset = 0;
+    pBuilder->arrEntries[pBuilder->nCount].u64Size = 0;
+    pBuilder->arrEntries[pBuilder->nCount].u64StoredSize = 0;
+    pBuilder->arrEntries[pBuilder->nCount].uFlags = 0;
+    pBuilder->nCount++;
+    return true;
+}
+
+_Check_return_
+static bool Builder_AddListFile(
+    _Inout_ Builder* pBuilder,
+    _In_z_  PCSTR pszListFile
+) {
+    FILE* pList = NULL;
+    fopen_s(&pList, pszListFile, "r");
+    if (!pList) {
+        printf("Failed to open list file: %s\n", pszListFile);
+        return false;
+    }
+
+    char szLine[PACK_MAX_PATH + 2];
+    while (fgets(szLine, sizeof(szLine), pList)) {
+        szLine[strcspn(szLine, "\r\n")] = '\0';
+        if (!Builder_AddPath(pBuilder, szLine)) {
+            fclose(pList);
+            return false;
+        }
+    }
+
+    fclose(pList);
+    return true;
+}
+
+static int CompareEntries(
+    const void* pLeft,
+    const void* pRight
+) {
+    return strcmp(((const BuilderEntry*)pLeft)->pszName, ((const BuilderEntry*)pRight)->pszName);
+}
+
+static void WritePadding(
+    _In_ FILE* pOutput,
+    _In_ const UINT64 u64Alignment
+) {
+    static const BYTE s_arrZeros[PACK_ALIGNMENT] = { 0 };
+    const UINT64 u64Position = (UINT64)ftell(pOutput);
+    const UINT64 cbPadding = (u64Alignment - u64Position % u64Alignment) % u64Alignment;
+    fwrite(s_arrZeros, 1, (size_t)cbPadding, pOutput);
+}
+
+_Check_return_ _Ret_maybenull_
+static BYTE* ReadWholeFile(
+    _In_z_ PCSTR pszFilename,
+    _Out_  ULONG* pcbSize
+) {
+    FILE* pInput = NULL;
+    fopen_s(&pInput, pszFilename, "rb");
+    if (!pInput) {
+        printf("Failed to open %s\n", pszFilename);
+        return NULL;
+    }
+
+    fseek(pInput, 0, SEEK_END);
+    const ULONG cbSize = (ULONG)ftell(pInput);
+    fseek(pInput, 0, SEEK_SET);
+
+    BYTE* pData = malloc(cbSize + 1);
+    if (!pData || fread(pData, 1, cbSize, pInput) != cbSize) {
+        printf("Failed to read %s\n", pszFilename);
+        SafeFree(pData);
+        fclose(pInput);
+        return NULL;
+    }
+
+    fclose(pInput);
+    *pcbSize = cbSize;
+    return pData;
+}
+
+_Check_return_ _Ret_maybenull_
+static BYTE* CompressEntry(
+    _In_reads_bytes_(cbSize) const BYTE* pData,
+    _In_                     const ULONG cbSize,
+    _Out_                    ULONG* pcbStored
+) {
+    const UINT nBlocks = (UINT)((cbSize + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE);
+    const ULONG cbTable = sizeof(PackBlockHeader) + ((ULONG)nBlocks + 1) * sizeof(UINT);
+
+    BYTE* pStored = malloc(cbTable + (ULONG)nBlocks * Lz4_CompressBound(PACK_BLOCK_SIZE));
+    if (!pStored) {
+        return NULL;
+    }
+
+    PackBlockHeader* pBlockHeader = (PackBlockHeader*)pStored;
+    pBlockHeader->nBlocks = nBlocks;
+    pBlockHeader->uBlockSize = PACK_BLOCK_SIZE;
+
+    UINT* arrBlockOffsets = (UINT*)(pStored + sizeof(PackBlockHeader));
+    BYTE* pBlocks = pStored + cbTable;
+    UINT uOffset = 0;
+
+    for (UINT i = 0; i < nBlocks; i++) {
+        const ULONG cbRawOffset = (ULONG)i * PACK_BLOCK_SIZE;
+        const ULONG cbRaw = cbSize - cbRawOffset < PACK_BLOCK_SIZE ? cbSize - cbRawOffset : PACK_BLOCK_SIZE;
+
+        arrBlockOffsets[i] = uOffset;
+        ULONG cbBlock = Lz4_CompressBlock(pData + cbRawOffset, cbRaw, pBlocks + uOffset, Lz4_CompressBound(cbRaw));
+
+        // Incompressible blocks are stored raw; the reader recognises them by their size
+        if (cbBlock == 0 || cbBlock >= cbRaw) {
+            memcpy(pBlocks + uOffset, pData + cbRawOffset, cbRaw);
+            cbBlock = cbRaw;
+        }
+        uOffset += (UINT)cbBlock;
+    }
+    arrBlockOffsets[nBlocks] = uOffset;
+
+    *pcbStored = cbTable + uOffset;
+    return pStored;
+}
+
+_Check_return_
+static bool WriteEntry(
+    _In_    FILE* pOutput,
+    _Inout_ BuilderEntry* pEntry,
+    _In_    const bool bCompress
+) {
+    ULONG cbSize;
+    BYTE* pData = ReadWholeFile(pEntry->pszName, &cbSize);
+    if (!pData) {
+        return false;
+    }
+
+    pEntry->u64Size = cbSize;
+    pEntry->u64StoredSize = cbSize;
+    pEntry->uFlags = 0;
+
+    if (bCompress && cbSize > 0) {
+        ULONG cbStored;
+        BYTE* pStored = CompressEntry(pData, cbSize, &cbStored);
+        if (pStored && cbStored <= cbSize - cbSize / 8) {
+            SafeFree(pData);
+            pData = pStored;
+            pEntry->u64StoredSize = cbStored;
+            pEntry->uFlags |= PACK_ENTRY_COMPRESSED;
+        } else {
+            SafeFree(pStored);
+        }
+    }
+
+    fwrite(pData, 1, pEntry->u64StoredSize, pOutput);
+    SafeFree(pData);
+    return true;
+}
+
+_Check_return_
+static bool Builder_Write(
+    _Inout_ Builder* pBuilder,
+    _In_z_  PCSTR pszOutput
+) {
+    qsort(pBuilder->arrEntries, pBuilder->nCount, sizeof(BuilderEntry), CompareEntries);
+    for (INT i = 1; i < pBuilder->nCount; i++) {
+        if (strcmp(pBuilder->arrEntries[i - 1].pszName, pBuilder->arrEntries[i].pszName) == 0) {
+            printf("Duplicate entry: %s\n", pBuilder->arrEntries[i].pszName);
+            return false;
+        }
+    }
+
+    FILE* pOutput = NULL;
+    fopen_s(&pOutput, pszOutput, "wb");
+    if (!pOutput) {
+        printf("Failed to create %s\n", pszOutput);
+        return false;
+    }
+
+    PackHeader header = { 0 };
+    header.uMagic = PACK_MAGIC;
+    header.uVersion = PACK_VERSION;
+    header.nEntries = (UINT)pBuilder->nCount;
+    fwrite(&header, sizeof(header), 1, pOutput);
+
+    for (INT i = 0; i < pBuilder->nCount; i++) {
+        BuilderEntry* pEntry = &pBuilder->arrEntries[i];
+        WritePadding(pOutput, PACK_ALIGNMENT);
+        pEntry->u64Offset = (UINT64)ftell(pOutput);
+        if (!WriteEntry(pOutput, pEntry, pBuilder->bCompress)) {
+            fclose(pOutput);
+            remove(pszOutput);
+            return false;
+        }
+    }
+
+    WritePadding(pOutput, sizeof(UINT64));
+    header.u64DirectoryOffset = (UINT64)ftell(pOutput);
+
+    UINT uNameOffset = 0;
+    for (INT i = 0; i < pBuilder->nCount; i++) {
+        const PackEntry entry = {
+            pBuilder->arrEntries[i].u64Offset,
+            pBuilder->arrEntries[i].u64Size,
+            pBuilder->arrEntries[i].u64StoredSize,
+            uNameOffset,
+            (UINT)strlen(pBuilder->arrEntries[i].pszName),
+            pBuilder->arrEntries[i].uFlags,
+            0
+        };
+        fwrite(&entry, sizeof(entry), 1, pOutput);
+        uNameOffset += entry.uNameLength;
+    }
+
+    header.u64NamesOffset = (UINT64)ftell(pOutput);
+    for (INT i = 0; i < pBuilder->nCount; i++) {
+        fwrite(pBuilder->arrEntries[i].pszName, 1, strlen(pBuilder->arrEntries[i].pszName), pOutput);
+    }
+
+    fseek(pOutput, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, pOutput);
+
+    const bool bSucceeded = !ferror(pOutput);
+    fclose(pOutput);
+    return bSucceeded;
+}
+
+static void Builder_Destroy(
+    _Inout_ Builder* pBuilder
+) {
+    for (INT i = 0; i < pBuilder->nCount; i++) {
+        SafeFree(pBuilder->arrEntries[i].pszName);
+    }
+    SafeFree(pBuilder->arrEntries);
+}
+
+_Check_return_
+static bool BenchmarkPack(
+    _In_z_ PCSTR pszFilename
+) {
+    Pack* pPack = Pack_Open(pszFilename);
+    if (!pPack) {
+        printf("Failed to open pack %s\n", pszFilename);
+        return false;
+    }
+
+    UINT64 u64PlainBytes = 0;
+    UINT64 u64StoredBytes = 0;
+    UINT nCompressed = 0;
+    for (UINT i = 0; i < pPack->pHeader->nEntries; i++) {
+        u64PlainBytes += pPack->arrEntries[i].u64Size;
+        u64StoredBytes += pPack->arrEntries[i].u64StoredSize;
+        nCompressed += (pPack->arrEntries[i].uFlags & PACK_ENTRY_COMPRESSED) ? 1 : 0;
+    }
+
+    // Sum every byte so in-place entries are really paged in, the same as a loader would touch them
+    UINT64 u64Checksum = 0;
+    INT64 arrPassTimes[BENCH_PASSES];
+    sfClock* pClock = sfClock_create();
+
+    for (INT nPass = 0; nPass < BENCH_PASSES; nPass++) {
+        sfClock_restart(pClock);
+        for (UINT i = 0; i < pPack->pHeader->nEntries; i++) {
+            const BYTE* pData;
+            ULONG cbSize;
+            BYTE* pOwnedBuffer;
+            if (!Pack_Read(pPack, &pPack->arrEntries[i], &pData, &cbSize, &pOwnedBuffer)) {
+                sfClock_destroy(pClock);
+                Pack_Close(pPack);
+                return false;
+            }
+            for (ULONG j = 0; j < cbSize; j += 64) {
+                u64Checksum += pData[j];
+            }
+            SafeFree(pOwnedBuffer);
+        }
+        arrPassTimes[nPass] = sfTime_asMicroseconds(sfClock_getElapsedTime(pClock));
+    }
+
+    sfClock_destroy(pClock);
+
+    INT64 u64Best = arrPassTimes[0];
+    INT64 u64Total = 0;
+    for (INT nPass = 0; nPass < BENCH_PASSES; nPass++) {
+        u64Total += arrPassTimes[nPass];
+        if (arrPassTimes[nPass] < u64Best) {
+            u64Best = arrPassTimes[nPass];
+        }
+    }
+    const DOUBLE fAverage = (DOUBLE)u64Total / BENCH_PASSES;
+
+    printf("%s\n", pszFilename);
+    printf("  entries      %u (%u compressed)\n", pPack->pHeader->nEntries, nCompressed);
+    printf("  plain size   %.2f MiB\n", (DOUBLE)u64PlainBytes / (1024.0 * 1024.0));
+    printf("  stored size  %.2f MiB (%.1f%%)\n",
+        (DOUBLE)u64StoredBytes / (1024.0 * 1024.0),
+        u64PlainBytes ? 100.0 * (DOUBLE)u64StoredBytes / (DOUBLE)u64PlainBytes : 100.0);
+    printf("  first pass   %.3f ms\n", (DOUBLE)arrPassTimes[0] / 1000.0);
+    printf("  average      %.3f ms, best %.3f ms\n", fAverage / 1000.0, (DOUBLE)u64Best / 1000.0);
+    printf("  throughput   %.1f MiB/s of plain data\n",
+        fAverage > 0.0 ? (DOUBLE)u64PlainBytes / (1024.0 * 1024.0) / (fAverage / 1000000.0) : 0.0);
+    printf("  checksum     %llu\n", (unsigned long long)u64Checksum);
+
+    Pack_Close(pPack);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+        // The first pass includes page faults but not a cold disk cache; drop caches before running for that
+        for (int i = 2; i < argc; i++) {
+            if (!BenchmarkPack(argv[i])) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    Builder builder = { 0 };
+    int iFirstArg = 1;
+    if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+        builder.bCompress = true;
+        iFirstArg++;
+    }
+
+    if (argc - iFirstArg < 2) {
+        printf("Usage: %s [-c] <output.pak> <file|@listfile>...\n", argv[0]);
+        printf("       %s --bench <pack>...\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = iFirstArg + 1; i < argc; i++) {
+        const bool bAdded = argv[i][0] == '@'
+            ? Builder_AddListFile(&builder, argv[i] + 1)
+            : Builder_AddPath(&builder, argv[i]);
+        if (!bAdded) {
+            Builder_Destroy(&builder);
+            return 1;
+        }
+    }
+
+    if (!Builder_Write(&builder, argv[iFirstArg])) {
+        Builder_Destroy(&builder);
+        return 1;
+    }
+
+    printf("Wrote %d entries to %s\n", builder.nCount, argv[iFirstArg]);
+    Builder_Destroy(&builder);
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include "pack.h"
+
+#include <string.h>
+#include <SFML/System.h>
+
+#include "file.h"
+#include "lz4.h"
+
+typedef struct _DecompressJob {
+    const BYTE* pBlocks;         // << First byte after the block offset table
+    const UINT* arrBlockOffsets;
+    UINT uBlockSize;
+    ULONG cbSize;                // << Plain size of the whole entry
+    BYTE* pOutput;
+    UINT iFirstBlock;
+    UINT iEndBlock;
+    bool bFailed;
+} DecompressJob;
+
+static Pack* s_arrMountedPacks[PACK_MAX_MOUNTS];
+static INT s_nMountedPacks;
+#ifdef NDEBUG
+static bool s_bLooseFilesFirst = false;
+#else
+static bool s_bLooseFilesFirst = true;
+#endif
+
+_Check_return_
+static ULONG NormalizePath(
+    _In_z_                   PCSTR pszPath,
+    _Out_writes_(cchBuffer)  PSTR pszBuffer,
+    _In_                     const ULONG cchBuffer
+) {
+    while (pszPath[0] == '.' && (pszPath[1] == '/' || pszPath[1] == '\\')) {
+        pszPath += 2;
+    }
+
+    ULONG cchPath = 0;
+    for (; pszPath[cchPath] != '\0'; cchPath++) {
+        if (cchPath + 1 >= cchBuffer) {
+            return 0;
+        }
+        pszBuffer[cchPath] = pszPath[cchPath] == '\\' ? '/' : pszPath[cchPath];
+    }
+
+    pszBuffer[cchPath] = '\0';
+    return cchPath;
+}
+
+_Check_return_
+static INT CompareName(
+    _In_reads_(cchName) const char* pName,
+    _In_                const ULONG cchName,
+    _In_reads_(cchKey)  const char* pKey,
+    _In_                const ULONG cchKey
+) {
+    const INT nResult = memcmp(pName, pKey, cchName < cchKey ? cchName : cchKey);
+    if (nResult != 0) {
+        return nResult;
+    }
+    return cchName < cchKey ? -1 : cchName > cchKey ? 1 : 0;
+}
+
+/**
+ * Checks that an entry lies inside the mapping and that its plain size can be trusted for allocations.
+ */
+_Check_return_
+static bool IsEntryValid(
+    _In_ const BYTE* pData,
+    _In_ const ULONG cbSize,
+    _In_ const PackHeader* pHeader,
+    _In_ const PackEntry* pEntry
+) {
+    // Written as subtractions so a crafted offset cannot wrap the sum back into range
+    if (pEntry->u64Offset > cbSize || pEntry->u64StoredSize > cbSize - pEntry->u64Offset ||
+        pHeader->u64NamesOffset + pEntry->uNameOffset + pEntry->uNameLength > cbSize) {
+        return false;
+    }
+
+    // Uncompressed entries are handed out in place, so their plain size must be exactly what is stored
+    if ((pEntry->uFlags & PACK_ENTRY_COMPRESSED) == 0) {
+        return pEntry->u64Size == pEntry->u64StoredSize;
+    }
+
+    if (pEntry->u64StoredSize < sizeof(PackBlockHeader)) {
+        return false;
+    }
+
+    const PackBlockHeader* pBlockHeader = (const PackBlockHeader*)(pData + pEntry->u64Offset);
+    const UINT64 cbTable = sizeof(PackBlockHeader) + ((UINT64)pBlockHeader->nBlocks + 1) * sizeof(UINT);
+    return cbTable <= pEntry->u64StoredSize
+        && pEntry->u64Size <= (UINT64)pBlockHeader->nBlocks * pBlockHeader->uBlockSize;
+}
+
+_Check_return_ _Ret_maybenull_
+Pack* Pack_Open(
+    _In_z_ PCSTR pszFilename
+) {
+    FileView* pView = File_Map(pszFilename);
+    if (!pView) {
+        return NULL;
+    }
+
+    const BYTE* pData = FileView_GetData(pView);
+    const ULONG cbSize = FileView_GetSize(pView);
+
+    if (cbSize < sizeof(PackHeader)) {
+        printf("Pack is too small: %s\n", pszFilename);
+        File_Unmap(pView);
+        return NULL;
+    }
+
+    const PackHeader* pHeader = (const PackHeader*)pData;
+    if (pHeader->uMagic != PACK_MAGIC || pHeader->uVersion != PACK_VERSION) {
+        printf("Not a pack or unsupported version: %s\n", pszFilename);
+        File_Unmap(pView);
+        return NULL;
+    }
+
+    if (pHeader->u64DirectoryOffset > cbSize ||
+        (UINT64)pHeader->nEntries * sizeof(PackEntry) > cbSize - pHeader->u64DirectoryOffset ||
+        pHeader->u64NamesOffset > cbSize) {
+        printf("Pack directory is out of bounds: %s\n", pszFilename);
+        File_Unmap(pView);
+        return NULL;
+    }
+
+    const PackEntry* arrEntries = (const PackEntry*)(pData + pHeader->u64DirectoryOffset);
+    for (UINT i = 0; i < pHeader->nEntries; i++) {
+        if (!IsEntryValid(pData, cbSize, pHeader, &arrEntries[i])) {
+            printf("Pack entry %u is out of bounds: %s\n", i, pszFilename);
+            File_Unmap(pView);
+            return NULL;
+        }
+    }
+
+    Pack* pPack = malloc(sizeof(Pack));
+    if (!pPack) {
+        printf("Failed to allocate memory for Pack\n");
+        File_Unmap(pView);
+        return NULL;
+    }
+
+    pPack->pView = pView;
+    pPack->pHeader = pHeader;
+    pPack->arrEntries = arrEntries;
+    pPack->pNames = (const char*)(pData + pHeader->u64NamesOffset);
+
+    return pPack;
+}
+
+_Check_return_ _Ret_maybenull_
+const PackEntry* Pack_Find(
+    _In_   const Pack* pPack,
+    _In_z_ PCSTR pszPath
+) {
+    char szKey[PACK_MAX_PATH];
+    const ULONG cchKey = NormalizePath(pszPath, szKey, sizeof(szKey));
+    if (cchKey == 0) {
+        return NULL;
+    }
+
+    INT iLow = 0;
+    INT iHigh = (INT)pPack->pHeader->nEntries - 1;
+    while (iLow <= iHigh) {
+        const INT iMid = iLow + (iHigh - iLow) / 2;
+        const PackEntry* pEntry = &pPack->arrEntries[iMid];
+
+        const INT nCompare = CompareName(pPack->pNames + pEntry->uNameOffset, pEntry->uNameLength, szKey, cchKey);
+        if (nCompare < 0) {
+            iLow = iMid + 1;
+        } else if (nCompare > 0) {
+            iHigh = iMid - 1;
+        } else {
+            return pEntry;
+        }
+    }
+
+    return NULL;
+}
+
+static void DecompressBlocks(
+    _Inout_ void* pUserData
+) {
+    DecompressJob* pJob = pUserData;
+
+    for (UINT i = pJob->iFirstBlock; i < pJob->iEndBlock; i++) {
+        const ULONG cbRawOffset = (ULONG)i * pJob->uBlockSize;
+        const ULONG cbRaw = pJob->cbSize - cbRawOffset < pJob->uBlockSize ? pJob->cbSize - cbRawOffset : pJob->uBlockSize;
+        const BYTE* pBlock = pJob->pBlocks + pJob->arrBlockOffsets[i];
+        const ULONG cbStored = pJob->arrBlockOffsets[i + 1] - pJob->arrBlockOffsets[i];
+
+        if (cbStored == cbRaw) {
+            memcpy(pJob->pOutput + cbRawOffset, pBlock, cbRaw);
+        } else if (Lz4_DecompressBlock(pBlock, cbStored, pJob->pOutput + cbRawOffset, cbRaw) != (LONG)cbRaw) {
+            pJob->bFailed = true;
+            return;
+        }
+    }
+}
+
+_Check_return_
+static bool DecompressEntry(
+    _In_                     const BYTE* pStored,
+    _In_                     const ULONG cbStored,
+    _Out_writes_bytes_(cbSize) BYTE* pOutput,
+    _In_                     const ULONG cbSize
+) {
+    if (cbStored < sizeof(PackBlockHeader)) {
+        return false;
+    }
+
+    const PackBlockHeader* pBlockHeader = (const PackBlockHeader*)pStored;
+    const UINT nBlocks = pBlockHeader->nBlocks;
+    const UINT uBlockSize = pBlockHeader->uBlockSize;
+    const ULONG cbTable = sizeof(PackBlockHeader) + ((ULONG)nBlocks + 1) * sizeof(UINT);
+
+    if (uBlockSize == 0 || cbTable > cbStored || (ULONG)nBlocks * uBlockSize < cbSize ||
+        (nBlocks > 0 && (ULONG)(nBlocks - 1) * uBlockSize >= cbSize)) {
+        return false;
+    }
+
+    const UINT* arrBlockOffsets = (const UINT*)(pStored + sizeof(PackBlockHeader));
+    for (UINT i = 0; i < nBlocks; i++) {
+        if (arrBlockOffsets[i] > arrBlockOffsets[i + 1]) {
+            return false;
+        }
+    }
+    if (arrBlockOffsets[nBlocks] > cbStored - cbTable) {
+        return false;
+    }
+
+    DecompressJob arrJobs[PACK_MAX_DECOMPRESS_THREADS];
+    UINT nJobs = cbSize >= PACK_PARALLEL_THRESHOLD ? PACK_MAX_DECOMPRESS_THREADS : 1;
+    if (nJobs > nBlocks) {
+        nJobs = nBlocks > 0 ? nBlocks : 1;
+    }
+
+    for (UINT i = 0; i < nJobs; i++) {
+        arrJobs[i].pBlocks = pStored + cbTable;
+        arrJobs[i].arrBlockOffsets = arrBlockOffsets;
+        arrJobs[i].uBlockSize = uBlockSize;
+        arrJobs[i].cbSize = cbSize;
+        arrJobs[i].pOutput = pOutput;
+        arrJobs[i].iFirstBlock = (UINT)((UINT64)nBlocks * i / nJobs);
+        arrJobs[i].iEndBlock = (UINT)((UINT64)nBlocks * (i + 1) / nJobs);
+        arrJobs[i].bFailed = false;
+    }
+
+    // Blocks are independent, so each thread gets a contiguous range and the calling thread takes the first one
+    sfThread* arrThreads[PACK_MAX_DECOMPRESS_THREADS] = { NULL };
+    for (UINT i = 1; i < nJobs; i++) {
+        arrThreads[i] = sfThread_create(DecompressBlocks, &arrJobs[i]);
+        if (arrThreads[i]) {
+            sfThread_launch(arrThreads[i]);
+        }
+    }
+
+    DecompressBlocks(&arrJobs[0]);
+
+    bool bSucceeded = !arrJobs[0].bFailed;
+    for (UINT i = 1; i < nJobs; i++) {
+        if (arrThreads[i]) {
+            sfThread_wait(arrThreads[i]);
+            sfThread_destroy(arrThreads[i]);
+        } else {
+            DecompressBlocks(&arrJobs[i]);
+        }
+        bSucceeded = bSucceeded && !arrJobs[i].bFailed;
+    }
+
+    return bSucceeded;
+}
+
+_Check_return_ _Success_(return)
+bool Pack_Read(
+    _In_  const Pack* pPack,
+    _In_  const PackEntry* pEntry,
+    _Out_ const BYTE** ppData,
+    _Out_ ULONG* pcbSize,
+    _Out_ BYTE** ppOwnedBuffer
+) {
+    const BYTE* pStored = FileView_GetData(pPack->pView) + pEntry->u64Offset;
+
+    *ppOwnedBuffer = NULL;
+
+    if ((pEntry->uFlags & PACK_ENTRY_COMPRESSED) == 0) {
+        *ppData = pStored;
+        *pcbSize = pEntry->u64Size;
+        return true;
+    }
+
+    // One spare byte so callers that need a terminator, like File_ReadAllBytes, never have to copy again
+    BYTE* pBuffer = malloc(pEntry->u64Size + 1);
+    if (!pBuffer) {
+        printf("Failed to allocate memory for pack entry\n");
+        return false;
+    }
+
+    if (!DecompressEntry(pStored, pEntry->u64StoredSize, pBuffer, pEntry->u64Size)) {
+        printf("Corrupt compressed pack entry: %.*s\n", (int)pEntry->uNameLength, pPack->pNames + pEntry->uNameOffset);
+        SafeFree(pBuffer);
+        return false;
+    }
+    pBuffer[pEntry->u64Size] = 0;
+
+    *ppData = pBuffer;
+    *pcbSize = pEntry->u64Size;
+    *ppOwnedBuffer = pBuffer;
+    return true;
+}
+
+_Check_return_opt_
+bool Pack_Close(
+    _Inout_ _Pre_valid_ _Post_invalid_ Pack* pPack
+) {
+    if (!pPack) {
+        return false;
+    }
+
+    File_Unmap(pPack->pView);
+    SafeFree(pPack);
+    return true;
+}
+
+_Check_return_opt_
+bool Pack_Mount(
+    _In_z_ PCSTR pszFilename
+) {
+    if (s_nMountedPacks >= PACK_MAX_MOUNTS) {
+        printf("Too many mounted packs, ignoring %s\n", pszFilename);
+        return false;
+    }
+
+    Pack* pPack = Pack_Open(pszFilename);
+    if (!pPack) {
+        return false;
+    }
+
+    s_arrMountedPacks[s_nMountedPacks++] = pPack;
+    return true;
+}
+
+void Pack_UnmountAll(
+    void
+) {
+    for (INT i = 0; i < s_nMountedPacks; i++) {
+        Pack_Close(s_arrMountedPacks[i]);
+        s_arrMountedPacks[i] = NULL;
+    }
+    s_nMountedPacks = 0;
+}
+
+_Check_return_ _Success_(return)
+bool Pack_Lookup(
+    _In_z_ PCSTR pszPath,
+    _Out_  const BYTE** ppData,
+    _Out_  ULONG* pcbSize,
+    _Out_  BYTE** ppOwnedBuffer
+) {
+    for (INT i = s_nMountedPacks - 1; i >= 0; i--) {
+        const PackEntry* pEntry = Pack_Find(s_arrMountedPacks[i], pszPath);
+        if (pEntry) {
+            return Pack_Read(s_arrMountedPacks[i], pEntry, ppData, pcbSize, ppOwnedBuffer);
+        }
+    }
+    return false;
+}
+
+_Check_return_
+bool Pack_Contains(
+    _In_z_ PCSTR pszPath
+) {
+    for (INT i = s_nMountedPacks - 1; i >= 0; i--) {
+        if (Pack_Find(s_arrMountedPacks[i], pszPath)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Pack_SetLooseFilesFirst(
+    _In_ const bool bEnabled
+) {
+    s_bLooseFilesFirst = bEnabled;
+}
+
+_Check_return_
+bool Pack_GetLooseFilesFirst(
+    void
+) {
+    return s_bLooseFilesFirst;
+}
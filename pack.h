@@ -0,0 +1,187 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include "utils.h"
+
+typedef struct _FileView FileView;
+
+#define PACK_MAGIC 0x4B415053u // << "SPAK" in little-endian
+#define PACK_VERSION 2
+#define PACK_ALIGNMENT 4096    // << Entry data starts on page boundaries
+#define PACK_MAX_PATH 260
+#define PACK_MAX_MOUNTS 8
+#define PACK_BLOCK_SIZE (64 * 1024) // << Uncompressed size of one compressed block
+#define PACK_MAX_DECOMPRESS_THREADS 4
+#define PACK_PARALLEL_THRESHOLD (4 * PACK_BLOCK_SIZE) // << Smaller entries are decompressed on the calling thread
+
+#define PACK_ENTRY_COMPRESSED 0x1u
+
+/*
+ * On-disk layout, all values little-endian:
+ *
+ *   PackHeader                          at offset 0
+ *   entry data                          each entry at a multiple of PACK_ALIGNMENT
+ *   PackEntry[nEntries]                 at u64DirectoryOffset, sorted by name
+ *   names                               at u64NamesOffset, not zero-terminated
+ *
+ * Compressed entries (PACK_ENTRY_COMPRESSED) are split into independent LZ4 blocks so several threads can
+ * decompress one entry at once:
+ *
+ *   PackBlockHeader
+ *   UINT arrBlockOffsets[nBlocks + 1]   block i spans [offset i, offset i + 1) after the offset table
+ *   block data                          a block whose stored size equals its raw size is stored uncompressed
+ */
+
+typedef struct _PackHeader {
+    UINT uMagic;
+    UINT uVersion;
+    UINT nEntries;
+    UINT uReserved;
+    UINT64 u64DirectoryOffset;
+    UINT64 u64NamesOffset;
+} PackHeader;
+
+typedef struct _PackEntry {
+    UINT64 u64Offset;      // << Offset of the entry data from the start of the pack
+    UINT64 u64Size;        // << Size of the entry data in bytes, after decompression
+    UINT64 u64StoredSize;  // << Size of the entry data as stored in the pack
+    UINT uNameOffset;      // << Offset of the name in the name table
+    UINT uNameLength;      // << Length of the name in bytes
+    UINT uFlags;           // << PACK_ENTRY_* flags
+    UINT uReserved;
+} PackEntry;
+
+typedef struct _PackBlockHeader {
+    UINT nBlocks;
+    UINT uBlockSize;  // << Uncompressed size of every block except possibly the last
+} PackBlockHeader;
+
+typedef struct _Pack {
+    FileView* pView;
+    const PackHeader* pHeader;
+    const PackEntry* arrEntries;
+    const char* pNames;
+} Pack;
+
+/**
+ * @brief Opens a pack archive.
+ *
+ * The archive is mapped into memory, so the directory and entries are read from the mapping without copying.
+ *
+ * @param pszFilename Path to the pack file.
+ * @return A pointer to the opened `Pack`, or `NULL` if the file is missing or not a valid pack.
+ */
+_Check_return_ _Ret_maybenull_ Pack* Pack_Open(
+    _In_z_ PCSTR pszFilename
+    );
+
+/**
+ * @brief Looks up an entry in a single pack.
+ *
+ * The directory is sorted, so the lookup is a binary search. Backslashes in `pszPath` are treated as forward
+ * slashes and a leading `./` is ignored.
+ *
+ * @param pPack   Pointer to the `Pack` to search.
+ * @param pszPath Relative asset path, e.g. `"gui/gui_bg.png"`.
+ * @return A pointer to the directory entry, or `NULL` if the pack does not contain `pszPath`.
+ */
+_Check_return_ _Ret_maybenull_ const PackEntry* Pack_Find(
+    _In_   const Pack* pPack,
+    _In_z_ PCSTR pszPath
+    );
+
+/**
+ * @brief Gets the plain bytes of an entry.
+ *
+ * Uncompressed entries are returned in place from the pack mapping. Compressed entries are decompressed into
+ * a new buffer, using up to `PACK_MAX_DECOMPRESS_THREADS` threads for entries larger than
+ * `PACK_PARALLEL_THRESHOLD`.
+ *
+ * @param pPack          Pointer to the `Pack` that owns `pEntry`.
+ * @param pEntry         Entry returned by `Pack_Find`.
+ * @param ppData         Receives a pointer to the plain entry data.
+ * @param pcbSize        Receives the size of the plain entry data.
+ * @param ppOwnedBuffer  Receives the buffer the caller must `free` once done with the data, or `NULL` if the
+ *                       data points into the pack mapping.
+ * @return `true` on success, `false` if the entry is corrupt or memory ran out.
+ */
+_Check_return_ _Success_(return) bool Pack_Read(
+    _In_  const Pack* pPack,
+    _In_  const PackEntry* pEntry,
+    _Out_ const BYTE** ppData,
+    _Out_ ULONG* pcbSize,
+    _Out_ BYTE** ppOwnedBuffer
+    );
+
+/**
+ * @brief Closes a pack and unmaps it.
+ *
+ * All pointers obtained from `Pack_Find` and in-place data from `Pack_Read` become invalid.
+ *
+ * @param pPack Pointer to the `Pack` to close.
+ * @return `true` if the pack was closed, `false` if `pPack` was `NULL`.
+ */
+_Check_return_opt_ bool Pack_Close(
+    _Inout_ _Pre_valid_ _Post_invalid_ Pack* pPack
+    );
+
+/**
+ * @brief Opens a pack and adds it to the set of archives searched by `File_Open`, `File_Map` and the loaders.
+ *
+ * Packs mounted later take precedence over packs mounted earlier, so patch archives can override base content.
+ *
+ * @param pszFilename Path to the pack file.
+ * @return `true` if the pack was mounted.
+ */
+_Check_return_opt_ bool Pack_Mount(
+    _In_z_ PCSTR pszFilename
+    );
+
+/**
+ * @brief Closes all mounted packs.
+ */
+void Pack_UnmountAll(
+    void
+    );
+
+/**
+ * @brief Looks up an entry in all mounted packs and gets its plain bytes.
+ *
+ * @param pszPath        Relative asset path.
+ * @param ppData         Receives a pointer to the plain entry data.
+ * @param pcbSize        Receives the size of the plain entry data.
+ * @param ppOwnedBuffer  Receives the buffer to `free` once done, see `Pack_Read`.
+ * @return `true` if any mounted pack contains the entry and it could be read.
+ */
+_Check_return_ _Success_(return) bool Pack_Lookup(
+    _In_z_ PCSTR pszPath,
+    _Out_  const BYTE** ppData,
+    _Out_  ULONG* pcbSize,
+    _Out_  BYTE** ppOwnedBuffer
+    );
+
+/**
+ * @brief Checks whether any mounted pack contains an entry, without reading it.
+ */
+_Check_return_ bool Pack_Contains(
+    _In_z_ PCSTR pszPath
+    );
+
+/**
+ * @brief Controls whether loose files on disk win over pack entries.
+ *
+ * When enabled, a file that exists on disk is used even if a mounted pack contains the same path, so artists
+ * can iterate on single assets without rebuilding the pack. When disabled, packs are searched first and the
+ * disk is only touched for paths that no pack contains. Enabled by default in debug builds.
+ *
+ * @param bEnabled `true` to prefer loose files.
+ */
+void Pack_SetLooseFilesFirst(
+    _In_ bool bEnabled
+    );
+
+_Check_return_ bool Pack_GetLooseFilesFirst(
+    void
+    );
+
+#endif //PACK_H
@@ -0,0 +1,256 @@
+#include <string.h>
+#include <SFML/System.h>
+
+#include "utils.h"
+#include "terrain.h"
+#include "pathfinder.h"
+#include "path-hierarchy.h"
+
+/*
+ * Times random A* queries on a generated map, then the same queries through the path hierarchy.
+ *
+ *   path-bench [width] [height] [queries] [seed]
+ *
+ * The map mixes plain, rough and impassable tiles with long walls that have gaps, so most queries have to
+ * route around obstacles. The generator is seeded, so runs with the same arguments are comparable.
+ *
+ * Hierarchical queries are timed together with refining the first BENCH_REFINE_STEPS tiles, which is what a
+ * unit walking the path this turn needs.
+ */
+
+#define BENCH_DEFAULT_SIZE 256
+#define BENCH_DEFAULT_QUERIES 2000
+#define BENCH_MAX_PATH_LENGTH 8192
+#define BENCH_MAX_WAYPOINTS 1024
+#define BENCH_REFINE_STEPS 16
+#define BENCH_TERRAIN_EDITS 64
+
+static UINT s_uRandomState;
+
+_Check_return_
+static UINT NextRandom(
+    void
+) {
+    // xorshift32, so every platform generates the same map
+    s_uRandomState ^= s_uRandomState << 13;
+    s_uRandomState ^= s_uRandomState >> 17;
+    s_uRandomState ^= s_uRandomState << 5;
+    return s_uRandomState;
+}
+
+static void GenerateTerrain(
+    _Inout_ TerrainMap* pTerrain
+) {
+    for (INT i = 0; i < pTerrain->nWidth * pTerrain->nHeight; i++) {
+        const UINT uRoll = NextRandom() % 100;
+        pTerrain->arrCosts[i] = uRoll < 70 ? 1 : uRoll < 85 ? 2 : uRoll < 92 ? 3 : TERRAIN_COST_IMPASSABLE;
+    }
+
+    // Vertical walls every 16 columns with a gap every 24 rows
+    for (INT x = 8; x < pTerrain->nWidth; x += 16) {
+        const INT nOffset = (INT)(NextRandom() % 24);
+        for (INT y = 0; y < pTerrain->nHeight; y++) {
+            if ((y + nOffset) % 24 >= 2) {
+                pTerrain->arrCosts[y * pTerrain->nWidth + x] = TERRAIN_COST_IMPASSABLE;
+            }
+        }
+    }
+}
+
+_Check_return_
+static POINT RandomOpenTile(
+    _In_ const TerrainMap* pTerrain
+) {
+    for (;;) {
+        const POINT ptTile = {
+            (INT)(NextRandom() % (UINT)pTerrain->nWidth),
+            (INT)(NextRandom() % (UINT)pTerrain->nHeight)
+        };
+        if (TerrainMap_GetCost(pTerrain, ptTile) != TERRAIN_COST_IMPASSABLE) {
+            return ptTile;
+        }
+    }
+}
+
+static int CompareTimes(
+    const void* pLeft,
+    const void* pRight
+) {
+    const INT64 lLeft = *(const INT64*)pLeft;
+    const INT64 lRight = *(const INT64*)pRight;
+    return (lLeft > lRight) - (lLeft < lRight);
+}
+
+static void PrintTimes(
+    _Inout_updates_(nQueries) INT64* arrTimes,
+    _In_                      const INT nQueries,
+    _In_                      const INT64 lTotalTime
+) {
+    qsort(arrTimes, nQueries, sizeof(INT64), CompareTimes);
+
+    printf("avg time     %.1f us\n", (DOUBLE)lTotalTime / nQueries);
+    printf("p50 / p99    %lld / %lld us\n",
+        (long long)arrTimes[nQueries / 2],
+        (long long)arrTimes[(INT)((INT64)nQueries * 99 / 100)]);
+    printf("max          %lld us\n", (long long)arrTimes[nQueries - 1]);
+    printf("throughput   %.0f queries/s\n", lTotalTime > 0 ? nQueries * 1000000.0 / (DOUBLE)lTotalTime : 0.0);
+}
+
+int main(int argc, char** argv) {
+    const INT nWidth = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_SIZE;
+    const INT nHeight = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_SIZE;
+    const INT nQueries = argc > 3 ? atoi(argv[3]) : BENCH_DEFAULT_QUERIES;
+    s_uRandomState = argc > 4 ? (UINT)strtoul(argv[4], NULL, 10) : 0x2545F491u;
+    if (s_uRandomState == 0) {
+        s_uRandomState = 1;
+    }
+
+    if (nWidth <= 0 || nHeight <= 0 || nQueries <= 0) {
+        printf("Usage: %s [width] [height] [queries] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    TerrainMap* pTerrain = TerrainMap_Create(nWidth, nHeight);
+    PathFinder* pFinder = PathFinder_Create(nWidth, nHeight);
+    POINT* arrPath = malloc(BENCH_MAX_PATH_LENGTH * sizeof(POINT));
+    POINT* arrWaypoints = malloc(BENCH_MAX_WAYPOINTS * sizeof(POINT));
+    POINT* arrEndpoints = malloc(nQueries * 2 * sizeof(POINT));
+    INT* arrOptimalCosts = malloc(nQueries * sizeof(INT));
+    INT64* arrTimes = malloc(nQueries * sizeof(INT64));
+    if (!pTerrain || !pFinder || !arrPath || !arrWaypoints || !arrEndpoints || !arrOptimalCosts || !arrTimes) {
+        printf("Failed to allocate benchmark state\n");
+        return 1;
+    }
+
+    GenerateTerrain(pTerrain);
+    for (INT i = 0; i < nQueries * 2; i++) {
+        arrEndpoints[i] = RandomOpenTile(pTerrain);
+    }
+
+    INT nFound = 0;
+    INT64 lTotalSteps = 0;
+    INT64 lTotalExpanded = 0;
+    INT64 lTotalTime = 0;
+    sfClock* pClock = sfClock_create();
+
+    for (INT i = 0; i < nQueries; i++) {
+        const POINT ptStart = arrEndpoints[i * 2];
+        const POINT ptGoal = arrEndpoints[i * 2 + 1];
+
+        sfClock_restart(pClock);
+        const INT nLength = PathFinder_FindPath(
+            pFinder,
+            pTerrain,
+            NULL,
+            ptStart,
+            ptGoal,
+            arrPath,
+            BENCH_MAX_PATH_LENGTH
+        );
+        arrTimes[i] = sfTime_asMicroseconds(sfClock_getElapsedTime(pClock));
+
+        lTotalTime += arrTimes[i];
+        lTotalExpanded += pFinder->nExpanded;
+        arrOptimalCosts[i] = -1;
+        if (nLength >= 0) {
+            nFound++;
+            lTotalSteps += nLength;
+            arrOptimalCosts[i] = 0;
+            for (INT j = 0; j < nLength; j++) {
+                arrOptimalCosts[i] += TerrainMap_GetCost(pTerrain, arrPath[j]);
+            }
+        }
+    }
+
+    printf("map          %dx%d\n", nWidth, nHeight);
+    printf("queries      %d (%d with a path)\n", nQueries, nFound);
+    printf("\nA*\n");
+    printf("avg steps    %.1f\n", nFound ? (DOUBLE)lTotalSteps / nFound : 0.0);
+    printf("avg expanded %.1f tiles\n", (DOUBLE)lTotalExpanded / nQueries);
+    PrintTimes(arrTimes, nQueries, lTotalTime);
+
+    sfClock_restart(pClock);
+    PathHierarchy* pHierarchy = PathHierarchy_Create(pTerrain);
+    const INT64 lBuildTime = sfTime_asMicroseconds(sfClock_getElapsedTime(pClock));
+    if (!pHierarchy) {
+        return 1;
+    }
+
+    nFound = 0;
+    lTotalSteps = 0;
+    lTotalExpanded = 0;
+    lTotalTime = 0;
+    INT nCompared = 0;
+    DOUBLE fTotalRatio = 0.0;
+
+    for (INT i = 0; i < nQueries; i++) {
+        const POINT ptStart = arrEndpoints[i * 2];
+        const POINT ptGoal = arrEndpoints[i * 2 + 1];
+        INT nWaypoints = 0;
+
+        sfClock_restart(pClock);
+        const INT nCost = PathHierarchy_FindPath(
+            pHierarchy,
+            pTerrain,
+            ptStart,
+            ptGoal,
+            arrWaypoints,
+            BENCH_MAX_WAYPOINTS,
+            &nWaypoints
+        );
+        if (nCost > 0) {
+            lTotalSteps += PathHierarchy_RefinePath(
+                pHierarchy,
+                pTerrain,
+                ptStart,
+                arrWaypoints,
+                nWaypoints,
+                arrPath,
+                BENCH_REFINE_STEPS
+            );
+        }
+        arrTimes[i] = sfTime_asMicroseconds(sfClock_getElapsedTime(pClock));
+
+        lTotalTime += arrTimes[i];
+        lTotalExpanded += pHierarchy->nExpanded;
+        if (nCost >= 0) {
+            nFound++;
+        }
+        if (nCost > 0 && arrOptimalCosts[i] > 0) {
+            nCompared++;
+            fTotalRatio += (DOUBLE)nCost / arrOptimalCosts[i];
+        }
+    }
+
+    printf("\nHPA* (%dx%d clusters)\n", HPA_CLUSTER_SIZE, HPA_CLUSTER_SIZE);
+    printf("build        %.1f ms\n", lBuildTime / 1000.0);
+    printf("found        %d\n", nFound);
+    printf("avg cost     %.3fx optimal\n", nCompared ? fTotalRatio / nCompared : 0.0);
+    printf("avg refined  %.1f steps\n", nFound ? (DOUBLE)lTotalSteps / nFound : 0.0);
+    printf("avg expanded %.1f nodes\n", (DOUBLE)lTotalExpanded / nQueries);
+    PrintTimes(arrTimes, nQueries, lTotalTime);
+
+    // Scattered single-tile edits, as buildings going up or bridges being destroyed during a turn
+    sfClock_restart(pClock);
+    INT nRebuilt = 0;
+    for (INT i = 0; i < BENCH_TERRAIN_EDITS; i++) {
+        const POINT ptTile = RandomOpenTile(pTerrain);
+        TerrainMap_SetCost(pTerrain, ptTile, TERRAIN_COST_IMPASSABLE);
+        PathHierarchy_MarkTileChanged(pHierarchy, ptTile);
+        nRebuilt += PathHierarchy_Update(pHierarchy, pTerrain);
+    }
+    const INT64 lUpdateTime = sfTime_asMicroseconds(sfClock_getElapsedTime(pClock));
+    printf("update       %.1f us per edit (%.1f clusters)\n",
+        (DOUBLE)lUpdateTime / BENCH_TERRAIN_EDITS, (DOUBLE)nRebuilt / BENCH_TERRAIN_EDITS);
+
+    sfClock_destroy(pClock);
+    PathHierarchy_Destroy(pHierarchy);
+    SafeFree(arrTimes);
+    SafeFree(arrOptimalCosts);
+    SafeFree(arrEndpoints);
+    SafeFree(arrWaypoints);
+    SafeFree(arrPath);
+    PathFinder_Destroy(pFinder);
+    TerrainMap_Destroy(pTerrain);
+    return 0;
+}
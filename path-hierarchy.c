@@ -0,0 +1,756 @@
+#include "path-hierarchy.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "terrain.h"
+
+#define HPA_INFINITE INT_MAX
+
+_Check_return_
+static inline INT ClusterOfTile(
+    _In_ const PathHierarchy* pHierarchy,
+    _In_ const INT iTile
+) {
+    const INT x = iTile % pHierarchy->nWidth;
+    const INT y = iTile / pHierarchy->nWidth;
+    return (y / HPA_CLUSTER_SIZE) * pHierarchy->nClustersX + x / HPA_CLUSTER_SIZE;
+}
+
+_Check_return_
+static inline INT LocalIndex(
+    _In_ const PathHierarchy* pHierarchy,
+    _In_ const HpaCluster* pCluster,
+    _In_ const INT iTile
+) {
+    return (iTile / pHierarchy->nWidth - pCluster->y) * HPA_CLUSTER_SIZE + iTile % pHierarchy->nWidth - pCluster->x;
+}
+
+_Check_return_
+static inline INT TileOfLocalIndex(
+    _In_ const PathHierarchy* pHierarchy,
+    _In_ const HpaCluster* pCluster,
+    _In_ const INT iLocal
+) {
+    return (pCluster->y + iLocal / HPA_CLUSTER_SIZE) * pHierarchy->nWidth + pCluster->x + iLocal % HPA_CLUSTER_SIZE;
+}
+
+static void MarkClusterDirty(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const INT cx,
+    _In_    const INT cy
+) {
+    if (cx < 0 || cy < 0 || cx >= pHierarchy->nClustersX || cy >= pHierarchy->nClustersY) {
+        return;
+    }
+    pHierarchy->arrClusters[cy * pHierarchy->nClustersX + cx].bDirty = true;
+    pHierarchy->bHasDirty = true;
+}
+
+static void MarkAllDirty(
+    _Inout_ PathHierarchy* pHierarchy
+) {
+    for (INT i = 0; i < pHierarchy->nClustersX * pHierarchy->nClustersY; i++) {
+        pHierarchy->arrClusters[i].bDirty = true;
+    }
+    pHierarchy->bHasDirty = true;
+}
+
+_Check_return_ _Ret_maybenull_
+PathHierarchy* PathHierarchy_Create(
+    _In_ const TerrainMap* pTerrain
+) {
+    PathHierarchy* pHierarchy = calloc(1, sizeof(PathHierarchy));
+    if (!pHierarchy) {
+        printf("Failed to allocate memory for PathHierarchy\n");
+        return NULL;
+    }
+
+    pHierarchy->nWidth = pTerrain->nWidth;
+    pHierarchy->nHeight = pTerrain->nHeight;
+    pHierarchy->nClustersX = (pTerrain->nWidth + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+    pHierarchy->nClustersY = (pTerrain->nHeight + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+
+    const INT nClusters = pHierarchy->nClustersX * pHierarchy->nClustersY;
+    const size_t nTiles = (size_t)pTerrain->nWidth * pTerrain->nHeight;
+
+    // Two extra ids for the start and goal of a query
+    pHierarchy->nNodeIds = nClusters * HPA_MAX_CLUSTER_NODES + 2;
+
+    pHierarchy->arrClusters = calloc(nClusters, sizeof(HpaCluster));
+    pHierarchy->arrTileNodes = malloc(nTiles * sizeof(INT));
+    pHierarchy->arrGenerations = calloc(pHierarchy->nNodeIds, sizeof(UINT));
+    pHierarchy->arrGScores = malloc(pHierarchy->nNodeIds * sizeof(INT));
+    pHierarchy->arrParents = malloc(pHierarchy->nNodeIds * sizeof(INT));
+    pHierarchy->arrHeapIndex = malloc(pHierarchy->nNodeIds * sizeof(INT));
+    pHierarchy->arrHeap = malloc(pHierarchy->nNodeIds * sizeof(HpaHeapNode));
+    if (!pHierarchy->arrClusters || !pHierarchy->arrTileNodes || !pHierarchy->arrGenerations ||
+        !pHierarchy->arrGScores || !pHierarchy->arrParents || !pHierarchy->arrHeapIndex || !pHierarchy->arrHeap) {
+        printf("Failed to allocate memory for path hierarchy arrays\n");
+        PathHierarchy_Destroy(pHierarchy);
+        return NULL;
+    }
+
+    memset(pHierarchy->arrTileNodes, 0xFF, nTiles * sizeof(INT));
+
+    for (INT cy = 0; cy < pHierarchy->nClustersY; cy++) {
+        for (INT cx = 0; cx < pHierarchy->nClustersX; cx++) {
+            HpaCluster* pCluster = &pHierarchy->arrClusters[cy * pHierarchy->nClustersX + cx];
+            pCluster->x = cx * HPA_CLUSTER_SIZE;
+            pCluster->y = cy * HPA_CLUSTER_SIZE;
+            pCluster->nWidth = pTerrain->nWidth - pCluster->x < HPA_CLUSTER_SIZE
+                ? pTerrain->nWidth - pCluster->x
+                : HPA_CLUSTER_SIZE;
+            pCluster->nHeight = pTerrain->nHeight - pCluster->y < HPA_CLUSTER_SIZE
+                ? pTerrain->nHeight - pCluster->y
+                : HPA_CLUSTER_SIZE;
+        }
+    }
+
+    MarkAllDirty(pHierarchy);
+    PathHierarchy_Update(pHierarchy, pTerrain);
+    return pHierarchy;
+}
+
+static void LocalHeapPush(
+    _Inout_ PathHierarchy* pHierarchy,
+    _Inout_ INT* pnCount,
+    _In_    const HpaHeapNode node
+) {
+    HpaHeapNode* arrHeap = pHierarchy->arrLocalHeap;
+    INT iPosition = (*pnCount)++;
+    while (iPosition > 0) {
+        const INT iParent = (iPosition - 1) / 2;
+        if (arrHeap[iParent].nKey <= node.nKey) {
+            break;
+        }
+        arrHeap[iPosition] = arrHeap[iParent];
+        iPosition = iParent;
+    }
+    arrHeap[iPosition] = node;
+}
+
+_Check_return_
+static HpaHeapNode LocalHeapPop(
+    _Inout_ PathHierarchy* pHierarchy,
+    _Inout_ INT* pnCount
+) {
+    HpaHeapNode* arrHeap = pHierarchy->arrLocalHeap;
+    const HpaHeapNode top = arrHeap[0];
+    const HpaHeapNode node = arrHeap[--(*pnCount)];
+
+    INT iPosition = 0;
+    for (;;) {
+        INT iChild = iPosition * 2 + 1;
+        if (iChild >= *pnCount) {
+            break;
+        }
+        if (iChild + 1 < *pnCount && arrHeap[iChild + 1].nKey < arrHeap[iChild].nKey) {
+            iChild++;
+        }
+        if (node.nKey <= arrHeap[iChild].nKey) {
+            break;
+        }
+        arrHeap[iPosition] = arrHeap[iChild];
+        iPosition = iChild;
+    }
+    arrHeap[iPosition] = node;
+    return top;
+}
+
+/*
+ * Dijkstra over the tiles of one cluster, leaving the costs in arrLocalCosts by local index. A forward search
+ * gives the cost from the source to every tile; a reverse search gives the cost from every tile to the source.
+ * The search stops early once iStopTile is settled, if it is not -1.
+ */
+static void SearchCluster(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const TerrainMap* pTerrain,
+    _In_    const HpaCluster* pCluster,
+    _In_    const INT iSourceTile,
+    _In_    const bool bReverse,
+    _In_    const INT iStopTile
+) {
+    INT* arrCosts = pHierarchy->arrLocalCosts;
+    INT* arrParents = pHierarchy->arrLocalParents;
+    const BYTE* arrTerrain = pTerrain->arrCosts;
+
+    for (INT i = 0; i < HPA_CLUSTER_TILES; i++) {
+        arrCosts[i] = HPA_INFINITE;
+    }
+
+    const INT iSource = LocalIndex(pHierarchy, pCluster, iSourceTile);
+    const INT iStop = iStopTile >= 0 ? LocalIndex(pHierarchy, pCluster, iStopTile) : -1;
+    arrCosts[iSource] = 0;
+    arrParents[iSource] = -1;
+
+    // Lazy deletion: stale entries are skipped on pop, so at most four pushes per settled tile
+    INT nCount = 0;
+    LocalHeapPush(pHierarchy, &nCount, (HpaHeapNode) { 0, iSource });
+
+    while (nCount > 0) {
+        const HpaHeapNode top = LocalHeapPop(pHierarchy, &nCount);
+        const INT iLocal = top.iNode;
+        if (top.nKey != arrCosts[iLocal]) {
+            continue;
+        }
+        if (iLocal == iStop) {
+            break;
+        }
+
+        const INT lx = iLocal % HPA_CLUSTER_SIZE;
+        const INT ly = iLocal / HPA_CLUSTER_SIZE;
+        const INT arrNeighbours[4] = {
+            lx > 0 ? iLocal - 1 : -1,
+            lx < pCluster->nWidth - 1 ? iLocal + 1 : -1,
+            ly > 0 ? iLocal - HPA_CLUSTER_SIZE : -1,
+            ly < pCluster->nHeight - 1 ? iLocal + HPA_CLUSTER_SIZE : -1
+        };
+
+        const INT nCurrentCost = arrTerrain[TileOfLocalIndex(pHierarchy, pCluster, iLocal)];
+        for (INT i = 0; i < 4; i++) {
+            const INT iNeighbour = arrNeighbours[i];
+            if (iNeighbour < 0) {
+                continue;
+            }
+            const INT nEnterCost = arrTerrain[TileOfLocalIndex(pHierarchy, pCluster, iNeighbour)];
+            if (nEnterCost == TERRAIN_COST_IMPASSABLE) {
+                continue;
+            }
+
+            // Walking backwards, the step from the neighbour onto this tile pays for this tile
+            const INT nNewCost = top.nKey + (bReverse ? nCurrentCost : nEnterCost);
+            if (nNewCost >= arrCosts[iNeighbour]) {
+                continue;
+            }
+            arrCosts[iNeighbour] = nNewCost;
+            arrParents[iNeighbour] = iLocal;
+            LocalHeapPush(pHierarchy, &nCount, (HpaHeapNode) { nNewCost, iNeighbour });
+        }
+    }
+}
+
+static void AddEntrance(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const INT iCluster,
+    _In_    const INT iTile,
+    _In_    const INT iOtherTile
+) {
+    HpaCluster* pCluster = &pHierarchy->arrClusters[iCluster];
+
+    // A corner tile can be an entrance on two borders; it stays one node with two links
+    INT iNode = pHierarchy->arrTileNodes[iTile];
+    if (iNode < 0) {
+        if (pCluster->nNodes == HPA_MAX_CLUSTER_NODES) {
+            printf("Too many entrances in cluster %d\n", iCluster);
+            return;
+        }
+        const INT i = pCluster->nNodes++;
+        pCluster->arrNodeTiles[i] = iTile;
+        pCluster->arrInterTiles[i][0] = -1;
+        pCluster->arrInterTiles[i][1] = -1;
+        iNode = iCluster * HPA_MAX_CLUSTER_NODES + i;
+        pHierarchy->arrTileNodes[iTile] = iNode;
+    }
+
+    INT* arrInter = pCluster->arrInterTiles[iNode % HPA_MAX_CLUSTER_NODES];
+    arrInter[arrInter[0] < 0 ? 0 : 1] = iOtherTile;
+}
+
+/*
+ * Places the entrances on the border between a cluster and its right (bVertical) or lower neighbour. Every
+ * maximal run of tiles that is open on both sides gets one entrance in its middle, or one at each end if it is
+ * at least HPA_LONG_ENTRANCE wide. Runs are separated by at least one closed tile, so a border of 16 tiles has
+ * at most 8 entrances. Only the sides that are being rebuilt receive nodes.
+ */
+static void AddBorderEntrances(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const TerrainMap* pTerrain,
+    _In_    const INT iCluster,
+    _In_    const bool bVertical
+) {
+    const HpaCluster* pCluster = &pHierarchy->arrClusters[iCluster];
+    const INT iOtherCluster = iCluster + (bVertical ? 1 : pHierarchy->nClustersX);
+    const bool bAddNear = pCluster->bRebuild;
+    const bool bAddFar = pHierarchy->arrClusters[iOtherCluster].bRebuild;
+
+    const INT nWidth = pHierarchy->nWidth;
+    const INT nLength = bVertical ? pCluster->nHeight : pCluster->nWidth;
+    const INT iFirstTile = bVertical
+        ? pCluster->y * nWidth + pCluster->x + pCluster->nWidth - 1
+        : (pCluster->y + pCluster->nHeight - 1) * nWidth + pCluster->x;
+    const INT nAlong = bVertical ? nWidth : 1;
+    const INT nAcross = bVertical ? 1 : nWidth;
+    const BYTE* arrTerrain = pTerrain->arrCosts;
+
+    INT iRunStart = -1;
+    for (INT i = 0; i <= nLength; i++) {
+        const INT iTile = iFirstTile + i * nAlong;
+        const bool bOpen = i < nLength &&
+            arrTerrain[iTile] != TERRAIN_COST_IMPASSABLE &&
+            arrTerrain[iTile + nAcross] != TERRAIN_COST_IMPASSABLE;
+
+        if (bOpen) {
+            if (iRunStart < 0) {
+                iRunStart = i;
+            }
+            continue;
+        }
+        if (iRunStart < 0) {
+            continue;
+        }
+
+        const INT nRun = i - iRunStart;
+        INT arrPositions[2] = { iRunStart + nRun / 2, -1 };
+        if (nRun >= HPA_LONG_ENTRANCE) {
+            arrPositions[0] = iRunStart;
+            arrPositions[1] = i - 1;
+        }
+
+        for (INT j = 0; j < 2 && arrPositions[j] >= 0; j++) {
+            const INT iNear = iFirstTile + arrPositions[j] * nAlong;
+            const INT iFar = iNear + nAcross;
+            if (bAddNear) {
+                AddEntrance(pHierarchy, iCluster, iNear, iFar);
+            }
+            if (bAddFar) {
+                AddEntrance(pHierarchy, iOtherCluster, iFar, iNear);
+            }
+        }
+        iRunStart = -1;
+    }
+}
+
+static void ComputeIntraCosts(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const TerrainMap* pTerrain,
+    _In_    const INT iCluster
+) {
+    HpaCluster* pCluster = &pHierarchy->arrClusters[iCluster];
+
+    for (INT i = 0; i < pCluster->nNodes; i++) {
+        SearchCluster(pHierarchy, pTerrain, pCluster, pCluster->arrNodeTiles[i], false, -1);
+
+        // A cluster holds at most 255 steps of cost 254, so every cost fits below HPA_UNREACHABLE
+        for (INT j = 0; j < pCluster->nNodes; j++) {
+            const INT nCost = pHierarchy->arrLocalCosts[LocalIndex(pHierarchy, pCluster, pCluster->arrNodeTiles[j])];
+            pCluster->arrIntraCosts[i * HPA_MAX_CLUSTER_NODES + j] =
+                nCost == HPA_INFINITE ? HPA_UNREACHABLE : (UINT16)nCost;
+        }
+    }
+}
+
+void PathHierarchy_MarkTileChanged(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pHierarchy->nWidth || ptTile.y >= pHierarchy->nHeight) {
+        return;
+    }
+
+    const INT cx = ptTile.x / HPA_CLUSTER_SIZE;
+    const INT cy = ptTile.y / HPA_CLUSTER_SIZE;
+    const INT lx = ptTile.x % HPA_CLUSTER_SIZE;
+    const INT ly = ptTile.y % HPA_CLUSTER_SIZE;
+    MarkClusterDirty(pHierarchy, cx, cy);
+
+    // A border tile also decides the entrances of the cluster on the other side
+    if (lx == 0) {
+        MarkClusterDirty(pHierarchy, cx - 1, cy);
+    } else if (lx == HPA_CLUSTER_SIZE - 1) {
+        MarkClusterDirty(pHierarchy, cx + 1, cy);
+    }
+    if (ly == 0) {
+        MarkClusterDirty(pHierarchy, cx, cy - 1);
+    } else if (ly == HPA_CLUSTER_SIZE - 1) {
+        MarkClusterDirty(pHierarchy, cx, cy + 1);
+    }
+}
+
+_Check_return_opt_
+INT PathHierarchy_Update(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const TerrainMap* pTerrain
+) {
+    if (pTerrain->nWidth != pHierarchy->nWidth || pTerrain->nHeight != pHierarchy->nHeight) {
+        printf("PathHierarchy is %dx%d but the terrain is %dx%d\n",
+            pHierarchy->nWidth, pHierarchy->nHeight, pTerrain->nWidth, pTerrain->nHeight);
+        return 0;
+    }
+
+    if (!pHierarchy->bHasDirty) {
+        if (pHierarchy->uTerrainVersion == pTerrain->uVersion) {
+            return 0;
+        }
+        MarkAllDirty(pHierarchy); // << Changed behind our back; nothing tells which clusters are stale
+    }
+
+    const INT nClustersX = pHierarchy->nClustersX;
+    const INT nClustersY = pHierarchy->nClustersY;
+    HpaCluster* arrClusters = pHierarchy->arrClusters;
+
+    // Neighbours of a dirty cluster share its entrances, so they are rebuilt too
+    for (INT cy = 0; cy < nClustersY; cy++) {
+        for (INT cx = 0; cx < nClustersX; cx++) {
+            const INT i = cy * nClustersX + cx;
+            arrClusters[i].bRebuild = arrClusters[i].bDirty ||
+                (cx > 0 && arrClusters[i - 1].bDirty) ||
+                (cx < nClustersX - 1 && arrClusters[i + 1].bDirty) ||
+                (cy > 0 && arrClusters[i - nClustersX].bDirty) ||
+                (cy < nClustersY - 1 && arrClusters[i + nClustersX].bDirty);
+        }
+    }
+
+    INT nRebuilt = 0;
+    for (INT i = 0; i < nClustersX * nClustersY; i++) {
+        HpaCluster* pCluster = &arrClusters[i];
+        if (!pCluster->bRebuild) {
+            continue;
+        }
+        for (INT j = 0; j < pCluster->nNodes; j++) {
+            pHierarchy->arrTileNodes[pCluster->arrNodeTiles[j]] = -1;
+        }
+        pCluster->nNodes = 0;
+        nRebuilt++;
+    }
+
+    // Each border is handled once, by the cluster on its left or top. A border between two kept clusters is
+    // skipped; their entrances there did not change.
+    for (INT cy = 0; cy < nClustersY; cy++) {
+        for (INT cx = 0; cx < nClustersX; cx++) {
+            const INT i = cy * nClustersX + cx;
+            if (cx < nClustersX - 1 && (arrClusters[i].bRebuild || arrClusters[i + 1].bRebuild)) {
+                AddBorderEntrances(pHierarchy, pTerrain, i, true);
+            }
+            if (cy < nClustersY - 1 && (arrClusters[i].bRebuild || arrClusters[i + nClustersX].bRebuild)) {
+                AddBorderEntrances(pHierarchy, pTerrain, i, false);
+            }
+        }
+    }
+
+    for (INT i = 0; i < nClustersX * nClustersY; i++) {
+        if (arrClusters[i].bRebuild) {
+            ComputeIntraCosts(pHierarchy, pTerrain, i);
+        }
+        arrClusters[i].bDirty = false;
+        arrClusters[i].bRebuild = false;
+    }
+
+    pHierarchy->bHasDirty = false;
+    pHierarchy->uTerrainVersion = pTerrain->uVersion;
+    return nRebuilt;
+}
+
+static void HeapSiftUp(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    INT iPosition
+) {
+    const HpaHeapNode node = pHierarchy->arrHeap[iPosition];
+    while (iPosition > 0) {
+        const INT iParent = (iPosition - 1) / 2;
+        if (pHierarchy->arrHeap[iParent].nKey <= node.nKey) {
+            break;
+        }
+        pHierarchy->arrHeap[iPosition] = pHierarchy->arrHeap[iParent];
+        pHierarchy->arrHeapIndex[pHierarchy->arrHeap[iPosition].iNode] = iPosition;
+        iPosition = iParent;
+    }
+    pHierarchy->arrHeap[iPosition] = node;
+    pHierarchy->arrHeapIndex[node.iNode] = iPosition;
+}
+
+_Check_return_
+static INT HeapPop(
+    _Inout_ PathHierarchy* pHierarchy
+) {
+    const INT iNode = pHierarchy->arrHeap[0].iNode;
+    pHierarchy->arrHeapIndex[iNode] = -1;
+
+    pHierarchy->nHeapCount--;
+    if (pHierarchy->nHeapCount == 0) {
+        return iNode;
+    }
+
+    const HpaHeapNode node = pHierarchy->arrHeap[pHierarchy->nHeapCount];
+    INT iPosition = 0;
+    for (;;) {
+        INT iChild = iPosition * 2 + 1;
+        if (iChild >= pHierarchy->nHeapCount) {
+            break;
+        }
+        if (iChild + 1 < pHierarchy->nHeapCount &&
+            pHierarchy->arrHeap[iChild + 1].nKey < pHierarchy->arrHeap[iChild].nKey) {
+            iChild++;
+        }
+        if (node.nKey <= pHierarchy->arrHeap[iChild].nKey) {
+            break;
+        }
+        pHierarchy->arrHeap[iPosition] = pHierarchy->arrHeap[iChild];
+        pHierarchy->arrHeapIndex[pHierarchy->arrHeap[iPosition].iNode] = iPosition;
+        iPosition = iChild;
+    }
+    pHierarchy->arrHeap[iPosition] = node;
+    pHierarchy->arrHeapIndex[node.iNode] = iPosition;
+    return iNode;
+}
+
+_Check_return_
+static inline INT Heuristic(
+    _In_ const PathHierarchy* pHierarchy,
+    _In_ const INT iTile,
+    _In_ const INT iGoalTile
+) {
+    const INT nWidth = pHierarchy->nWidth;
+    return abs(iTile % nWidth - iGoalTile % nWidth) + abs(iTile / nWidth - iGoalTile / nWidth);
+}
+
+_Check_return_
+static inline INT NodeTile(
+    _In_ const PathHierarchy* pHierarchy,
+    _In_ const INT iNode,
+    _In_ const INT iStartTile,
+    _In_ const INT iGoalTile
+) {
+    if (iNode == pHierarchy->nNodeIds - 2) {
+        return iStartTile;
+    }
+    if (iNode == pHierarchy->nNodeIds - 1) {
+        return iGoalTile;
+    }
+    return pHierarchy->arrClusters[iNode / HPA_MAX_CLUSTER_NODES].arrNodeTiles[iNode % HPA_MAX_CLUSTER_NODES];
+}
+
+static void Relax(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const INT iFrom,
+    _In_    const INT iTo,
+    _In_    const INT nNewCost,
+    _In_    const INT nHeuristic
+) {
+    const bool bSeen = pHierarchy->arrGenerations[iTo] == pHierarchy->uGeneration;
+    if (bSeen && (pHierarchy->arrHeapIndex[iTo] < 0 || pHierarchy->arrGScores[iTo] <= nNewCost)) {
+        return;
+    }
+
+    pHierarchy->arrGScores[iTo] = nNewCost;
+    pHierarchy->arrParents[iTo] = iFrom;
+    const HpaHeapNode node = { nNewCost + nHeuristic, iTo };
+
+    if (bSeen) {
+        const INT iPosition = pHierarchy->arrHeapIndex[iTo];
+        pHierarchy->arrHeap[iPosition] = node;
+        HeapSiftUp(pHierarchy, iPosition);
+    } else {
+        pHierarchy->arrGenerations[iTo] = pHierarchy->uGeneration;
+        pHierarchy->arrHeap[pHierarchy->nHeapCount] = node;
+        HeapSiftUp(pHierarchy, pHierarchy->nHeapCount++);
+    }
+}
+
+_Check_return_
+INT PathHierarchy_FindPath(
+    _Inout_                                       PathHierarchy* pHierarchy,
+    _In_                                          const TerrainMap* pTerrain,
+    _In_                                          const POINT ptStart,
+    _In_                                          const POINT ptGoal,
+    _Out_writes_to_(nMaxWaypoints, *pnWaypoints)  POINT* arrWaypoints,
+    _In_                                          const INT nMaxWaypoints,
+    _Out_                                         INT* pnWaypoints
+) {
+    *pnWaypoints = 0;
+    pHierarchy->nExpanded = 0;
+
+    if (pTerrain->nWidth != pHierarchy->nWidth || pTerrain->nHeight != pHierarchy->nHeight) {
+        printf("PathHierarchy is %dx%d but the terrain is %dx%d\n",
+            pHierarchy->nWidth, pHierarchy->nHeight, pTerrain->nWidth, pTerrain->nHeight);
+        return -1;
+    }
+
+    const INT nWidth = pHierarchy->nWidth;
+    if (ptStart.x < 0 || ptStart.y < 0 || ptStart.x >= nWidth || ptStart.y >= pHierarchy->nHeight ||
+        TerrainMap_GetCost(pTerrain, ptGoal) == TERRAIN_COST_IMPASSABLE) {
+        return -1;
+    }
+    if (Point_IsEqual(&ptStart, &ptGoal)) {
+        return 0;
+    }
+
+    const INT iStartTile = ptStart.y * nWidth + ptStart.x;
+    const INT iGoalTile = ptGoal.y * nWidth + ptGoal.x;
+    const INT iStartCluster = ClusterOfTile(pHierarchy, iStartTile);
+    const INT iGoalCluster = ClusterOfTile(pHierarchy, iGoalTile);
+    const HpaCluster* pStartCluster = &pHierarchy->arrClusters[iStartCluster];
+    const HpaCluster* pGoalCluster = &pHierarchy->arrClusters[iGoalCluster];
+    const INT iStartNode = pHierarchy->nNodeIds - 2;
+    const INT iGoalNode = pHierarchy->nNodeIds - 1;
+
+    // Link the start and goal into the graph with one tile search in each of their clusters
+    SearchCluster(pHierarchy, pTerrain, pStartCluster, iStartTile, false, -1);
+    for (INT i = 0; i < pStartCluster->nNodes; i++) {
+        pHierarchy->arrStartCosts[i] =
+            pHierarchy->arrLocalCosts[LocalIndex(pHierarchy, pStartCluster, pStartCluster->arrNodeTiles[i])];
+    }
+    const INT nDirectCost = iStartCluster == iGoalCluster
+        ? pHierarchy->arrLocalCosts[LocalIndex(pHierarchy, pStartCluster, iGoalTile)]
+        : HPA_INFINITE;
+
+    SearchCluster(pHierarchy, pTerrain, pGoalCluster, iGoalTile, true, -1);
+    for (INT i = 0; i < pGoalCluster->nNodes; i++) {
+        pHierarchy->arrGoalCosts[i] =
+            pHierarchy->arrLocalCosts[LocalIndex(pHierarchy, pGoalCluster, pGoalCluster->arrNodeTiles[i])];
+    }
+
+    pHierarchy->uGeneration++;
+    if (pHierarchy->uGeneration == 0) {
+        memset(pHierarchy->arrGenerations, 0, pHierarchy->nNodeIds * sizeof(UINT));
+        pHierarchy->uGeneration = 1;
+    }
+
+    pHierarchy->arrGenerations[iStartNode] = pHierarchy->uGeneration;
+    pHierarchy->arrGScores[iStartNode] = 0;
+    pHierarchy->arrParents[iStartNode] = -1;
+    pHierarchy->arrHeap[0] = (HpaHeapNode) { Heuristic(pHierarchy, iStartTile, iGoalTile), iStartNode };
+    pHierarchy->arrHeapIndex[iStartNode] = 0;
+    pHierarchy->nHeapCount = 1;
+
+    const BYTE* arrTerrain = pTerrain->arrCosts;
+    bool bFound = false;
+    while (pHierarchy->nHeapCount > 0) {
+        const INT iNode = HeapPop(pHierarchy);
+        pHierarchy->nExpanded++;
+        if (iNode == iGoalNode) {
+            bFound = true;
+            break;
+        }
+
+        const INT nGScore = pHierarchy->arrGScores[iNode];
+
+        if (iNode == iStartNode) {
+            for (INT i = 0; i < pStartCluster->nNodes; i++) {
+                if (pHierarchy->arrStartCosts[i] != HPA_INFINITE) {
+                    Relax(pHierarchy, iNode, iStartCluster * HPA_MAX_CLUSTER_NODES + i, pHierarchy->arrStartCosts[i],
+                        Heuristic(pHierarchy, pStartCluster->arrNodeTiles[i], iGoalTile));
+                }
+            }
+            if (nDirectCost != HPA_INFINITE) {
+                Relax(pHierarchy, iNode, iGoalNode, nDirectCost, 0);
+            }
+            continue;
+        }
+
+        const INT iCluster = iNode / HPA_MAX_CLUSTER_NODES;
+        const INT iIndex = iNode % HPA_MAX_CLUSTER_NODES;
+        const HpaCluster* pCluster = &pHierarchy->arrClusters[iCluster];
+        const UINT16* arrIntraCosts = &pCluster->arrIntraCosts[iIndex * HPA_MAX_CLUSTER_NODES];
+
+        for (INT i = 0; i < pCluster->nNodes; i++) {
+            if (i != iIndex && arrIntraCosts[i] != HPA_UNREACHABLE) {
+                Relax(pHierarchy, iNode, iCluster * HPA_MAX_CLUSTER_NODES + i, nGScore + arrIntraCosts[i],
+                    Heuristic(pHierarchy, pCluster->arrNodeTiles[i], iGoalTile));
+            }
+        }
+
+        for (INT i = 0; i < 2; i++) {
+            const INT iOtherTile = pCluster->arrInterTiles[iIndex][i];
+            if (iOtherTile >= 0) {
+                Relax(pHierarchy, iNode, pHierarchy->arrTileNodes[iOtherTile], nGScore + arrTerrain[iOtherTile],
+                    Heuristic(pHierarchy, iOtherTile, iGoalTile));
+            }
+        }
+
+        if (iCluster == iGoalCluster && pHierarchy->arrGoalCosts[iIndex] != HPA_INFINITE) {
+            Relax(pHierarchy, iNode, iGoalNode, nGScore + pHierarchy->arrGoalCosts[iIndex], 0);
+        }
+    }
+
+    if (!bFound) {
+        return -1;
+    }
+
+    INT nWaypoints = 0;
+    for (INT iNode = iGoalNode; iNode != iStartNode; iNode = pHierarchy->arrParents[iNode]) {
+        nWaypoints++;
+    }
+    if (nWaypoints > nMaxWaypoints) {
+        return -1;
+    }
+
+    INT i = nWaypoints;
+    for (INT iNode = iGoalNode; iNode != iStartNode; iNode = pHierarchy->arrParents[iNode]) {
+        const INT iTile = NodeTile(pHierarchy, iNode, iStartTile, iGoalTile);
+        arrWaypoints[--i] = (POINT) { iTile % nWidth, iTile / nWidth };
+    }
+
+    *pnWaypoints = nWaypoints;
+    return pHierarchy->arrGScores[iGoalNode];
+}
+
+_Check_return_
+INT PathHierarchy_RefinePath(
+    _Inout_                             PathHierarchy* pHierarchy,
+    _In_                                const TerrainMap* pTerrain,
+    _In_                                const POINT ptStart,
+    _In_reads_(nWaypoints)              const POINT* arrWaypoints,
+    _In_                                const INT nWaypoints,
+    _Out_writes_to_(nMaxLength, return) POINT* arrPath,
+    _In_                                const INT nMaxLength
+) {
+    const INT nWidth = pHierarchy->nWidth;
+    INT iCurrentTile = ptStart.y * nWidth + ptStart.x;
+    INT nLength = 0;
+
+    for (INT i = 0; i < nWaypoints && nLength < nMaxLength; i++) {
+        const INT iNextTile = arrWaypoints[i].y * nWidth + arrWaypoints[i].x;
+        if (iNextTile == iCurrentTile) {
+            continue;
+        }
+
+        // Waypoints in different clusters are the two sides of an entrance, one step apart
+        const INT iCluster = ClusterOfTile(pHierarchy, iCurrentTile);
+        if (iCluster != ClusterOfTile(pHierarchy, iNextTile)) {
+            arrPath[nLength++] = arrWaypoints[i];
+            iCurrentTile = iNextTile;
+            continue;
+        }
+
+        const HpaCluster* pCluster = &pHierarchy->arrClusters[iCluster];
+        SearchCluster(pHierarchy, pTerrain, pCluster, iCurrentTile, false, iNextTile);
+
+        const INT iTarget = LocalIndex(pHierarchy, pCluster, iNextTile);
+        if (pHierarchy->arrLocalCosts[iTarget] == HPA_INFINITE) {
+            printf("Waypoint (%d, %d) is not reachable inside its cluster\n", arrWaypoints[i].x, arrWaypoints[i].y);
+            break;
+        }
+
+        INT nSegment = 0;
+        for (INT iLocal = iTarget; pHierarchy->arrLocalParents[iLocal] != -1; iLocal = pHierarchy->arrLocalParents[iLocal]) {
+            pHierarchy->arrLocalPath[nSegment++] = iLocal;
+        }
+        while (nSegment > 0 && nLength < nMaxLength) {
+            const INT iTile = TileOfLocalIndex(pHierarchy, pCluster, pHierarchy->arrLocalPath[--nSegment]);
+            arrPath[nLength++] = (POINT) { iTile % nWidth, iTile / nWidth };
+        }
+        iCurrentTile = iNextTile;
+    }
+
+    return nLength;
+}
+
+_Check_return_opt_
+bool PathHierarchy_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ PathHierarchy* pHierarchy
+) {
+    if (!pHierarchy) {
+        return false;
+    }
+
+    SafeFree(pHierarchy->arrClusters);
+    SafeFree(pHierarchy->arrTileNodes);
+    SafeFree(pHierarchy->arrGenerations);
+    SafeFree(pHierarchy->arrGScores);
+    SafeFree(pHierarchy->arrParents);
+    SafeFree(pHierarchy->arrHeapIndex);
+    SafeFree(pHierarchy->arrHeap);
+    SafeFree(pHierarchy);
+    return true;
+}
@@ -0,0 +1,172 @@
+#ifndef PATH_HIERARCHY_H
+#define PATH_HIERARCHY_H
+
+#include "utils.h"
+#include "point.h"
+
+typedef struct _TerrainMap TerrainMap;
+
+#define HPA_CLUSTER_SIZE 16
+#define HPA_CLUSTER_TILES (HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE)
+#define HPA_MAX_CLUSTER_NODES 32   // << At most 8 entrances per border, see AddBorderTransitions
+#define HPA_LONG_ENTRANCE 6        // << Openings at least this wide get an entrance at both ends
+#define HPA_UNREACHABLE 0xFFFF
+
+typedef struct _HpaCluster {
+    INT x;                     // << Top-left tile of the cluster
+    INT y;
+    INT nWidth;                // << Clusters on the right and bottom edge of the map may be smaller
+    INT nHeight;
+    INT nNodes;
+    bool bDirty;               // << A tile of the cluster changed since the last update
+    bool bRebuild;             // << Scratch flag used by PathHierarchy_Update
+    INT arrNodeTiles[HPA_MAX_CLUSTER_NODES];
+    INT arrInterTiles[HPA_MAX_CLUSTER_NODES][2]; // << Tile across the border for each entrance of the node, or -1
+    UINT16 arrIntraCosts[HPA_MAX_CLUSTER_NODES * HPA_MAX_CLUSTER_NODES]; // << [from * MAX + to]
+} HpaCluster;
+
+typedef struct _HpaHeapNode {
+    INT nKey;
+    INT iNode;
+} HpaHeapNode;
+
+/*
+ * Hierarchical path-finding abstraction (HPA*) over a terrain map.
+ *
+ * The map is cut into square clusters. Where two clusters share an open border, entrance nodes are placed on
+ * both sides, and the cheapest path between every pair of nodes inside a cluster is precomputed. Long queries
+ * then run A* over the small graph of entrance nodes instead of over tiles; only the start and goal clusters
+ * are searched tile by tile. The resulting waypoints can be refined into tiles lazily, e.g. only as far as a
+ * unit moves this turn.
+ *
+ * Paths are near-optimal rather than optimal and ignore units, which makes the hierarchy suited to long-range
+ * planning. Use `PathFinder` for the final, exact move.
+ */
+typedef struct _PathHierarchy {
+    INT nWidth;
+    INT nHeight;
+    INT nClustersX;
+    INT nClustersY;
+    HpaCluster* arrClusters;
+    INT* arrTileNodes;         // << Node id of every entrance tile, -1 for other tiles
+    UINT uTerrainVersion;      // << TerrainMap version the abstraction was last built from
+    bool bHasDirty;
+
+    // Abstract search over node ids, cluster * HPA_MAX_CLUSTER_NODES + index, plus the start and goal
+    INT nNodeIds;
+    UINT uGeneration;
+    UINT* arrGenerations;
+    INT* arrGScores;
+    INT* arrParents;
+    INT* arrHeapIndex;
+    HpaHeapNode* arrHeap;
+    INT nHeapCount;
+    INT arrStartCosts[HPA_MAX_CLUSTER_NODES];
+    INT arrGoalCosts[HPA_MAX_CLUSTER_NODES];
+    INT nExpanded;             // << Abstract nodes closed by the last query, for profiling
+
+    // Tile search inside a single cluster
+    INT arrLocalCosts[HPA_CLUSTER_TILES];
+    INT arrLocalParents[HPA_CLUSTER_TILES];
+    INT arrLocalPath[HPA_CLUSTER_TILES];
+    HpaHeapNode arrLocalHeap[HPA_CLUSTER_TILES * 4 + 1];
+} PathHierarchy;
+
+/**
+ * @brief Builds the hierarchy for a terrain map.
+ *
+ * @param pTerrain Pointer to the `TerrainMap` to abstract.
+ * @return A pointer to the new `PathHierarchy`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ PathHierarchy* PathHierarchy_Create(
+    _In_ const TerrainMap* pTerrain
+    );
+
+/**
+ * @brief Records that the cost of a tile changed.
+ *
+ * Only marks the affected clusters; the work happens in `PathHierarchy_Update`, so many changes in one turn
+ * are folded into a single rebuild per cluster.
+ *
+ * @param pHierarchy Pointer to the `PathHierarchy`.
+ * @param ptTile     Tile whose terrain cost changed.
+ */
+void PathHierarchy_MarkTileChanged(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    POINT ptTile
+    );
+
+/**
+ * @brief Rebuilds the clusters touched by changed tiles.
+ *
+ * A dirty cluster is rebuilt together with its direct neighbours, since they share entrances. If the terrain
+ * changed without any tile being marked, the whole hierarchy is rebuilt.
+ *
+ * @param pHierarchy Pointer to the `PathHierarchy`.
+ * @param pTerrain   The terrain the hierarchy was created from.
+ * @return The number of rebuilt clusters.
+ */
+_Check_return_opt_ INT PathHierarchy_Update(
+    _Inout_ PathHierarchy* pHierarchy,
+    _In_    const TerrainMap* pTerrain
+    );
+
+/**
+ * @brief Finds a near-optimal path as a list of waypoints.
+ *
+ * @param pHierarchy    Pointer to an up-to-date `PathHierarchy`.
+ * @param pTerrain      The terrain the hierarchy was created from.
+ * @param ptStart       Tile the path starts on.
+ * @param ptGoal        Tile the path ends on.
+ * @param arrWaypoints  Receives the entrance tiles the path passes, ending with `ptGoal`. Consecutive
+ *                      waypoints are either in the same cluster or adjacent.
+ * @param nMaxWaypoints Capacity of `arrWaypoints`.
+ * @param pnWaypoints   Receives the number of waypoints.
+ * @return The cost of the path, or `-1` if there is none or the waypoints do not fit.
+ */
+_Check_return_ INT PathHierarchy_FindPath(
+    _Inout_                                       PathHierarchy* pHierarchy,
+    _In_                                          const TerrainMap* pTerrain,
+    _In_                                          POINT ptStart,
+    _In_                                          POINT ptGoal,
+    _Out_writes_to_(nMaxWaypoints, *pnWaypoints)  POINT* arrWaypoints,
+    _In_                                          INT nMaxWaypoints,
+    _Out_                                         INT* pnWaypoints
+    );
+
+/**
+ * @brief Turns the beginning of a waypoint path into tiles.
+ *
+ * Refinement stops once `arrPath` is full, so only the part of a long path that is about to be walked costs
+ * anything.
+ *
+ * @param pHierarchy   Pointer to the `PathHierarchy` that produced the waypoints.
+ * @param pTerrain     The terrain the hierarchy was created from.
+ * @param ptStart      Start tile passed to `PathHierarchy_FindPath`.
+ * @param arrWaypoints Waypoints returned by `PathHierarchy_FindPath`.
+ * @param nWaypoints   Number of waypoints.
+ * @param arrPath      Receives the tiles from the first step on; the start tile is not included.
+ * @param nMaxLength   Number of steps to refine.
+ * @return The number of steps written.
+ */
+_Check_return_ INT PathHierarchy_RefinePath(
+    _Inout_                             PathHierarchy* pHierarchy,
+    _In_                                const TerrainMap* pTerrain,
+    _In_                                POINT ptStart,
+    _In_reads_(nWaypoints)              const POINT* arrWaypoints,
+    _In_                                INT nWaypoints,
+    _Out_writes_to_(nMaxLength, return) POINT* arrPath,
+    _In_                                INT nMaxLength
+    );
+
+/**
+ * @brief Destroys a path hierarchy and frees its resources.
+ *
+ * @param pHierarchy Pointer to the `PathHierarchy` to destroy.
+ * @return `true` if the hierarchy was destroyed, `false` if `pHierarchy` was `NULL`.
+ */
+_Check_return_opt_ bool PathHierarchy_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ PathHierarchy* pHierarchy
+    );
+
+#endif //PATH_HIERARCHY_H
@@ -0,0 +1,319 @@
+#include "pathfinder.h"
+
+#include <string.h>
+
+#include "terrain.h"
+#include "occupancy-grid.h"
+#include "arena.h"
+
+_Check_return_ _Ret_maybenull_
+PathFinder* PathFinder_Create(
+    _In_ const INT nWidth,
+    _In_ const INT nHeight
+) {
+    if (nWidth <= 0 || nHeight <= 0) {
+        return NULL;
+    }
+
+    PathFinder* pFinder = calloc(1, sizeof(PathFinder));
+    if (!pFinder) {
+        printf("Failed to allocate memory for PathFinder\n");
+        return NULL;
+    }
+
+    const size_t nTiles = (size_t)nWidth * nHeight;
+    pFinder->nWidth = nWidth;
+    pFinder->nHeight = nHeight;
+
+    pFinder->arrGenerations = calloc(nTiles, sizeof(UINT));
+    pFinder->arrGScores = malloc(nTiles * sizeof(INT));
+    pFinder->arrParents = malloc(nTiles * sizeof(INT));
+    pFinder->arrHeapIndex = malloc(nTiles * sizeof(INT));
+    pFinder->arrHeap = malloc(nTiles * sizeof(PathHeapNode));
+    if (!pFinder->arrGenerations || !pFinder->arrGScores || !pFinder->arrParents ||
+        !pFinder->arrHeapIndex || !pFinder->arrHeap) {
+        printf("Failed to allocate memory for path finder arrays\n");
+        PathFinder_Destroy(pFinder);
+        return NULL;
+    }
+
+    return pFinder;
+}
+
+static void HeapSiftUp(
+    _Inout_ PathFinder* pFinder,
+    _In_    INT iPosition
+) {
+    const PathHeapNode node = pFinder->arrHeap[iPosition];
+    while (iPosition > 0) {
+        const INT iParent = (iPosition - 1) / 2;
+        if (pFinder->arrHeap[iParent].lKey <= node.lKey) {
+            break;
+        }
+        pFinder->arrHeap[iPosition] = pFinder->arrHeap[iParent];
+        pFinder->arrHeapIndex[pFinder->arrHeap[iPosition].iTile] = iPosition;
+        iPosition = iParent;
+    }
+    pFinder->arrHeap[iPosition] = node;
+    pFinder->arrHeapIndex[node.iTile] = iPosition;
+}
+
+static void HeapSiftDown(
+    _Inout_ PathFinder* pFinder,
+    _In_    INT iPosition
+) {
+    const PathHeapNode node = pFinder->arrHeap[iPosition];
+    for (;;) {
+        INT iChild = iPosition * 2 + 1;
+        if (iChild >= pFinder->nHeapCount) {
+            break;
+        }
+        if (iChild + 1 < pFinder->nHeapCount && pFinder->arrHeap[iChild + 1].lKey < pFinder->arrHeap[iChild].lKey) {
+            iChild++;
+        }
+        if (node.lKey <= pFinder->arrHeap[iChild].lKey) {
+            break;
+        }
+        pFinder->arrHeap[iPosition] = pFinder->arrHeap[iChild];
+        pFinder->arrHeapIndex[pFinder->arrHeap[iPosition].iTile] = iPosition;
+        iPosition = iChild;
+    }
+    pFinder->arrHeap[iPosition] = node;
+    pFinder->arrHeapIndex[node.iTile] = iPosition;
+}
+
+_Check_return_
+static INT HeapPop(
+    _Inout_ PathFinder* pFinder
+) {
+    const INT iTile = pFinder->arrHeap[0].iTile;
+    pFinder->arrHeapIndex[iTile] = -1;
+
+    pFinder->nHeapCount--;
+    if (pFinder->nHeapCount > 0) {
+        pFinder->arrHeap[0] = pFinder->arrHeap[pFinder->nHeapCount];
+        HeapSiftDown(pFinder, 0);
+    }
+    return iTile;
+}
+
+_Check_return_
+static inline INT64 HeapKey(
+    _In_ const INT nGScore,
+    _In_ const INT nHeuristic
+) {
+    // Among equal f, prefer the tile further from the start; it is closer to the goal and ends the search sooner
+    return ((INT64)(nGScore + nHeuristic) << 32) - nGScore;
+}
+
+_Check_return_
+static inline INT Heuristic(
+    _In_ const INT x,
+    _In_ const INT y,
+    _In_ const POINT ptGoal
+) {
+    // Manhattan distance; every tile costs at least 1, so it never overestimates
+    return abs(x - ptGoal.x) + abs(y - ptGoal.y);
+}
+
+/**
+ * Runs the search and leaves the path in `arrParents`. Returns the number of steps, or `-1` if there is no path.
+ */
+_Check_return_
+static INT Search(
+    _Inout_  PathFinder* pFinder,
+    _In_     const TerrainMap* pTerrain,
+    _In_opt_ const OccupancyGrid* pBlockers,
+    _In_     const POINT ptStart,
+    _In_     const POINT ptGoal
+) {
+    pFinder->nExpanded = 0;
+
+    if (pTerrain->nWidth != pFinder->nWidth || pTerrain->nHeight != pFinder->nHeight) {
+        printf("PathFinder is %dx%d but the terrain is %dx%d\n",
+            pFinder->nWidth, pFinder->nHeight, pTerrain->nWidth, pTerrain->nHeight);
+        return -1;
+    }
+
+    const INT nWidth = pFinder->nWidth;
+    const INT nHeight = pFinder->nHeight;
+    if (ptStart.x < 0 || ptStart.y < 0 || ptStart.x >= nWidth || ptStart.y >= nHeight ||
+        TerrainMap_GetCost(pTerrain, ptGoal) == TERRAIN_COST_IMPASSABLE) {
+        return -1;
+    }
+    if (Point_IsEqual(&ptStart, &ptGoal)) {
+        return 0;
+    }
+    if (pBlockers && (pBlockers->nWidth != nWidth || pBlockers->nHeight != nHeight)) {
+        printf("Occupancy grid is %dx%d but the terrain is %dx%d\n",
+            pBlockers->nWidth, pBlockers->nHeight, nWidth, nHeight);
+        return -1;
+    }
+
+    // Bumping the generation invalidates every tile at once; only a wrap-around needs a real clear
+    pFinder->uGeneration++;
+    if (pFinder->uGeneration == 0) {
+        memset(pFinder->arrGenerations, 0, (size_t)nWidth * nHeight * sizeof(UINT));
+        pFinder->uGeneration = 1;
+    }
+
+    const UINT uGeneration = pFinder->uGeneration;
+    const INT iStart = ptStart.y * nWidth + ptStart.x;
+    const INT iGoal = ptGoal.y * nWidth + ptGoal.x;
+    const BYTE* arrTerrain = pTerrain->arrCosts;
+
+    // The grid is read directly, so blockers cost nothing per query no matter how many units there are
+    Unit* const* arrOccupants = pBlockers ? pBlockers->arrUnits : NULL;
+    if (arrOccupants && arrOccupants[iGoal]) {
+        return -1;
+    }
+
+    pFinder->arrGenerations[iStart] = uGeneration;
+    pFinder->arrGScores[iStart] = 0;
+    pFinder->arrParents[iStart] = -1;
+    pFinder->arrHeap[0] = (PathHeapNode) { HeapKey(0, Heuristic(ptStart.x, ptStart.y, ptGoal)), iStart };
+    pFinder->arrHeapIndex[iStart] = 0;
+    pFinder->nHeapCount = 1;
+
+    bool bFound = false;
+    while (pFinder->nHeapCount > 0) {
+        const INT iTile = HeapPop(pFinder);
+        pFinder->nExpanded++;
+        if (iTile == iGoal) {
+            bFound = true;
+            break;
+        }
+
+        const INT x = iTile % nWidth;
+        const INT y = iTile / nWidth;
+        const INT arrNeighbours[4] = {
+            x > 0 ? iTile - 1 : -1,
+            x < nWidth - 1 ? iTile + 1 : -1,
+            y > 0 ? iTile - nWidth : -1,
+            y < nHeight - 1 ? iTile + nWidth : -1
+        };
+
+        for (INT i = 0; i < 4; i++) {
+            const INT iNeighbour = arrNeighbours[i];
+            if (iNeighbour < 0 || arrTerrain[iNeighbour] == TERRAIN_COST_IMPASSABLE ||
+                (arrOccupants && arrOccupants[iNeighbour])) {
+                continue;
+            }
+
+            const INT nNewCost = pFinder->arrGScores[iTile] + arrTerrain[iNeighbour];
+            const bool bSeen = pFinder->arrGenerations[iNeighbour] == uGeneration;
+            if (bSeen && (pFinder->arrHeapIndex[iNeighbour] < 0 || pFinder->arrGScores[iNeighbour] <= nNewCost)) {
+                continue; // << Closed, or already queued with a path at least as cheap
+            }
+
+            const PathHeapNode node = {
+                HeapKey(nNewCost, Heuristic(iNeighbour % nWidth, iNeighbour / nWidth, ptGoal)),
+                iNeighbour
+            };
+            pFinder->arrGScores[iNeighbour] = nNewCost;
+            pFinder->arrParents[iNeighbour] = iTile;
+
+            if (bSeen) {
+                const INT iPosition = pFinder->arrHeapIndex[iNeighbour];
+                pFinder->arrHeap[iPosition] = node;
+                HeapSiftUp(pFinder, iPosition);
+            } else {
+                pFinder->arrGenerations[iNeighbour] = uGeneration;
+                pFinder->arrHeap[pFinder->nHeapCount] = node;
+                HeapSiftUp(pFinder, pFinder->nHeapCount++);
+            }
+        }
+    }
+
+    if (!bFound) {
+        return -1;
+    }
+
+    INT nLength = 0;
+    for (INT iTile = iGoal; iTile != iStart; iTile = pFinder->arrParents[iTile]) {
+        nLength++;
+    }
+    return nLength;
+}
+
+static void WritePath(
+    _In_                  const PathFinder* pFinder,
+    _In_                  const POINT ptStart,
+    _In_                  const POINT ptGoal,
+    _Out_writes_(nLength) POINT* arrPath,
+    _In_                  const INT nLength
+) {
+    const INT nWidth = pFinder->nWidth;
+    const INT iStart = ptStart.y * nWidth + ptStart.x;
+
+    INT i = nLength;
+    for (INT iTile = ptGoal.y * nWidth + ptGoal.x; iTile != iStart; iTile = pFinder->arrParents[iTile]) {
+        arrPath[--i] = (POINT) { iTile % nWidth, iTile / nWidth };
+    }
+}
+
+_Check_return_
+INT PathFinder_FindPath(
+    _Inout_                             PathFinder* pFinder,
+    _In_                                const TerrainMap* pTerrain,
+    _In_opt_                            const OccupancyGrid* pBlockers,
+    _In_                                const POINT ptStart,
+    _In_                                const POINT ptGoal,
+    _Out_writes_to_(nMaxLength, return) POINT* arrPath,
+    _In_                                const INT nMaxLength
+) {
+    const INT nLength = Search(pFinder, pTerrain, pBlockers, ptStart, ptGoal);
+    if (nLength < 0 || nLength > nMaxLength) {
+        return -1;
+    }
+
+    WritePath(pFinder, ptStart, ptGoal, arrPath, nLength);
+    return nLength;
+}
+
+_Check_return_
+INT PathFinder_FindPathAlloc(
+    _Inout_                       PathFinder* pFinder,
+    _In_                          const TerrainMap* pTerrain,
+    _In_opt_                      const OccupancyGrid* pBlockers,
+    _In_                          const POINT ptStart,
+    _In_                          const POINT ptGoal,
+    _Inout_opt_                   Arena* pArena,
+    _Outptr_result_nullonfailure_ POINT** parrPath
+) {
+    *parrPath = NULL;
+
+    const INT nLength = Search(pFinder, pTerrain, pBlockers, ptStart, ptGoal);
+    if (nLength < 0) {
+        return -1;
+    }
+
+    // At least one element, so an empty path is still told apart from a failed allocation
+    const size_t cbPath = (size_t)(nLength > 0 ? nLength : 1) * sizeof(POINT);
+    POINT* arrPath = pArena ? Arena_Alloc(pArena, cbPath) : malloc(cbPath);
+    if (!arrPath) {
+        printf("Failed to allocate memory for a path of %d steps\n", nLength);
+        return -1;
+    }
+
+    WritePath(pFinder, ptStart, ptGoal, arrPath, nLength);
+    *parrPath = arrPath;
+    return nLength;
+}
+
+_Check_return_opt_
+bool PathFinder_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ PathFinder* pFinder
+) {
+    if (!pFinder) {
+        return false;
+    }
+
+    SafeFree(pFinder->arrGenerations);
+    SafeFree(pFinder->arrGScores);
+    SafeFree(pFinder->arrParents);
+    SafeFree(pFinder->arrHeapIndex);
+    SafeFree(pFinder->arrHeap);
+    SafeFree(pFinder);
+    return true;
+}
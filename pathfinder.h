@@ -0,0 +1,107 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include "utils.h"
+#include "point.h"
+
+typedef struct _TerrainMap TerrainMap;
+typedef struct _OccupancyGrid OccupancyGrid;
+typedef struct _Arena Arena;
+
+/*
+ * Reusable A* search state for one map size.
+ *
+ * All per-tile arrays are allocated once by `PathFinder_Create`. Tiles carry the generation of the query that
+ * last touched them, so nothing is cleared between queries. The open set is a binary min-heap of tile indices
+ * keyed by f = g + h, with a back-index per tile for decrease-key.
+ */
+typedef struct _PathHeapNode {
+    INT64 lKey;              // << f in the high half, minus g in the low half, so ties prefer deeper tiles
+    INT iTile;
+} PathHeapNode;
+
+typedef struct _PathFinder {
+    INT nWidth;
+    INT nHeight;
+    UINT uGeneration;
+    UINT* arrGenerations;    // << Generation in which the other per-tile values were written
+    INT* arrGScores;         // << Cheapest known cost from the start
+    INT* arrParents;         // << Previous tile on the cheapest known path, or -1
+    INT* arrHeapIndex;       // << Position in arrHeap, or -1 once the tile is closed
+    PathHeapNode* arrHeap;   // << Keys live next to the tile index so sifting does not chase per-tile arrays
+    INT nHeapCount;
+    INT nExpanded;           // << Tiles closed by the last query, for profiling
+} PathFinder;
+
+/**
+ * @brief Creates a path finder for maps of the given size.
+ *
+ * @param nWidth  Width of the map in tiles.
+ * @param nHeight Height of the map in tiles.
+ * @return A pointer to the new `PathFinder`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ PathFinder* PathFinder_Create(
+    _In_ INT nWidth,
+    _In_ INT nHeight
+    );
+
+/**
+ * @brief Finds the cheapest orthogonal path between two tiles.
+ *
+ * Entering a tile costs its terrain cost. Tiles occupied in `pBlockers` cannot be entered, except the start
+ * tile, which the moving unit occupies itself.
+ *
+ * @param pFinder    Pointer to the `PathFinder`, created with the size of the terrain.
+ * @param pTerrain   Pointer to the `TerrainMap` with the tile costs.
+ * @param pBlockers  Occupancy grid of the units that block movement, or `NULL`. Must match the terrain size.
+ * @param ptStart    Tile the path starts on.
+ * @param ptGoal     Tile the path ends on.
+ * @param arrPath    Receives the tiles from the first step to `ptGoal`; the start tile is not included.
+ * @param nMaxLength Capacity of `arrPath`.
+ * @return The number of steps, `0` if start and goal are the same tile, or `-1` if there is no path or it does
+ *         not fit into `arrPath`.
+ */
+_Check_return_ INT PathFinder_FindPath(
+    _Inout_                             PathFinder* pFinder,
+    _In_                                const TerrainMap* pTerrain,
+    _In_opt_                            const OccupancyGrid* pBlockers,
+    _In_                                POINT ptStart,
+    _In_                                POINT ptGoal,
+    _Out_writes_to_(nMaxLength, return) POINT* arrPath,
+    _In_                                INT nMaxLength
+    );
+
+/**
+ * @brief Finds the cheapest orthogonal path like `PathFinder_FindPath`, into a buffer sized to the path.
+ *
+ * @param pFinder   Pointer to the `PathFinder`, created with the size of the terrain.
+ * @param pTerrain  Pointer to the `TerrainMap` with the tile costs.
+ * @param pBlockers Occupancy grid of the units that block movement, or `NULL`.
+ * @param ptStart   Tile the path starts on.
+ * @param ptGoal    Tile the path ends on.
+ * @param pArena    Arena to allocate the path from, e.g. `Arena_GetFrame()`, or `NULL` to return heap memory the
+ *                  caller frees.
+ * @param parrPath  Receives the tiles from the first step to `ptGoal`, or `NULL` if the function fails.
+ * @return The number of steps, or `-1` if there is no path or it could not be allocated.
+ */
+_Check_return_ INT PathFinder_FindPathAlloc(
+    _Inout_                       PathFinder* pFinder,
+    _In_                          const TerrainMap* pTerrain,
+    _In_opt_                      const OccupancyGrid* pBlockers,
+    _In_                          POINT ptStart,
+    _In_                          POINT ptGoal,
+    _Inout_opt_                   Arena* pArena,
+    _Outptr_result_nullonfailure_ POINT** parrPath
+    );
+
+/**
+ * @brief Destroys a path finder and frees its resources.
+ *
+ * @param pFinder Pointer to the `PathFinder` to destroy.
+ * @return `true` if the path finder was destroyed, `false` if `pFinder` was `NULL`.
+ */
+_Check_return_opt_ bool PathFinder_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ PathFinder* pFinder
+    );
+
+#endif //PATHFINDER_H
@@ -0,0 +1,160 @@
+#include "pool.h"
+
+#include <string.h>
+
+_Check_return_
+static BYTE* GetSlot(
+    _In_ const Pool* pPool,
+    _In_ const INT iSlot
+) {
+    const size_t cbSlot = POOL_SLOT_HEADER + pPool->cbObject;
+    return pPool->arrSlabs[iSlot / pPool->nPerSlab] + (size_t)(iSlot % pPool->nPerSlab) * cbSlot + POOL_SLOT_HEADER;
+}
+
+/**
+ * Reads the slot index stored in front of the object, so the lookup costs the same however many slabs there are.
+ * The index is only trusted if that slot really is the object, which rejects pointers from elsewhere.
+ */
+_Check_return_
+static INT GetSlotIndex(
+    _In_ const Pool* pPool,
+    _In_ const void* pObject
+) {
+    INT iSlot;
+    memcpy(&iSlot, (const BYTE*)pObject - POOL_SLOT_HEADER, sizeof(INT));
+    if (iSlot < 0 || iSlot >= pPool->nSlabs * pPool->nPerSlab || GetSlot(pPool, iSlot) != pObject) {
+        return -1;
+    }
+    return iSlot;
+}
+
+_Check_return_
+static bool AddSlab(
+    _Inout_ Pool* pPool
+) {
+    const INT nSlots = (pPool->nSlabs + 1) * pPool->nPerSlab;
+
+    BYTE** arrSlabs = realloc(pPool->arrSlabs, (size_t)(pPool->nSlabs + 1) * sizeof(BYTE*));
+    if (!arrSlabs) {
+        printf("Failed to allocate memory for %s pool\n", pPool->pszName);
+        return false;
+    }
+    pPool->arrSlabs = arrSlabs;
+
+    UINT* arrGenerations = realloc(pPool->arrGenerations, (size_t)nSlots * sizeof(UINT));
+    if (!arrGenerations) {
+        printf("Failed to allocate memory for %s pool\n", pPool->pszName);
+        return false;
+    }
+    pPool->arrGenerations = arrGenerations;
+
+    BYTE* pSlab = malloc((POOL_SLOT_HEADER + pPool->cbObject) * (size_t)pPool->nPerSlab);
+    if (!pSlab) {
+        printf("Failed to allocate memory for %s pool\n", pPool->pszName);
+        return false;
+    }
+    pPool->arrSlabs[pPool->nSlabs++] = pSlab;
+
+    // Chain the new slots in address order, so a fresh slab fills front to back
+    const INT iFirst = nSlots - pPool->nPerSlab;
+    for (INT iSlot = nSlots - 1; iSlot >= iFirst; iSlot--) {
+        pPool->arrGenerations[iSlot] = 0;
+        memcpy(GetSlot(pPool, iSlot) - POOL_SLOT_HEADER, &iSlot, sizeof(INT));
+        memcpy(GetSlot(pPool, iSlot), &pPool->iFreeHead, sizeof(INT));
+        pPool->iFreeHead = iSlot;
+    }
+
+    return true;
+}
+
+_Check_return_ _Ret_maybenull_
+void* Pool_Alloc(
+    _Inout_ Pool* pPool
+) {
+    if (pPool->iFreeHead < 0 && !AddSlab(pPool)) {
+        return NULL;
+    }
+
+    const INT iSlot = pPool->iFreeHead;
+    BYTE* pSlot = GetSlot(pPool, iSlot);
+    memcpy(&pPool->iFreeHead, pSlot, sizeof(INT));
+
+    pPool->arrGenerations[iSlot]++;
+    pPool->nLive++;
+
+    memset(pSlot, 0, pPool->cbObject);
+    return pSlot;
+}
+
+void Pool_Free(
+    _Inout_  Pool* pPool,
+    _In_opt_ void* pObject
+) {
+    if (!pObject) {
+        return;
+    }
+
+    const INT iSlot = GetSlotIndex(pPool, pObject);
+    if (iSlot < 0 || (pPool->arrGenerations[iSlot] & 1) == 0) {
+        printf("Ignoring free of a %s that is not allocated from its pool\n", pPool->pszName);
+        assert(false);
+        return;
+    }
+
+    pPool->arrGenerations[iSlot]++;
+    pPool->nLive--;
+
+    memcpy(GetSlot(pPool, iSlot), &pPool->iFreeHead, sizeof(INT));
+    pPool->iFreeHead = iSlot;
+}
+
+_Check_return_
+PoolHandle Pool_GetHandle(
+    _In_ const Pool* pPool,
+    _In_ const void* pObject
+) {
+    const INT iSlot = GetSlotIndex(pPool, pObject);
+    if (iSlot < 0) {
+        return (PoolHandle) { 0 };
+    }
+
+    return (PoolHandle) { (UINT)iSlot, pPool->arrGenerations[iSlot] };
+}
+
+_Check_return_ _Ret_maybenull_
+void* Pool_Resolve(
+    _In_ const Pool* pPool,
+    _In_ const PoolHandle handle
+) {
+    if (handle.uIndex >= (UINT)(pPool->nSlabs * pPool->nPerSlab)
+        || pPool->arrGenerations[handle.uIndex] != handle.uGeneration
+        || (handle.uGeneration & 1) == 0) {
+        return NULL;
+    }
+
+    return GetSlot(pPool, (INT)handle.uIndex);
+}
+
+_Check_return_
+INT Pool_GetLiveCount(
+    _In_ const Pool* pPool
+) {
+    return pPool->nLive;
+}
+
+void Pool_Release(
+    _Inout_ Pool* pPool
+) {
+    if (pPool->nLive > 0) {
+        printf("Releasing %s pool with %d objects still allocated\n", pPool->pszName, pPool->nLive);
+    }
+
+    for (INT i = 0; i < pPool->nSlabs; i++) {
+        SafeFree(pPool->arrSlabs[i]);
+    }
+    SafeFree(pPool->arrSlabs);
+    SafeFree(pPool->arrGenerations);
+    pPool->nSlabs = 0;
+    pPool->iFreeHead = -1;
+    pPool->nLive = 0;
+}
@@ -0,0 +1,104 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "utils.h"
+
+#define POOL_DEFAULT_SLAB_SIZE 256 // << Objects per slab
+#define POOL_SLOT_HEADER 16        // << Slot index in front of every object, padded so objects keep malloc's alignment
+
+/*
+ * Reference to a pooled object that notices when the object is gone. Each slot counts how often it was handed
+ * out; a handle keeps the count from when it was taken and stops resolving once the slot is freed or reused.
+ * A zeroed handle never resolves.
+ */
+typedef struct _PoolHandle {
+    UINT uIndex;
+    UINT uGeneration;          // << Odd while the slot is in use, so 0 never matches a live object
+} PoolHandle;
+
+/*
+ * Allocator for objects of one type. Objects live in slabs of `nPerSlab` consecutive slots, so objects created
+ * together sit next to each other in memory and loops over them stay cache friendly. Freed slots go on a free
+ * list and are reused first; slabs are only allocated when every slot is taken, and never move, so pointers
+ * stay valid for the object's lifetime. Each slot starts with its own index, so finding the slot of an object
+ * does not depend on the number of slabs.
+ *
+ * Declare a pool with `POOL_INIT` as a static in the module that owns the type; it needs no further setup.
+ * A pool is not thread-safe.
+ */
+typedef struct _Pool {
+    PCSTR pszName;             // << Type name for error messages
+    size_t cbObject;           // << Size of an object; a slot adds POOL_SLOT_HEADER in front
+    INT nPerSlab;
+    BYTE** arrSlabs;
+    INT nSlabs;
+    UINT* arrGenerations;      // << One per slot, see `PoolHandle`
+    INT iFreeHead;             // << First free slot, -1 when every slot is in use; free slots hold the next index
+    INT nLive;
+} Pool;
+
+#define POOL_INIT(type) { #type, sizeof(type) < sizeof(INT) ? sizeof(INT) : sizeof(type), POOL_DEFAULT_SLAB_SIZE, NULL, 0, NULL, -1, 0 }
+
+/**
+ * @brief Takes a slot from the pool.
+ *
+ * @param pPool Pointer to the `Pool`.
+ * @return Zeroed memory for one object, or `NULL` if a new slab was needed and could not be allocated.
+ */
+_Check_return_ _Ret_maybenull_ void* Pool_Alloc(
+    _Inout_ Pool* pPool
+    );
+
+/**
+ * @brief Returns an object's slot to the pool. Handles to it stop resolving.
+ *
+ * @param pPool   Pointer to the `Pool` the object came from.
+ * @param pObject The object, or `NULL` to do nothing.
+ */
+void Pool_Free(
+    _Inout_  Pool* pPool,
+    _In_opt_ void* pObject
+    );
+
+/**
+ * @brief Gets a handle to a live object.
+ *
+ * @param pPool   Pointer to the `Pool` the object came from.
+ * @param pObject The object.
+ * @return A handle that resolves to the object until it is freed.
+ */
+_Check_return_ PoolHandle Pool_GetHandle(
+    _In_ const Pool* pPool,
+    _In_ const void* pObject
+    );
+
+/**
+ * @brief Looks up the object a handle refers to.
+ *
+ * @param pPool   Pointer to the `Pool`.
+ * @param handle  The handle.
+ * @return The object, or `NULL` if it was freed since the handle was taken.
+ */
+_Check_return_ _Ret_maybenull_ void* Pool_Resolve(
+    _In_ const Pool* pPool,
+    _In_ PoolHandle handle
+    );
+
+/**
+ * @brief Gets the number of objects currently allocated from the pool.
+ */
+_Check_return_ INT Pool_GetLiveCount(
+    _In_ const Pool* pPool
+    );
+
+/**
+ * @brief Frees every slab. Objects still allocated become invalid and are reported as leaks.
+ *
+ * Call from the owning module's shutdown once all of its objects are destroyed. The pool can be used again
+ * afterwards and allocates new slabs on demand.
+ */
+void Pool_Release(
+    _Inout_ Pool* pPool
+    );
+
+#endif //POOL_H
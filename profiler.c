@@ -0,0 +1,326 @@
+#include "profiler.h"
+
+#include <string.h>
+#include <SFML/System.h>
+
+#include "window.h"
+
+typedef struct _OpenScope {
+    PCSTR pszName;
+    INT64 lStartNs;
+} OpenScope;
+
+typedef struct _ProfilerThread {
+    INT iThread;               // << Index in s_arrThreads, used as the trace thread id
+    bool bInUse;               // << Owned by a thread; released buffers are handed to the next thread that needs one
+    UINT64 nWritten;           // << Events ever written; the ring holds the last PROFILER_RING_SIZE of them
+    UINT64 nFolded;            // << Events already summed up by Profiler_EndFrame
+    INT nOpen;                 // << Open scopes, may exceed PROFILER_MAX_DEPTH; deeper scopes are not recorded
+    OpenScope arrOpen[PROFILER_MAX_DEPTH];
+    ProfileEvent arrEvents[PROFILER_RING_SIZE];
+} ProfilerThread;
+
+static sfMutex* s_pMutex;      // << Guards thread registration; NULL while the profiler is stopped
+static volatile bool s_bRunning;
+static UINT s_uSession;        // << Bumped on every start, so threads notice their buffer is gone
+
+static ProfilerThread* s_arrThreads[PROFILER_MAX_THREADS];
+static INT s_nThreads;
+
+static ProfileScopeStats s_arrStats[PROFILER_MAX_SCOPES];
+static INT s_nStats;
+static INT64 s_lLastFrameNs;
+static INT64 s_lFrameNs;
+
+static THREAD_LOCAL ProfilerThread* s_pThread;
+static THREAD_LOCAL UINT s_uThreadSession;
+
+_Check_return_ _Ret_maybenull_
+static ProfilerThread* GetThread(
+    void
+) {
+    if (s_pThread && s_uThreadSession == s_uSession) {
+        return s_pThread;
+    }
+
+    // First scope on this thread in this session
+    s_pThread = NULL;
+    s_uThreadSession = s_uSession;
+
+    sfMutex_lock(s_pMutex);
+    ProfilerThread* pThread = NULL;
+    for (INT i = 0; i < s_nThreads && !pThread; i++) {
+        if (!s_arrThreads[i]->bInUse) {
+            pThread = s_arrThreads[i];
+        }
+    }
+
+    if (pThread) {
+        // The scopes of the thread that released the buffer are dropped
+        pThread->nWritten = 0;
+        pThread->nFolded = 0;
+        pThread->nOpen = 0;
+    } else if (s_nThreads < PROFILER_MAX_THREADS) {
+        pThread = calloc(1, sizeof(ProfilerThread));
+        if (pThread) {
+            pThread->iThread = s_nThreads;
+            s_arrThreads[s_nThreads++] = pThread;
+        }
+    }
+
+    if (pThread) {
+        pThread->bInUse = true;
+        s_pThread = pThread;
+    }
+    sfMutex_unlock(s_pMutex);
+
+    return s_pThread;
+}
+
+_Check_return_opt_
+bool Profiler_Start(
+    void
+) {
+    if (s_pMutex) {
+        return true;
+    }
+
+    s_pMutex = sfMutex_create();
+    if (!s_pMutex) {
+        printf("Failed to create profiler mutex\n");
+        return false;
+    }
+
+    s_uSession++;
+    s_nStats = 0;
+    s_lLastFrameNs = GetTimeNanoseconds();
+    s_lFrameNs = 0;
+    s_bRunning = true;
+    return true;
+}
+
+void Profiler_Stop(
+    void
+) {
+    if (!s_pMutex) {
+        return;
+    }
+
+    s_bRunning = false;
+    for (INT i = 0; i < s_nThreads; i++) {
+        SafeFree(s_arrThreads[i]);
+    }
+    s_nThreads = 0;
+    s_nStats = 0;
+
+    sfMutex_destroy(s_pMutex);
+    s_pMutex = NULL;
+}
+
+void Profiler_ReleaseThread(
+    void
+) {
+    // A buffer from an earlier session was already freed by Profiler_Stop
+    if (s_pThread && s_uThreadSession == s_uSession && s_pMutex) {
+        sfMutex_lock(s_pMutex);
+        s_pThread->bInUse = false;
+        sfMutex_unlock(s_pMutex);
+    }
+    s_pThread = NULL;
+}
+
+_Check_return_
+bool Profiler_IsRunning(
+    void
+) {
+    return s_bRunning;
+}
+
+void Profiler_Begin(
+    _In_z_ PCSTR pszName
+) {
+    if (!s_bRunning) {
+        return;
+    }
+
+    ProfilerThread* pThread = GetThread();
+    if (!pThread) {
+        return;
+    }
+
+    if (pThread->nOpen < PROFILER_MAX_DEPTH) {
+        pThread->arrOpen[pThread->nOpen].pszName = pszName;
+        pThread->arrOpen[pThread->nOpen].lStartNs = GetTimeNanoseconds();
+    }
+    pThread->nOpen++;
+}
+
+void Profiler_End(
+    void
+) {
+    if (!s_bRunning) {
+        return;
+    }
+
+    ProfilerThread* pThread = GetThread();
+    if (!pThread || pThread->nOpen == 0) {
+        return; // << The scope began before the profiler started
+    }
+
+    pThread->nOpen--;
+    if (pThread->nOpen >= PROFILER_MAX_DEPTH) {
+        return;
+    }
+
+    ProfileEvent* pEvent = &pThread->arrEvents[pThread->nWritten & (PROFILER_RING_SIZE - 1)];
+    pEvent->pszName = pThread->arrOpen[pThread->nOpen].pszName;
+    pEvent->lStartNs = pThread->arrOpen[pThread->nOpen].lStartNs;
+    pEvent->lEndNs = GetTimeNanoseconds();
+    pEvent->iDepth = pThread->nOpen;
+    pThread->nWritten++;
+}
+
+_Check_return_ _Ret_maybenull_
+static ProfileScopeStats* FindStats(
+    _In_z_ PCSTR pszName
+) {
+    for (INT i = 0; i < s_nStats; i++) {
+        if (s_arrStats[i].pszName == pszName || strcmp(s_arrStats[i].pszName, pszName) == 0) {
+            return &s_arrStats[i];
+        }
+    }
+
+    if (s_nStats == PROFILER_MAX_SCOPES) {
+        return NULL;
+    }
+
+    ProfileScopeStats* pStats = &s_arrStats[s_nStats++];
+    memset(pStats, 0, sizeof(ProfileScopeStats));
+    pStats->pszName = pszName;
+    return pStats;
+}
+
+void Profiler_EndFrame(
+    void
+) {
+    if (!s_bRunning) {
+        return;
+    }
+
+    const INT64 lNowNs = GetTimeNanoseconds();
+    s_lFrameNs = lNowNs - s_lLastFrameNs;
+    s_lLastFrameNs = lNowNs;
+
+    for (INT i = 0; i < s_nStats; i++) {
+        s_arrStats[i].nCalls = 0;
+        s_arrStats[i].lFrameNs = 0;
+    }
+
+    ProfilerThread* pThread = GetThread();
+    if (pThread) {
+        // Events that were overwritten before they could be folded are lost
+        if (pThread->nWritten - pThread->nFolded > PROFILER_RING_SIZE) {
+            pThread->nFolded = pThread->nWritten - PROFILER_RING_SIZE;
+        }
+
+        for (; pThread->nFolded < pThread->nWritten; pThread->nFolded++) {
+            const ProfileEvent* pEvent = &pThread->arrEvents[pThread->nFolded & (PROFILER_RING_SIZE - 1)];
+            ProfileScopeStats* pStats = FindStats(pEvent->pszName);
+            if (pStats) {
+                pStats->iDepth = pEvent->iDepth;
+                pStats->nCalls++;
+                pStats->lFrameNs += pEvent->lEndNs - pEvent->lStartNs;
+            }
+        }
+    }
+
+    for (INT i = 0; i < s_nStats; i++) {
+        ProfileScopeStats* pStats = &s_arrStats[i];
+        const DOUBLE fFrameMs = (DOUBLE)pStats->lFrameNs / 1000000.0;
+        pStats->fAverageMs += (fFrameMs - pStats->fAverageMs) * PROFILER_SMOOTHING;
+        if (pStats->lFrameNs > pStats->lMaxNs) {
+            pStats->lMaxNs = pStats->lFrameNs;
+        }
+    }
+}
+
+_Check_return_
+INT Profiler_GetScopeStats(
+    _Outptr_result_buffer_(return) const ProfileScopeStats** parrStats
+) {
+    *parrStats = s_arrStats;
+    return s_nStats;
+}
+
+_Check_return_
+INT64 Profiler_GetFrameTimeNanoseconds(
+    void
+) {
+    return s_lFrameNs;
+}
+
+static void WriteJsonString(
+    _Inout_ FILE* pFile,
+    _In_z_  PCSTR pszText
+) {
+    fputc('"', pFile);
+    for (PCSTR p = pszText; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', pFile);
+            fputc(*p, pFile);
+        } else if ((BYTE)*p < 0x20) {
+            fprintf(pFile, "\\u%04x", (BYTE)*p);
+        } else {
+            fputc(*p, pFile);
+        }
+    }
+    fputc('"', pFile);
+}
+
+_Check_return_opt_
+bool Profiler_ExportChromeTrace(
+    _In_z_ PCSTR pszFilename
+) {
+    if (!s_pMutex) {
+        return false;
+    }
+
+    FILE* pFile = NULL;
+    fopen_s(&pFile, pszFilename, "w");
+    if (!pFile) {
+        printf("Failed to open %s for the trace\n", pszFilename);
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", pFile);
+
+    bool bFirst = true;
+    sfMutex_lock(s_pMutex);
+    for (INT iThread = 0; iThread < s_nThreads; iThread++) {
+        const ProfilerThread* pThread = s_arrThreads[iThread];
+        const UINT64 nFirst = pThread->nWritten > PROFILER_RING_SIZE ? pThread->nWritten - PROFILER_RING_SIZE : 0;
+
+        for (UINT64 i = nFirst; i < pThread->nWritten; i++) {
+            const ProfileEvent* pEvent = &pThread->arrEvents[i & (PROFILER_RING_SIZE - 1)];
+
+            // Complete events ("ph":"X") carry start and duration in microseconds
+            fputs(bFirst ? "\n{\"name\":" : ",\n{\"name\":", pFile);
+            WriteJsonString(pFile, pEvent->pszName);
+            fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                pThread->iThread,
+                (DOUBLE)pEvent->lStartNs / 1000.0,
+                (DOUBLE)(pEvent->lEndNs - pEvent->lStartNs) / 1000.0);
+            bFirst = false;
+        }
+    }
+    sfMutex_unlock(s_pMutex);
+
+    fputs("\n]}\n", pFile);
+    const bool bWritten = ferror(pFile) == 0;
+    fclose(pFile);
+
+    if (!bWritten) {
+        printf("Failed to write the trace to %s\n", pszFilename);
+    }
+    return bWritten;
+}
@@ -0,0 +1,143 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "utils.h"
+
+#define PROFILER_RING_SIZE 8192    // << Finished scopes kept per thread; must be a power of two
+#define PROFILER_MAX_DEPTH 32      // << Deepest nesting of open scopes per thread
+#define PROFILER_MAX_THREADS 32
+#define PROFILER_MAX_SCOPES 64     // << Distinct scope names in the frame statistics
+#define PROFILER_SMOOTHING 0.1     // << Weight of the newest frame in the averaged scope times
+
+/*
+ * Instrumentation for finding where frame time goes, cheap enough to leave in release builds.
+ *
+ * Code marks scopes with `PROFILE_BEGIN` and `PROFILE_END`. Each thread writes its finished scopes into its own
+ * ring buffer, so threads never contend; once a ring is full the oldest scopes are overwritten. Time comes from
+ * the window's nanosecond clock.
+ *
+ * Once per frame, `Profiler_EndFrame` sums up the scopes the main thread finished into per-name statistics for
+ * the overlay. `Profiler_ExportChromeTrace` writes every thread's ring as Chrome trace JSON, which can be opened
+ * in chrome://tracing or Perfetto.
+ *
+ * Define PROFILER_DISABLED to compile the markers out entirely, e.g. in tools that do not link the profiler.
+ */
+
+typedef struct _ProfileEvent {
+    PCSTR pszName;             // << Must outlive the profiler, usually a string literal
+    INT64 lStartNs;
+    INT64 lEndNs;
+    INT iDepth;                // << Number of scopes that were open around this one
+} ProfileEvent;
+
+typedef struct _ProfileScopeStats {
+    PCSTR pszName;
+    INT iDepth;                // << Nesting depth the scope last ran at
+    INT nCalls;                // << Times the scope finished in the last frame
+    INT64 lFrameNs;            // << Total time in the scope in the last frame
+    INT64 lMaxNs;              // << Longest frame total since the profiler started
+    DOUBLE fAverageMs;         // << Smoothed frame total in milliseconds
+} ProfileScopeStats;
+
+#ifdef PROFILER_DISABLED
+#define PROFILE_BEGIN(pszName) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_THREAD_EXIT() ((void)0)
+#else
+#define PROFILE_BEGIN(pszName) Profiler_Begin(pszName)
+#define PROFILE_END() Profiler_End()
+#define PROFILE_THREAD_EXIT() Profiler_ReleaseThread()
+#endif
+
+/**
+ * @brief Starts recording. Markers before this call are ignored.
+ *
+ * @return `true` if the profiler is running.
+ */
+_Check_return_opt_ bool Profiler_Start(
+    void
+    );
+
+/**
+ * @brief Stops recording and frees every thread's buffer.
+ *
+ * No other thread may be inside a marker while this runs; stop worker threads first.
+ */
+void Profiler_Stop(
+    void
+    );
+
+/**
+ * @brief Hands the calling thread's buffer back, so the next thread that records scopes reuses it.
+ *
+ * Call through `PROFILE_THREAD_EXIT` before a thread that used markers exits. Otherwise its buffer stays taken
+ * until `Profiler_Stop`, and once `PROFILER_MAX_THREADS` buffers are taken new threads are not recorded. Scopes in
+ * the buffer can still be exported until another thread takes it over.
+ */
+void Profiler_ReleaseThread(
+    void
+    );
+
+/**
+ * @brief Checks whether the profiler is recording.
+ */
+_Check_return_ bool Profiler_IsRunning(
+    void
+    );
+
+/**
+ * @brief Opens a scope on the calling thread. Use `PROFILE_BEGIN` rather than calling this directly.
+ *
+ * @param pszName Name of the scope. Only the pointer is stored, so pass a string literal.
+ */
+void Profiler_Begin(
+    _In_z_ PCSTR pszName
+    );
+
+/**
+ * @brief Closes the innermost open scope on the calling thread. Use `PROFILE_END` rather than calling this.
+ */
+void Profiler_End(
+    void
+    );
+
+/**
+ * @brief Folds the scopes the calling thread finished since the last call into the frame statistics.
+ *
+ * Call once per frame from the main thread; `Window_Display` does.
+ */
+void Profiler_EndFrame(
+    void
+    );
+
+/**
+ * @brief Gets the per-scope statistics of the last frame.
+ *
+ * @param parrStats Receives the statistics, in the order the scopes were first seen. Valid until the next call to
+ *                  `Profiler_EndFrame` or `Profiler_Stop`.
+ * @return The number of scopes.
+ */
+_Check_return_ INT Profiler_GetScopeStats(
+    _Outptr_result_buffer_(return) const ProfileScopeStats** parrStats
+    );
+
+/**
+ * @brief Gets the time between the last two calls to `Profiler_EndFrame`, in nanoseconds.
+ */
+_Check_return_ INT64 Profiler_GetFrameTimeNanoseconds(
+    void
+    );
+
+/**
+ * @brief Writes the scopes still in every thread's ring buffer to a Chrome trace JSON file.
+ *
+ * Other threads should be idle, e.g. between frames, or scopes they write meanwhile may come out garbled.
+ *
+ * @param pszFilename Path of the file to write.
+ * @return `true` if the file was written.
+ */
+_Check_return_opt_ bool Profiler_ExportChromeTrace(
+    _In_z_ PCSTR pszFilename
+    );
+
+#endif //PROFILER_H
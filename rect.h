@@ -0,0 +1,28 @@
+#ifndef RECT_H
+#define RECT_H
+
+#include "utils.h"
+
+/**
+ Represents an axis-aligned rectangle in floating-point space, by its edges.
+ */
+typedef struct _RECTF {
+    FLOAT fLeft;
+    FLOAT fTop;
+    /**
+     Edges are exclusive on this side: a rectangle with `fRight == fLeft` is empty.
+     */
+    FLOAT fRight;
+    FLOAT fBottom;
+} RECTF;
+
+_Check_return_
+static inline bool Rect_Intersects(
+    _In_ const RECTF* rc1,
+    _In_ const RECTF* rc2
+) {
+    return rc1->fLeft < rc2->fRight && rc2->fLeft < rc1->fRight
+        && rc1->fTop < rc2->fBottom && rc2->fTop < rc1->fBottom;
+}
+
+#endif //RECT_H
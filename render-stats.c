@@ -0,0 +1,129 @@
+#include "render-stats.h"
+
+#include <SFML/Graphics.h>
+
+#include "window.h"
+#include "camera.h"
+
+static RenderStats s_current;
+static RenderStats s_lastFrame;
+static UINT64 s_nFrame;
+static bool s_bLogging;
+
+static const void* s_pLastTexture; // << Texture of the previous draw; only compared, never dereferenced
+static bool s_bHasLastTexture;     // << False until the first draw of a frame
+
+static void CountDraw(
+    _In_opt_ const void* pTexture,
+    _In_     const INT nVertices
+) {
+    // Views are applied lazily, right before the first draw that needs them
+    Camera_Apply();
+
+    s_current.nDrawCalls++;
+    s_current.nVertices += nVertices;
+
+    if (!s_bHasLastTexture || pTexture != s_pLastTexture) {
+        s_current.nTextureSwitches++;
+        s_pLastTexture = pTexture;
+        s_bHasLastTexture = true;
+    }
+}
+
+void RenderStats_DrawSprite(
+    _In_ const sfSprite* pSprite
+) {
+    // A sprite is a single quad drawn as a triangle strip
+    CountDraw(sfSprite_getTexture(pSprite), 4);
+    sfRenderWindow_drawSprite(Window_GetRenderWindow(), pSprite, NULL);
+}
+
+void RenderStats_DrawRectangleShape(
+    _In_ const sfRectangleShape* pShape
+) {
+    // The fill is a fan of the points around a center, closed by repeating the first point; an outline adds a strip
+    // with two vertices per point, again closed
+    const INT nPoints = (INT)sfRectangleShape_getPointCount(pShape);
+    INT nVertices = nPoints + 2;
+    if (sfRectangleShape_getOutlineThickness(pShape) != 0.0f) {
+        nVertices += (nPoints + 1) * 2;
+    }
+
+    CountDraw(sfRectangleShape_getTexture(pShape), nVertices);
+    sfRenderWindow_drawRectangleShape(Window_GetRenderWindow(), pShape, NULL);
+}
+
+void RenderStats_DrawText(
+    _In_ const sfText* pText
+) {
+    // Every visible glyph is two triangles; whitespace only advances the pen
+    INT nVertices = 0;
+    for (PCSTR p = sfText_getString(pText); *p; p++) {
+        if (*p != ' ' && *p != '\t' && *p != '\n') {
+            nVertices += 6;
+        }
+    }
+
+    // Glyphs live in a texture owned by the font, so the font stands in for it
+    CountDraw(sfText_getFont(pText), nVertices);
+    sfRenderWindow_drawText(Window_GetRenderWindow(), pText, NULL);
+}
+
+void RenderStats_CountSprite(
+    _In_ const bool bDrawn
+) {
+    if (bDrawn) {
+        s_current.nSpritesDrawn++;
+    } else {
+        s_current.nSpritesCulled++;
+    }
+}
+
+void RenderStats_SetView(
+    _In_ const sfView* pView
+) {
+    s_current.nViewChanges++;
+    sfRenderWindow_setView(Window_GetRenderWindow(), pView);
+}
+
+void RenderStats_EndFrame(
+    void
+) {
+    if (s_bLogging) {
+        printf(
+            "Frame %llu: %d draw calls, %d vertices, %d texture switches, %d view changes, %d/%d sprites culled\n",
+            (unsigned long long)s_nFrame,
+            s_current.nDrawCalls,
+            s_current.nVertices,
+            s_current.nTextureSwitches,
+            s_current.nViewChanges,
+            s_current.nSpritesCulled,
+            s_current.nSpritesDrawn + s_current.nSpritesCulled
+        );
+    }
+
+    s_lastFrame = s_current;
+    s_current = (RenderStats) { 0 };
+    s_bHasLastTexture = false;
+    s_nFrame++;
+}
+
+_Check_return_
+RenderStats RenderStats_GetCurrentFrame(
+    void
+) {
+    return s_current;
+}
+
+_Check_return_
+RenderStats RenderStats_GetLastFrame(
+    void
+) {
+    return s_lastFrame;
+}
+
+void RenderStats_SetLogging(
+    _In_ const bool bEnabled
+) {
+    s_bLogging = bEnabled;
+}
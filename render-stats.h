@@ -0,0 +1,113 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include "utils.h"
+
+typedef struct sfSprite sfSprite;
+typedef struct sfRectangleShape sfRectangleShape;
+typedef struct sfText sfText;
+typedef struct sfView sfView;
+
+/*
+ * Counts the work submitted to the render window, to check that batching actually removes draw calls.
+ *
+ * Rendering code draws through the `RenderStats_Draw*` functions and sets views through `RenderStats_SetView`
+ * instead of calling `sfRenderWindow_*` directly; the draw functions also apply the active camera's view first.
+ * The counters cover one frame; `Window_Display` closes the frame, after which `RenderStats_GetLastFrame` returns
+ * its totals.
+ *
+ * A texture switch is counted whenever a draw uses a different texture than the draw before it, which is when
+ * SFML has to rebind. Draws without a texture count as a switch to no texture.
+ */
+typedef struct _RenderStats {
+    INT nDrawCalls;
+    INT nVertices;             // << Vertices submitted, as SFML builds them for each drawable
+    INT nTextureSwitches;
+    INT nViewChanges;
+    INT nSpritesDrawn;         // << Sprites that passed the camera culling in `Sprite_Draw`
+    INT nSpritesCulled;        // << Sprites skipped because they were outside the camera's view
+} RenderStats;
+
+/**
+ * @brief Draws a sprite to the render window and counts it.
+ *
+ * @param pSprite The sprite to draw.
+ */
+void RenderStats_DrawSprite(
+    _In_ const sfSprite* pSprite
+    );
+
+/**
+ * @brief Draws a rectangle shape to the render window and counts it.
+ *
+ * @param pShape The shape to draw.
+ */
+void RenderStats_DrawRectangleShape(
+    _In_ const sfRectangleShape* pShape
+    );
+
+/**
+ * @brief Draws a text to the render window and counts it.
+ *
+ * @param pText The text to draw.
+ */
+void RenderStats_DrawText(
+    _In_ const sfText* pText
+    );
+
+/**
+ * @brief Counts a sprite that went through view culling.
+ *
+ * @param bDrawn `true` if the sprite was on screen and drawn, `false` if it was culled.
+ */
+void RenderStats_CountSprite(
+    _In_ bool bDrawn
+    );
+
+/**
+ * @brief Sets the view of the render window and counts the change.
+ *
+ * @param pView The view to use.
+ */
+void RenderStats_SetView(
+    _In_ const sfView* pView
+    );
+
+/**
+ * @brief Closes the current frame. Called by `Window_Display`.
+ *
+ * The frame's counters become the ones returned by `RenderStats_GetLastFrame`, are printed when logging is on,
+ * and start again from zero.
+ */
+void RenderStats_EndFrame(
+    void
+    );
+
+/**
+ * @brief Gets the counters of the frame in progress.
+ *
+ * @return The counters since the last call to `RenderStats_EndFrame`.
+ */
+_Check_return_ RenderStats RenderStats_GetCurrentFrame(
+    void
+    );
+
+/**
+ * @brief Gets the counters of the last completed frame.
+ *
+ * @return The counters of the frame closed by the last call to `RenderStats_EndFrame`.
+ */
+_Check_return_ RenderStats RenderStats_GetLastFrame(
+    void
+    );
+
+/**
+ * @brief Turns printing the counters at the end of every frame on or off. Off by default.
+ *
+ * @param bEnabled `true` to print the counters of each frame.
+ */
+void RenderStats_SetLogging(
+    _In_ bool bEnabled
+    );
+
+#endif //RENDER_STATS_H
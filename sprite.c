@@ -11,6 +11,47 @@
 #include "window.h"
 #include "camera.h"
 #include "texture.h"
+#include "render-stats.h"
+#include "pool.h"
+
+static Pool s_spritePool = POOL_INIT(Sprite);
+
+static void UpdateBounds(
+    _Inout_ Sprite* pSprite
+) {
+    // A negative scale mirrors the sprite to the other side of its position
+    const FLOAT x2 = pSprite->x + pSprite->fRectWidth * pSprite->fScaleX;
+    const FLOAT y2 = pSprite->y + pSprite->fRectHeight * pSprite->fScaleY;
+    pSprite->rcBounds.fLeft = x2 < pSprite->x ? x2 : pSprite->x;
+    pSprite->rcBounds.fRight = x2 < pSprite->x ? pSprite->x : x2;
+    pSprite->rcBounds.fTop = y2 < pSprite->y ? y2 : pSprite->y;
+    pSprite->rcBounds.fBottom = y2 < pSprite->y ? pSprite->y : y2;
+}
+
+/**
+ * Picks up the size of a texture that was reloaded since the rect was set. Only sprites showing the whole texture
+ * change; a rect chosen by the owner, like an animation frame, is kept.
+ */
+static void SyncTextureSize(
+    _Inout_ Sprite* pSprite
+) {
+    if (pSprite->uTextureVersion == pSprite->pTexture->uVersion) {
+        return;
+    }
+
+    pSprite->uTextureVersion = pSprite->pTexture->uVersion;
+    if (!pSprite->bWholeTexture) {
+        return;
+    }
+
+    pSprite->fRectWidth = pSprite->pTexture->fWidth;
+    pSprite->fRectHeight = pSprite->pTexture->fHeight;
+    sfSprite_setTextureRect(
+        pSprite->pSpriteHandle,
+        (sfIntRect) { 0, 0, (INT)pSprite->fRectWidth, (INT)pSprite->fRectHeight }
+    );
+    UpdateBounds(pSprite);
+}
 
 _Check_return_ _Ret_maybenull_
 Sprite* Sprite_Create(
@@ -18,7 +59,7 @@ Sprite* Sprite_Create(
     _In_ const FLOAT x,
     _In_ const FLOAT y
 ) {
-    Sprite* pSprite = malloc(sizeof(Sprite));
+    Sprite* pSprite = Pool_Alloc(&s_spritePool);
     if (!pSprite) {
         printf("Failed to allocate memory for Sprite\n");
         return NULL;
@@ -27,7 +68,7 @@ Sprite* Sprite_Create(
     pSprite->pSpriteHandle = sfSprite_create();
     if (!pSprite->pSpriteHandle) {
         printf("Failed to create sprite handle\n");
-        SafeFree(pSprite);
+        Pool_Free(&s_spritePool, pSprite);
         return NULL;
     }
 
@@ -39,6 +80,12 @@ Sprite* Sprite_Create(
     pSprite->fScaleX = 1.0f;
     pSprite->fScaleY = 1.0f;
     pSprite->bVisible = true;
+    pSprite->fRectWidth = pTexture->fWidth;
+    pSprite->fRectHeight = pTexture->fHeight;
+    pSprite->pTexture = pTexture;
+    pSprite->uTextureVersion = pTexture->uVersion;
+    pSprite->bWholeTexture = true;
+    UpdateBounds(pSprite);
 
     return pSprite;
 }
@@ -58,6 +105,7 @@ void Sprite_SetScale(
     pSprite->fScaleX = fScaleX;
     pSprite->fScaleY = fScaleY;
     sfSprite_setScale(pSprite->pSpriteHandle, (sfVector2f) { fScaleX, fScaleY });
+    UpdateBounds(pSprite);
 }
 
 void Sprite_SetX(
@@ -66,6 +114,7 @@ void Sprite_SetX(
 ) {
     pSprite->x = x;
     sfSprite_setPosition(pSprite->pSpriteHandle, (sfVector2f) { x, pSprite->y });
+    UpdateBounds(pSprite);
 }
 
 void Sprite_SetY(
@@ -74,6 +123,7 @@ void Sprite_SetY(
 ) {
     pSprite->y = y;
     sfSprite_setPosition(pSprite->pSpriteHandle, (sfVector2f) { pSprite->x, y });
+    UpdateBounds(pSprite);
 }
 
 void Sprite_SetPosition(
@@ -84,6 +134,7 @@ void Sprite_SetPosition(
     pSprite->x = x;
     pSprite->y = y;
     sfSprite_setPosition(pSprite->pSpriteHandle, (sfVector2f) { x, y });
+    UpdateBounds(pSprite);
 }
 
 void Sprite_SetTexture(
@@ -91,16 +142,46 @@ void Sprite_SetTexture(
     _In_    const Texture* pTexture
 ) {
     sfSprite_setTexture(pSprite->pSpriteHandle, pTexture->pBitmap, true);
+    pSprite->fRectWidth = pTexture->fWidth;
+    pSprite->fRectHeight = pTexture->fHeight;
+    pSprite->pTexture = pTexture;
+    pSprite->uTextureVersion = pTexture->uVersion;
+    pSprite->bWholeTexture = true;
+    UpdateBounds(pSprite);
+}
+
+void Sprite_SetTextureRect(
+    _Inout_ Sprite* pSprite,
+    _In_    const INT x,
+    _In_    const INT y,
+    _In_    const INT iWidth,
+    _In_    const INT iHeight
+) {
+    sfSprite_setTextureRect(pSprite->pSpriteHandle, (sfIntRect) { x, y, iWidth, iHeight });
+    pSprite->fRectWidth = (FLOAT)iWidth;
+    pSprite->fRectHeight = (FLOAT)iHeight;
+    pSprite->uTextureVersion = pSprite->pTexture->uVersion;
+    pSprite->bWholeTexture = false;
+    UpdateBounds(pSprite);
 }
 
 void Sprite_Draw(
-    _In_ const Sprite* pSprite
+    _Inout_ Sprite* pSprite
 ) {
     if (!pSprite->bVisible) {
         return;
     }
 
-    sfRenderWindow_drawSprite(Window_GetRenderWindow(), pSprite->pSpriteHandle, NULL);
+    SyncTextureSize(pSprite);
+
+    const RECTF rcView = Camera_GetVisibleBounds();
+    if (!Rect_Intersects(&pSprite->rcBounds, &rcView)) {
+        RenderStats_CountSprite(false);
+        return;
+    }
+
+    RenderStats_CountSprite(true);
+    RenderStats_DrawSprite(pSprite->pSpriteHandle);
 }
 
 _Check_return_
@@ -140,6 +221,12 @@ bool Sprite_Destroy(
     }
 
     sfSprite_destroy(pSprite->pSpriteHandle);
-    SafeFree(pSprite);
+    Pool_Free(&s_spritePool, pSprite);
     return true;
 }
+
+void Sprite_Shutdown(
+    void
+) {
+    Pool_Release(&s_spritePool);
+}
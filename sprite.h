@@ -7,10 +7,15 @@
 
 #include "utils.h"
 #include "vector2.h"
+#include "rect.h"
 
 typedef struct _Texture Texture;
 typedef struct sfSprite sfSprite;
 
+/*
+ * A textured rectangle in world space. Its world bounds are kept up to date by every setter, and after a texture
+ * reload by `Sprite_Draw`, so `Sprite_Draw` can skip sprites outside the camera's view without touching SFML.
+ */
 typedef struct _Sprite {
     sfSprite* pSpriteHandle;
     FLOAT x;
@@ -18,6 +23,12 @@ typedef struct _Sprite {
     FLOAT fScaleX;
     FLOAT fScaleY;
     bool bVisible;
+    FLOAT fRectWidth;          // << Size of the part of the texture that is drawn
+    FLOAT fRectHeight;
+    RECTF rcBounds;            // << World-space rectangle the sprite covers
+    const Texture* pTexture;
+    UINT uTextureVersion;      // << `pTexture->uVersion` when the rect was last set
+    bool bWholeTexture;        // << Shows the whole texture rather than a rect, so follows its size on reload
 } Sprite;
 
 /**
@@ -121,8 +132,33 @@ void Sprite_SetTexture(
     _In_    const Texture* pTexture
     );
 
+/**
+ * @brief Selects the part of the texture the sprite shows, e.g. one frame of a sprite sheet.
+ *
+ * @param pSprite Pointer to the Sprite.
+ * @param x       Left edge of the part, in texels.
+ * @param y       Top edge of the part, in texels.
+ * @param iWidth  Width of the part, in texels.
+ * @param iHeight Height of the part, in texels.
+ */
+void Sprite_SetTextureRect(
+    _Inout_ Sprite* pSprite,
+    _In_    INT x,
+    _In_    INT y,
+    _In_    INT iWidth,
+    _In_    INT iHeight
+    );
+
+/**
+ * @brief Draws a sprite if it is visible and inside the active camera's view.
+ *
+ * Sprites outside `Camera_GetVisibleBounds` are skipped and counted as culled in the render statistics. A sprite
+ * showing the whole texture first takes on the texture's new size if it was reloaded.
+ *
+ * @param pSprite Pointer to the Sprite to draw.
+ */
 void Sprite_Draw(
-    _In_ const Sprite* pSprite
+    _Inout_ Sprite* pSprite
     );
 
 /**
@@ -188,4 +224,13 @@ _Check_return_opt_ bool Sprite_Destroy(
     _Inout_ _Pre_valid_ _Post_invalid_ Sprite* pSprite
     );
 
+/**
+ * @brief Frees the memory pool that sprites are allocated from.
+ *
+ * Call once at shutdown, after every one of them is destroyed.
+ */
+void Sprite_Shutdown(
+    void
+    );
+
 #endif //SPRITE_H
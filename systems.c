@@ -0,0 +1,203 @@
+#include "systems.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "unit.h"
+#include "tilemap.h"
+#include "sprite.h"
+#include "animated-sprite.h"
+#include "profiler.h"
+
+/*
+ * Arguments of `MovementSystem_Update` for each entity.
+ */
+typedef struct _MovementTick {
+    const Tilemap* pTilemap;
+    FLOAT fDeltaSeconds;
+} MovementTick;
+
+/**
+ * Claims the tile at `iPathStep` and starts moving towards it. Steps that do not move the unit, like a path that
+ * begins on the unit's own tile or repeats a tile, are claimed and passed over right away, so they cannot stall the
+ * path. A tile another unit stepped onto after the path was planned stops the unit where it stands, and the rest of
+ * the path is dropped.
+ */
+_Check_return_opt_
+static bool StartStep(
+    _In_    const WorldPosition* pPosition,
+    _Inout_ UnitMotion* pMotion,
+    _Inout_ UnitPath* pPath,
+    _In_    const Unit* pUnit,
+    _In_    const Tilemap* pTilemap
+) {
+    for (;;) {
+        const POINT ptTarget = pPath->arrPath[pPath->iPathStep];
+        if (!UnitGroup_SetTilePosition(pUnit->pGroup, pUnit->iGroupIndex, ptTarget)) {
+            pPath->nPathLength = 0;
+            pPath->iPathStep = 0;
+            return false;
+        }
+
+        const VECTOR2 vStartPos = pPosition->vPosition;
+        const VECTOR2 vTargetPos = CreateVector2(
+            (FLOAT)ptTarget.x * pTilemap->fTileWidth,
+            (FLOAT)ptTarget.y * pTilemap->fTileHeight
+        );
+
+        const FLOAT dx = vTargetPos.x - vStartPos.x;
+        const FLOAT dy = vTargetPos.y - vStartPos.y;
+        const FLOAT distance = sqrtf(dx * dx + dy * dy);
+
+        if (distance > 0.0f) {
+            pMotion->vStart = vStartPos;
+            pMotion->vTarget = vTargetPos;
+            pMotion->fMoveDuration = distance / pMotion->fMoveSpeed;
+            pMotion->fMoveElapsed = 0.0f;
+            pMotion->bIsMoving = true;
+            return true;
+        }
+
+        if (pPath->iPathStep + 1 >= pPath->nPathLength) {
+            return true; // << The path ends where the unit already stands
+        }
+        pPath->iPathStep++;
+    }
+}
+
+_Check_return_opt_
+bool MovementSystem_StartPath(
+    _Inout_             EcsWorld* pWorld,
+    _In_                const Entity entity,
+    _In_                const Tilemap* pTilemap,
+    _In_reads_(nLength) const POINT* arrPath,
+    _In_                const INT nLength
+) {
+    const WorldPosition* pPosition = Ecs_GetComponent(pWorld, entity, ECS_COMPONENT_POSITION);
+    UnitMotion* pMotion = Ecs_GetComponent(pWorld, entity, ECS_COMPONENT_MOTION);
+    UnitPath* pPath = Ecs_GetComponent(pWorld, entity, ECS_COMPONENT_PATH);
+    Unit** ppUnit = Ecs_GetComponent(pWorld, entity, ECS_COMPONENT_UNIT);
+    if (!pPosition || !pMotion || !pPath || !ppUnit || nLength < 0 || nLength > UNIT_MAX_PATH_LENGTH) {
+        return false;
+    }
+
+    memcpy(pPath->arrPath, arrPath, nLength * sizeof(POINT));
+    pPath->nPathLength = nLength;
+    pPath->iPathStep = 0;
+
+    if (nLength > 0) {
+        return StartStep(pPosition, pMotion, pPath, *ppUnit, pTilemap);
+    }
+    return true;
+}
+
+static void UpdateMovement(
+    _In_ void* pUserData,
+    _In_ const Entity entity,
+    _In_ void* const* arrComponents
+) {
+    UnusedParam(entity);
+    const MovementTick* pTick = pUserData;
+    WorldPosition* pPosition = arrComponents[0];
+    UnitMotion* pMotion = arrComponents[1];
+    UnitPath* pPath = arrComponents[2];
+    const Unit* pUnit = *(Unit**)arrComponents[3];
+
+    pPosition->vPrevPosition = pPosition->vPosition;
+
+    FLOAT fRemaining = pTick->fDeltaSeconds;
+    while (pMotion->bIsMoving && fRemaining > 0.0f) {
+        const FLOAT fStepLeft = pMotion->fMoveDuration - pMotion->fMoveElapsed;
+        if (fRemaining < fStepLeft) {
+            pMotion->fMoveElapsed += fRemaining;
+            pPosition->vPosition = Vector2Lerp(pMotion->vStart, pMotion->vTarget, pMotion->fMoveElapsed / pMotion->fMoveDuration);
+            return;
+        }
+
+        fRemaining -= fStepLeft;
+        pPosition->vPosition = pMotion->vTarget;
+        pMotion->bIsMoving = false;
+
+        if (pPath->iPathStep + 1 < pPath->nPathLength) {
+            pPath->iPathStep++;
+            StartStep(pPosition, pMotion, pPath, pUnit, pTick->pTilemap);
+        }
+    }
+}
+
+void MovementSystem_Update(
+    _Inout_ EcsWorld* pWorld,
+    _In_    const Tilemap* pTilemap,
+    _In_    const FLOAT fDeltaSeconds
+) {
+    static const EcsComponent arrComponents[] = {
+        ECS_COMPONENT_POSITION, ECS_COMPONENT_MOTION, ECS_COMPONENT_PATH, ECS_COMPONENT_UNIT
+    };
+
+    // Steps that end move units on the occupancy grid, which is shared, so this runs on one thread
+    MovementTick tick = { pTilemap, fDeltaSeconds };
+    Ecs_Each(pWorld, arrComponents, (INT)ArraySize(arrComponents), UpdateMovement, &tick);
+}
+
+static void UpdateAnimation(
+    _In_opt_ void* pUserData,
+    _In_ const Entity entity,
+    _In_ void* const* arrComponents
+) {
+    UnusedParam(pUserData);
+    UnusedParam(entity);
+    const AnimatedSprite* pAnimSprite = *(AnimatedSprite**)arrComponents[0];
+
+    AnimatedSprite_Update(pAnimSprite);
+    AnimatedSprite_ApplyFrame(pAnimSprite);
+}
+
+void AnimationSystem_Update(
+    _Inout_     EcsWorld* pWorld,
+    _Inout_opt_ JobSystem* pJobs
+) {
+    static const EcsComponent arrComponents[] = { ECS_COMPONENT_ANIMATION };
+
+    PROFILE_BEGIN("AnimationSystem_Update");
+    Ecs_EachParallel(pWorld, pJobs, arrComponents, 1, UpdateAnimation, NULL);
+    PROFILE_END();
+}
+
+static void PlaceSprite(
+    _In_ void* pUserData,
+    _In_ const Entity entity,
+    _In_ void* const* arrComponents
+) {
+    UnusedParam(entity);
+    const FLOAT fAlpha = *(const FLOAT*)pUserData;
+    const WorldPosition* pPosition = arrComponents[0];
+    Sprite* pSprite = *(Sprite**)arrComponents[1];
+
+    const VECTOR2 vDrawPos = Vector2Lerp(pPosition->vPrevPosition, pPosition->vPosition, fAlpha);
+    Sprite_SetPosition(pSprite, vDrawPos.x, vDrawPos.y);
+}
+
+static void DrawSprite(
+    _In_opt_ void* pUserData,
+    _In_ const Entity entity,
+    _In_ void* const* arrComponents
+) {
+    UnusedParam(pUserData);
+    UnusedParam(entity);
+    Sprite_Draw(*(Sprite**)arrComponents[0]);
+}
+
+void RenderSystem_Draw(
+    _Inout_ EcsWorld* pWorld,
+    _In_    const FLOAT fAlpha
+) {
+    static const EcsComponent arrPlaced[] = { ECS_COMPONENT_POSITION, ECS_COMPONENT_SPRITE };
+    static const EcsComponent arrDrawn[] = { ECS_COMPONENT_SPRITE };
+
+    PROFILE_BEGIN("RenderSystem_Draw");
+    // Sprites of entities without a position are drawn wherever their owner put them
+    FLOAT fBlend = fAlpha;
+    Ecs_Each(pWorld, arrPlaced, (INT)ArraySize(arrPlaced), PlaceSprite, &fBlend);
+    Ecs_Each(pWorld, arrDrawn, (INT)ArraySize(arrDrawn), DrawSprite, NULL);
+    PROFILE_END();
+}
@@ -0,0 +1,84 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include "utils.h"
+#include "point.h"
+#include "ecs.h"
+
+typedef struct _Tilemap Tilemap;
+
+/*
+ * Systems that act on the entities of an `EcsWorld`. Each one walks the entities that have the components it
+ * needs, so everything that moves, animates or draws the same way shares one loop, whatever it is.
+ *
+ * Per simulation tick:      MovementSystem_Update
+ * Per rendered frame:       AnimationSystem_Update, then RenderSystem_Draw
+ */
+
+/**
+ * @brief Starts an entity walking along a path, one tile per step.
+ *
+ * The entity needs position, motion, path and unit components; the unit's tile changes to each step's target
+ * when the step starts. If another unit holds that tile by then, the entity stops and drops the rest of the path.
+ *
+ * @param pWorld   Pointer to the `EcsWorld`.
+ * @param entity   The entity to move.
+ * @param pTilemap Pointer to the `Tilemap` used to convert tiles to world positions.
+ * @param arrPath  Tiles to walk through, starting with the first step and ending on the destination.
+ * @param nLength  Number of tiles in `arrPath`, at most `UNIT_MAX_PATH_LENGTH`.
+ * @return `true` if the path was started, `false` if the entity lacks a component, the path is too long or its
+ *         first tile is taken by another unit.
+ */
+_Check_return_opt_ bool MovementSystem_StartPath(
+    _Inout_             EcsWorld* pWorld,
+    _In_                Entity entity,
+    _In_                const Tilemap* pTilemap,
+    _In_reads_(nLength) const POINT* arrPath,
+    _In_                INT nLength
+    );
+
+/**
+ * @brief Advances every entity with position, motion, path and unit components by one simulation tick.
+ *
+ * Moves each entity along its current step and starts the next step of its path once a step is done. Time left
+ * over from a finished step carries into the next one, so the distance covered depends only on the total time
+ * and not on how it is split into ticks.
+ *
+ * @param pWorld        Pointer to the `EcsWorld`.
+ * @param pTilemap      Pointer to the `Tilemap` used to convert tiles to world positions.
+ * @param fDeltaSeconds Length of the tick in seconds.
+ */
+void MovementSystem_Update(
+    _Inout_ EcsWorld* pWorld,
+    _In_    const Tilemap* pTilemap,
+    _In_    FLOAT fDeltaSeconds
+    );
+
+/**
+ * @brief Advances the animation of every entity with an animation component and shows its current frame.
+ *
+ * Each animation only touches its own sprite, so the work is spread over the job system when one is given.
+ *
+ * @param pWorld Pointer to the `EcsWorld`.
+ * @param pJobs  Job system to run on, or `NULL` to run on the calling thread.
+ */
+void AnimationSystem_Update(
+    _Inout_     EcsWorld* pWorld,
+    _Inout_opt_ JobSystem* pJobs
+    );
+
+/**
+ * @brief Draws the sprite of every entity with a sprite component.
+ *
+ * Sprites of entities that also have a position are first placed between the entity's last two simulated
+ * positions. Drawing does not change the simulation.
+ *
+ * @param pWorld Pointer to the `EcsWorld`.
+ * @param fAlpha Blend factor from the previous tick's position (0) to the latest one (1).
+ */
+void RenderSystem_Draw(
+    _Inout_ EcsWorld* pWorld,
+    _In_    FLOAT fAlpha
+    );
+
+#endif //SYSTEMS_H
@@ -0,0 +1,86 @@
+#include "terrain.h"
+
+#include <string.h>
+
+#include "tilemap.h"
+
+_Check_return_ _Ret_maybenull_
+TerrainMap* TerrainMap_Create(
+    _In_ const INT nWidth,
+    _In_ const INT nHeight
+) {
+    if (nWidth <= 0 || nHeight <= 0) {
+        return NULL;
+    }
+
+    TerrainMap* pTerrain = malloc(sizeof(TerrainMap));
+    if (!pTerrain) {
+        printf("Failed to allocate memory for TerrainMap\n");
+        return NULL;
+    }
+
+    pTerrain->nWidth = nWidth;
+    pTerrain->nHeight = nHeight;
+    pTerrain->uVersion = 0;
+    pTerrain->arrCosts = malloc((size_t)nWidth * nHeight);
+    if (!pTerrain->arrCosts) {
+        printf("Failed to allocate memory for terrain costs\n");
+        SafeFree(pTerrain);
+        return NULL;
+    }
+
+    memset(pTerrain->arrCosts, 1, (size_t)nWidth * nHeight);
+    return pTerrain;
+}
+
+_Check_return_ _Ret_maybenull_
+TerrainMap* TerrainMap_CreateFromLayer(
+    _In_                               const Tilemap* pTilemap,
+    _In_                               const INT iLayer,
+    _In_reads_opt_(TERRAIN_TILE_TYPES) const BYTE* arrTileCosts
+) {
+    if (iLayer < 0 || iLayer >= pTilemap->nCount || !pTilemap->arrLayers[iLayer].arrTiles) {
+        printf("Tilemap has no layer %d to build terrain from\n", iLayer);
+        return NULL;
+    }
+
+    const Layer* pLayer = &pTilemap->arrLayers[iLayer];
+    TerrainMap* pTerrain = TerrainMap_Create(pLayer->usWidth, pLayer->usHeight);
+    if (!pTerrain || !arrTileCosts) {
+        return pTerrain;
+    }
+
+    const INT nTiles = pTerrain->nWidth * pTerrain->nHeight;
+    for (INT i = 0; i < nTiles; i++) {
+        const BYTE byCost = arrTileCosts[pLayer->arrTiles[i]];
+        pTerrain->arrCosts[i] = byCost == 0 ? 1 : byCost;
+    }
+
+    return pTerrain;
+}
+
+void TerrainMap_SetCost(
+    _Inout_ TerrainMap* pTerrain,
+    _In_    const POINT ptTile,
+    _In_    const BYTE byCost
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pTerrain->nWidth || ptTile.y >= pTerrain->nHeight) {
+        return;
+    }
+
+    pTerrain->arrCosts[ptTile.y * pTerrain->nWidth + ptTile.x] = byCost == 0 ? 1 : byCost;
+    pTerrain->uVersion++;
+}
+
+_Check_return_opt_
+bool TerrainMap_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ TerrainMap* pTerrain
+) {
+    if (!pTerrain) {
+        return false;
+    }
+
+    SafeFree(pTerrain->arrCosts);
+    SafeFree(pTerrain);
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "utils.h"
+#include "point.h"
+
+typedef struct _Tilemap Tilemap;
+
+#define TERRAIN_COST_IMPASSABLE 0xFF // << Tiles with this cost can never be entered
+#define TERRAIN_TILE_TYPES 256       // << One cost per tile id of a layer
+
+/*
+ * Movement cost of every tile of a map, stored as one flat row-major array so the pathfinders can index it
+ * directly. Costs are the movement points spent to enter a tile, from 1 to 254.
+ */
+typedef struct _TerrainMap {
+    INT nWidth;
+    INT nHeight;
+    BYTE* arrCosts;      // << nWidth * nHeight costs, row-major
+    UINT uVersion;       // << Incremented by every change, so cached searches can tell they are stale
+} TerrainMap;
+
+/**
+ * @brief Creates a terrain map where every tile costs one movement point.
+ *
+ * @param nWidth  Width of the map in tiles.
+ * @param nHeight Height of the map in tiles.
+ * @return A pointer to the new `TerrainMap`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ TerrainMap* TerrainMap_Create(
+    _In_ INT nWidth,
+    _In_ INT nHeight
+    );
+
+/**
+ * @brief Creates a terrain map from the tile ids of a tilemap layer.
+ *
+ * Every tile id is translated through `arrTileCosts`, so e.g. all forest tiles can cost 2 and all water tiles
+ * be impassable.
+ *
+ * @param pTilemap     Pointer to the `Tilemap` that owns the layer.
+ * @param iLayer       Index of the layer that describes the terrain.
+ * @param arrTileCosts Movement cost for each tile id, or `NULL` to give every tile a cost of 1.
+ * @return A pointer to the new `TerrainMap`, or `NULL` if the layer does not exist or the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ TerrainMap* TerrainMap_CreateFromLayer(
+    _In_                               const Tilemap* pTilemap,
+    _In_                               INT iLayer,
+    _In_reads_opt_(TERRAIN_TILE_TYPES) const BYTE* arrTileCosts
+    );
+
+/**
+ * @brief Changes the cost of a single tile, e.g. when a bridge is destroyed.
+ *
+ * @param pTerrain Pointer to the `TerrainMap` to change.
+ * @param ptTile   Tile to change. Tiles outside the map are ignored.
+ * @param byCost   New cost, or `TERRAIN_COST_IMPASSABLE`.
+ */
+void TerrainMap_SetCost(
+    _Inout_ TerrainMap* pTerrain,
+    _In_    POINT ptTile,
+    _In_    BYTE byCost
+    );
+
+/**
+ * @brief Gets the cost of entering a tile.
+ *
+ * @return The cost, or `TERRAIN_COST_IMPASSABLE` for tiles outside the map.
+ */
+_Check_return_
+static inline BYTE TerrainMap_GetCost(
+    _In_ const TerrainMap* pTerrain,
+    _In_ const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pTerrain->nWidth || ptTile.y >= pTerrain->nHeight) {
+        return TERRAIN_COST_IMPASSABLE;
+    }
+    return pTerrain->arrCosts[ptTile.y * pTerrain->nWidth + ptTile.x];
+}
+
+/**
+ * @brief Destroys a terrain map and frees its resources.
+ *
+ * @param pTerrain Pointer to the `TerrainMap` to destroy.
+ * @return `true` if the terrain map was destroyed, `false` if `pTerrain` was `NULL`.
+ */
+_Check_return_opt_ bool TerrainMap_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ TerrainMap* pTerrain
+    );
+
+#endif //TERRAIN_H
@@ -9,6 +9,8 @@
 #include <string.h>
 
 #include "texture.h"
+#include "asset-watcher.h"
+#include "profiler.h"
 #include "utils.h"
 
 _Check_return_ _Ret_maybenull_
@@ -48,7 +50,9 @@ Result TextureManager_LoadTexture(
         pManager->arrTextureEntries = arrEntries;
     }
 
+    PROFILE_BEGIN("TextureManager_LoadTexture");
     Texture* pTexture = Texture_Create(pszFilename);
+    PROFILE_END();
     if (!pTexture) {
         return RESULT_MALLOC_FAILED;
     }
@@ -57,6 +61,8 @@ Result TextureManager_LoadTexture(
     pManager->arrTextureEntries[pManager->nCount].pTexture = pTexture;
     pManager->nCount++;
 
+    AssetWatcher_Watch(ASSET_KIND_TEXTURE, pTexture, 0, pszFilename);
+
     return RESULT_SUCCESS;
 }
 
@@ -9,6 +9,8 @@
 #include <SFML/Graphics.h>
 
 #include "window.h"
+#include "file.h"
+#include "asset-watcher.h"
 
 _Check_return_ _Ret_maybenull_
 Texture* Texture_Create(
@@ -22,7 +24,18 @@ Texture* Texture_Create(
 
     pTexture->color = (Color) { 255, 255, 255, 255 };
     pTexture->pszFilename = pszFilename;
-    pTexture->pBitmap = sfTexture_createFromFile(pszFilename, NULL);
+    pTexture->uVersion = 0;
+
+    // Goes through File_Map so textures resolve through mounted packs without an extra copy
+    FileView* pView = File_Map(pszFilename);
+    if (!pView) {
+        printf("Failed to open texture file %s\n", pszFilename);
+        SafeFree(pTexture);
+        return NULL;
+    }
+
+    pTexture->pBitmap = sfTexture_createFromMemory(FileView_GetData(pView), FileView_GetSize(pView), NULL);
+    File_Unmap(pView);
     if (!pTexture->pBitmap) {
         printf("Failed to load texture from %s\n", pszFilename);
         SafeFree(pTexture);
@@ -47,6 +60,27 @@ void Texture_SetColor(
     // SDL_SetTextureAlphaMod(pTexture->pBitmap, color.a);
 }
 
+_Check_return_opt_
+bool Texture_ReloadFromImage(
+    _Inout_ Texture* pTexture,
+    _In_    const sfImage* pImage
+) {
+    sfTexture* pBitmap = sfTexture_createFromImage(pImage, NULL);
+    if (!pBitmap) {
+        printf("Failed to upload reloaded texture %s\n", pTexture->pszFilename);
+        return false;
+    }
+
+    sfTexture_swap(pTexture->pBitmap, pBitmap);
+    sfTexture_destroy(pBitmap);
+
+    const sfVector2u vTextureSize = sfTexture_getSize(pTexture->pBitmap);
+    pTexture->fWidth = (FLOAT)vTextureSize.x;
+    pTexture->fHeight = (FLOAT)vTextureSize.y;
+    pTexture->uVersion++;
+    return true;
+}
+
 _Check_return_opt_
 bool Texture_Destroy(
     _Inout_ _Post_invalid_ Texture* pTexture
@@ -55,6 +89,8 @@ bool Texture_Destroy(
         return false;
     }
 
+    AssetWatcher_Unwatch(pTexture);
+
     sfTexture_destroy(pTexture->pBitmap);
     SafeFree(pTexture);
     return true;
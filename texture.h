@@ -9,6 +9,7 @@
 #include "color.h"
 
 typedef struct sfTexture sfTexture;
+typedef struct sfImage sfImage;
 
 typedef struct _Texture {
     sfTexture* pBitmap;
@@ -16,6 +17,7 @@ typedef struct _Texture {
     FLOAT fHeight;
     PCSTR pszFilename;
     Color color;
+    UINT uVersion;             // << Bumped by every reload, so sprites notice that the size may have changed
 } Texture;
 
 /**
@@ -45,6 +47,22 @@ void Texture_SetColor(
     _In_    Color color
     );
 
+/**
+ * @brief Replaces the pixels of a texture with a decoded image.
+ *
+ * The new pixels are uploaded into a fresh bitmap which is then swapped with the current one, so sprites and
+ * tilemaps that reference the texture pick up the change without being touched. Sprites showing the whole texture
+ * take on a new size the next time they are drawn. Must be called on the thread that renders.
+ *
+ * @param pTexture Pointer to the Texture to update.
+ * @param pImage   Decoded image with the new pixels.
+ * @return `true` if the texture was updated, `false` if the upload failed and the old pixels were kept.
+ */
+_Check_return_opt_ bool Texture_ReloadFromImage(
+    _Inout_ Texture* pTexture,
+    _In_    const sfImage* pImage
+    );
+
 /**
  * @brief Destroys a texture and frees its resources.
  *
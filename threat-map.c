@@ -0,0 +1,354 @@
+#include "threat-map.h"
+
+#include <string.h>
+
+#include "terrain.h"
+#include "move-range.h"
+#include "unit.h"
+#include "unit-group.h"
+
+_Check_return_ _Ret_maybenull_
+ThreatMap* ThreatMap_Create(
+    _In_ const INT nWidth,
+    _In_ const INT nHeight
+) {
+    if (nWidth <= 0 || nHeight <= 0) {
+        return NULL;
+    }
+
+    ThreatMap* pThreat = calloc(1, sizeof(ThreatMap));
+    if (!pThreat) {
+        printf("Failed to allocate memory for ThreatMap\n");
+        return NULL;
+    }
+
+    const size_t nTiles = (size_t)nWidth * nHeight;
+    pThreat->nWidth = nWidth;
+    pThreat->nHeight = nHeight;
+
+    pThreat->arrCounts = calloc(nTiles, sizeof(UINT16));
+    pThreat->arrMaxDamage = calloc(nTiles, sizeof(INT));
+    pThreat->arrVisited = calloc(nTiles, sizeof(UINT));
+    pThreat->arrDirty = calloc(nTiles, sizeof(UINT));
+    pThreat->arrQueue = malloc(nTiles * sizeof(INT));
+    pThreat->arrDirtyTiles = malloc(nTiles * sizeof(INT));
+    pThreat->pRange = MoveRange_Create(nWidth, nHeight);
+    if (!pThreat->arrCounts || !pThreat->arrMaxDamage || !pThreat->arrVisited || !pThreat->arrDirty ||
+        !pThreat->arrQueue || !pThreat->arrDirtyTiles || !pThreat->pRange) {
+        printf("Failed to allocate memory for threat map arrays\n");
+        ThreatMap_Destroy(pThreat);
+        return NULL;
+    }
+
+    return pThreat;
+}
+
+static void MarkDirty(
+    _Inout_ ThreatMap* pThreat,
+    _In_    const INT iTile
+) {
+    if (pThreat->arrDirty[iTile] != pThreat->uDirtyGeneration) {
+        pThreat->arrDirty[iTile] = pThreat->uDirtyGeneration;
+        pThreat->arrDirtyTiles[pThreat->nDirtyTiles++] = iTile;
+    }
+}
+
+static void AddFootprint(
+    _Inout_ ThreatMap* pThreat,
+    _In_    const ThreatSource* pSource,
+    _In_    const INT nDelta
+) {
+    for (INT i = 0; i < pSource->nTiles; i++) {
+        const INT iTile = pSource->arrTiles[i];
+        pThreat->arrCounts[iTile] = (UINT16)(pThreat->arrCounts[iTile] + nDelta);
+        MarkDirty(pThreat, iTile);
+    }
+}
+
+/*
+ * Floods the unit's movement range, then grows it ring by ring up to the attack range. Rings are kept apart in
+ * the queue, so this is a breadth-first search from every reachable tile at once and each tile is visited once.
+ */
+_Check_return_
+static bool ComputeFootprint(
+    _Inout_ ThreatMap* pThreat,
+    _In_    const TerrainMap* pTerrain,
+    _Inout_ ThreatSource* pSource
+) {
+    pSource->nTiles = 0;
+
+    const INT nWidth = pThreat->nWidth;
+    const INT nHeight = pThreat->nHeight;
+    const INT nReached = MoveRange_Compute(pThreat->pRange, pTerrain, pSource->ptTile, pSource->nMovePoints);
+    if (nReached == 0) {
+        return true;
+    }
+
+    pThreat->uVisitGeneration++;
+    if (pThreat->uVisitGeneration == 0) {
+        memset(pThreat->arrVisited, 0, (size_t)nWidth * nHeight * sizeof(UINT));
+        pThreat->uVisitGeneration = 1;
+    }
+
+    const UINT uGeneration = pThreat->uVisitGeneration;
+    UINT* arrVisited = pThreat->arrVisited;
+    INT* arrQueue = pThreat->arrQueue;
+    INT nQueued = 0;
+
+    for (INT i = 0; i < nReached; i++) {
+        const INT iTile = pThreat->pRange->arrReached[i];
+        arrVisited[iTile] = uGeneration;
+        arrQueue[nQueued++] = iTile;
+    }
+
+    INT iRingStart = 0;
+    for (INT nRing = 0; nRing < pSource->nAttackRange && iRingStart < nQueued; nRing++) {
+        const INT iRingEnd = nQueued;
+        for (INT i = iRingStart; i < iRingEnd; i++) {
+            const INT iTile = arrQueue[i];
+            const INT x = iTile % nWidth;
+            const INT y = iTile / nWidth;
+            const INT arrNeighbours[4] = {
+                x > 0 ? iTile - 1 : -1,
+                x < nWidth - 1 ? iTile + 1 : -1,
+                y > 0 ? iTile - nWidth : -1,
+                y < nHeight - 1 ? iTile + nWidth : -1
+            };
+
+            for (INT j = 0; j < 4; j++) {
+                const INT iNeighbour = arrNeighbours[j];
+                if (iNeighbour >= 0 && arrVisited[iNeighbour] != uGeneration) {
+                    arrVisited[iNeighbour] = uGeneration;
+                    arrQueue[nQueued++] = iNeighbour;
+                }
+            }
+        }
+        iRingStart = iRingEnd;
+    }
+
+    if (nQueued > pSource->nCapacity) {
+        INT* arrTiles = realloc(pSource->arrTiles, nQueued * sizeof(INT));
+        if (!arrTiles) {
+            printf("Failed to allocate memory for threatened tiles\n");
+            return false;
+        }
+        pSource->arrTiles = arrTiles;
+        pSource->nCapacity = nQueued;
+    }
+
+    memcpy(pSource->arrTiles, arrQueue, nQueued * sizeof(INT));
+    pSource->nTiles = nQueued;
+
+    pSource->nMinX = nWidth;
+    pSource->nMinY = nHeight;
+    pSource->nMaxX = -1;
+    pSource->nMaxY = -1;
+    for (INT i = 0; i < nQueued; i++) {
+        const INT x = arrQueue[i] % nWidth;
+        const INT y = arrQueue[i] / nWidth;
+        if (x < pSource->nMinX) pSource->nMinX = x;
+        if (x > pSource->nMaxX) pSource->nMaxX = x;
+        if (y < pSource->nMinY) pSource->nMinY = y;
+        if (y > pSource->nMaxY) pSource->nMaxY = y;
+    }
+    return true;
+}
+
+_Check_return_
+static bool ReserveSources(
+    _Inout_ ThreatSource** pArrSources,
+    _Inout_ INT* pnCapacity,
+    _In_    const INT nCount
+) {
+    if (nCount <= *pnCapacity) {
+        return true;
+    }
+
+    ThreatSource* arrSources = realloc(*pArrSources, nCount * sizeof(ThreatSource));
+    if (!arrSources) {
+        printf("Failed to allocate memory for threat sources\n");
+        return false;
+    }
+    *pArrSources = arrSources;
+    *pnCapacity = nCount;
+    return true;
+}
+
+static void RecomputeMaxDamage(
+    _Inout_ ThreatMap* pThreat
+) {
+    if (pThreat->nDirtyTiles == 0) {
+        return;
+    }
+
+    const INT nWidth = pThreat->nWidth;
+    INT nMinX = pThreat->nWidth;
+    INT nMinY = pThreat->nHeight;
+    INT nMaxX = -1;
+    INT nMaxY = -1;
+    for (INT i = 0; i < pThreat->nDirtyTiles; i++) {
+        const INT iTile = pThreat->arrDirtyTiles[i];
+        const INT x = iTile % nWidth;
+        const INT y = iTile / nWidth;
+        if (x < nMinX) nMinX = x;
+        if (x > nMaxX) nMaxX = x;
+        if (y < nMinY) nMinY = y;
+        if (y > nMaxY) nMaxY = y;
+        pThreat->arrMaxDamage[iTile] = 0;
+    }
+
+    // Only sources that overlap the changed area can contribute to it
+    const UINT uGeneration = pThreat->uDirtyGeneration;
+    for (INT i = 0; i < pThreat->nSources; i++) {
+        const ThreatSource* pSource = &pThreat->arrSources[i];
+        if (pSource->nTiles == 0 || pSource->nMaxX < nMinX || pSource->nMinX > nMaxX ||
+            pSource->nMaxY < nMinY || pSource->nMinY > nMaxY) {
+            continue;
+        }
+
+        for (INT j = 0; j < pSource->nTiles; j++) {
+            const INT iTile = pSource->arrTiles[j];
+            if (pThreat->arrDirty[iTile] == uGeneration && pThreat->arrMaxDamage[iTile] < pSource->nDamage) {
+                pThreat->arrMaxDamage[iTile] = pSource->nDamage;
+            }
+        }
+    }
+}
+
+_Check_return_opt_
+INT ThreatMap_Update(
+    _Inout_ ThreatMap* pThreat,
+    _In_    const TerrainMap* pTerrain,
+    _In_    const UnitGroup* pGroup
+) {
+    pThreat->nRecomputed = 0;
+
+    if (pTerrain->nWidth != pThreat->nWidth || pTerrain->nHeight != pThreat->nHeight) {
+        printf("ThreatMap is %dx%d but the terrain is %dx%d\n",
+            pThreat->nWidth, pThreat->nHeight, pTerrain->nWidth, pTerrain->nHeight);
+        return 0;
+    }
+
+    const bool bRecomputeAll = !pThreat->bHasTerrain || pThreat->uTerrainVersion != pTerrain->uVersion;
+
+    pThreat->uDirtyGeneration++;
+    if (pThreat->uDirtyGeneration == 0) {
+        memset(pThreat->arrDirty, 0, (size_t)pThreat->nWidth * pThreat->nHeight * sizeof(UINT));
+        pThreat->uDirtyGeneration = 1;
+    }
+    pThreat->nDirtyTiles = 0;
+
+    // Last update's sources become the pool that this update's units are matched against
+    ThreatSource* arrPrevious = pThreat->arrSources;
+    const INT nPrevious = pThreat->nSources;
+    const INT nPreviousCapacity = pThreat->nSourcesCapacity;
+    pThreat->arrSources = pThreat->arrPrevious;
+    pThreat->nSourcesCapacity = pThreat->nPreviousCapacity;
+    pThreat->arrPrevious = arrPrevious;
+    pThreat->nPreviousCapacity = nPreviousCapacity;
+    pThreat->nSources = 0;
+
+    if (!ReserveSources(&pThreat->arrSources, &pThreat->nSourcesCapacity, pGroup->nCount)) {
+        // Keep the old state, which still matches the counts
+        pThreat->arrPrevious = pThreat->arrSources;
+        pThreat->nPreviousCapacity = pThreat->nSourcesCapacity;
+        pThreat->arrSources = arrPrevious;
+        pThreat->nSourcesCapacity = nPreviousCapacity;
+        pThreat->nSources = nPrevious;
+        return 0;
+    }
+
+    for (INT i = 0; i < pGroup->nCount; i++) {
+        const Unit* pUnit = pGroup->arrUnits[i];
+        const UnitState* pState = &pGroup->arrStates[i];
+
+        // Groups rarely reorder, so the unit is almost always at the same index as last time
+        ThreatSource* pMatch = NULL;
+        if (i < nPrevious && arrPrevious[i].pUnit == pUnit) {
+            pMatch = &arrPrevious[i];
+        } else {
+            for (INT j = 0; j < nPrevious; j++) {
+                if (arrPrevious[j].pUnit == pUnit) {
+                    pMatch = &arrPrevious[j];
+                    break;
+                }
+            }
+        }
+
+        ThreatSource source = { 0 };
+        if (pMatch) {
+            source = *pMatch;
+            pMatch->pUnit = NULL;
+            pMatch->arrTiles = NULL;
+        }
+
+        const bool bChanged = bRecomputeAll || !pMatch ||
+            !Point_IsEqual(&source.ptTile, &pState->ptTilePosition) ||
+            source.nMovePoints != pState->nMoveSpeed ||
+            source.nAttackRange != pState->nAttackRange ||
+            source.nDamage != pState->nAttack;
+
+        if (bChanged) {
+            AddFootprint(pThreat, &source, -1);
+
+            source.pUnit = pUnit;
+            source.ptTile = pState->ptTilePosition;
+            source.nMovePoints = pState->nMoveSpeed;
+            source.nAttackRange = pState->nAttackRange;
+            source.nDamage = pState->nAttack;
+            if (!ComputeFootprint(pThreat, pTerrain, &source)) {
+                source.nTiles = 0;
+            }
+
+            AddFootprint(pThreat, &source, 1);
+            pThreat->nRecomputed++;
+        }
+
+        pThreat->arrSources[pThreat->nSources++] = source;
+    }
+
+    // Whatever was not matched belongs to units that left the group
+    for (INT i = 0; i < nPrevious; i++) {
+        if (arrPrevious[i].pUnit) {
+            AddFootprint(pThreat, &arrPrevious[i], -1);
+        }
+        SafeFree(arrPrevious[i].arrTiles);
+    }
+
+    RecomputeMaxDamage(pThreat);
+
+    pThreat->bHasTerrain = true;
+    pThreat->uTerrainVersion = pTerrain->uVersion;
+    return pThreat->nRecomputed;
+}
+
+void ThreatMap_Invalidate(
+    _Inout_ ThreatMap* pThreat
+) {
+    pThreat->bHasTerrain = false;
+}
+
+_Check_return_opt_
+bool ThreatMap_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ ThreatMap* pThreat
+) {
+    if (!pThreat) {
+        return false;
+    }
+
+    for (INT i = 0; i < pThreat->nSources; i++) {
+        SafeFree(pThreat->arrSources[i].arrTiles);
+    }
+
+    SafeFree(pThreat->arrCounts);
+    SafeFree(pThreat->arrMaxDamage);
+    SafeFree(pThreat->arrVisited);
+    SafeFree(pThreat->arrDirty);
+    SafeFree(pThreat->arrQueue);
+    SafeFree(pThreat->arrDirtyTiles);
+    SafeFree(pThreat->arrSources);
+    SafeFree(pThreat->arrPrevious);
+    MoveRange_Destroy(pThreat->pRange);
+    SafeFree(pThreat);
+    return true;
+}
@@ -0,0 +1,149 @@
+#ifndef THREAT_MAP_H
+#define THREAT_MAP_H
+
+#include "utils.h"
+#include "point.h"
+
+typedef struct _Unit Unit;
+typedef struct _UnitGroup UnitGroup;
+typedef struct _TerrainMap TerrainMap;
+typedef struct _MoveRange MoveRange;
+
+/*
+ * The tiles one unit threatens: everything it can reach this turn, widened by its attack range. Kept between
+ * updates together with the inputs it was computed from, so unchanged units are not searched again.
+ */
+typedef struct _ThreatSource {
+    const Unit* pUnit;
+    POINT ptTile;
+    INT nMovePoints;
+    INT nAttackRange;
+    INT nDamage;
+    INT* arrTiles;             // << Threatened tiles, row-major indices
+    INT nTiles;
+    INT nCapacity;
+    INT nMinX;                 // << Bounding box of arrTiles, inclusive
+    INT nMinY;
+    INT nMaxX;
+    INT nMaxY;
+} ThreatSource;
+
+/*
+ * Per-tile threat of a whole faction: how many units can attack each tile next turn and the largest damage any
+ * one of them deals there.
+ *
+ * Counts are adjusted by adding and subtracting the footprints of units that changed. The maximum cannot be
+ * subtracted, so it is recomputed only on the tiles the changed footprints covered. The movement search and
+ * the attack-range expansion share buffers sized to the map once.
+ */
+typedef struct _ThreatMap {
+    INT nWidth;
+    INT nHeight;
+    UINT16* arrCounts;         // << Units that threaten the tile
+    INT* arrMaxDamage;         // << Largest attack among them, 0 if none
+    ThreatSource* arrSources;  // << One per unit of the group, in group order
+    INT nSources;
+    INT nSourcesCapacity;
+    ThreatSource* arrPrevious; // << Sources of the previous update while they are matched to units
+    INT nPreviousCapacity;
+    MoveRange* pRange;
+    UINT uVisitGeneration;
+    UINT* arrVisited;          // << Stamped by the attack-range expansion of one unit
+    UINT uDirtyGeneration;
+    UINT* arrDirty;            // << Stamped on tiles whose maximum must be recomputed in this update
+    INT* arrQueue;
+    INT* arrDirtyTiles;
+    INT nDirtyTiles;
+    UINT uTerrainVersion;
+    bool bHasTerrain;          // << False until the first update, or after ThreatMap_Invalidate
+    INT nRecomputed;           // << Units searched by the last update, for profiling
+} ThreatMap;
+
+/**
+ * @brief Creates an empty threat map for maps of the given size.
+ *
+ * @param nWidth  Width of the map in tiles.
+ * @param nHeight Height of the map in tiles.
+ * @return A pointer to the new `ThreatMap`, or `NULL` if the allocation failed.
+ */
+_Check_return_ _Ret_maybenull_ ThreatMap* ThreatMap_Create(
+    _In_ INT nWidth,
+    _In_ INT nHeight
+    );
+
+/**
+ * @brief Brings the threat map up to date with a faction.
+ *
+ * Units are compared with what they were at the last update; only units that are new, moved, or whose movement,
+ * attack range or attack changed are searched again. Units no longer in the group are removed. A change of the
+ * terrain recomputes everything.
+ *
+ * A unit threatens every tile within `nAttackRange` steps of a tile it can reach with `nMoveSpeed` movement
+ * points. Other units do not block movement here; the map answers "what could be attacked", not "what will be".
+ *
+ * @param pThreat  Pointer to the `ThreatMap`.
+ * @param pTerrain Terrain costs, the same size as the threat map.
+ * @param pGroup   The units of the faction.
+ * @return The number of units that were searched again.
+ */
+_Check_return_opt_ INT ThreatMap_Update(
+    _Inout_ ThreatMap* pThreat,
+    _In_    const TerrainMap* pTerrain,
+    _In_    const UnitGroup* pGroup
+    );
+
+/**
+ * @brief Forgets all cached footprints, so the next update searches every unit again.
+ *
+ * Units are recognised by address, so this is needed when units were destroyed and new ones may have been
+ * allocated at the same addresses, e.g. when a new battle starts.
+ *
+ * @param pThreat Pointer to the `ThreatMap`.
+ */
+void ThreatMap_Invalidate(
+    _Inout_ ThreatMap* pThreat
+    );
+
+/**
+ * @brief Gets how many units threaten a tile.
+ *
+ * @return The count, or `0` for tiles outside the map.
+ */
+_Check_return_
+static inline INT ThreatMap_GetCount(
+    _In_ const ThreatMap* pThreat,
+    _In_ const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pThreat->nWidth || ptTile.y >= pThreat->nHeight) {
+        return 0;
+    }
+    return pThreat->arrCounts[ptTile.y * pThreat->nWidth + ptTile.x];
+}
+
+/**
+ * @brief Gets the largest damage a single unit can deal on a tile.
+ *
+ * @return The damage, or `0` for tiles nobody threatens and tiles outside the map.
+ */
+_Check_return_
+static inline INT ThreatMap_GetMaxDamage(
+    _In_ const ThreatMap* pThreat,
+    _In_ const POINT ptTile
+) {
+    if (ptTile.x < 0 || ptTile.y < 0 || ptTile.x >= pThreat->nWidth || ptTile.y >= pThreat->nHeight) {
+        return 0;
+    }
+    return pThreat->arrMaxDamage[ptTile.y * pThreat->nWidth + ptTile.x];
+}
+
+/**
+ * @brief Destroys a threat map and frees its resources.
+ *
+ * @param pThreat Pointer to the `ThreatMap` to destroy.
+ * @return `true` if the threat map was destroyed, `false` if `pThreat` was `NULL`.
+ */
+_Check_return_opt_ bool ThreatMap_Destroy(
+    _Inout_ _Pre_valid_ _Post_invalid_ ThreatMap* pThreat
+    );
+
+#endif //THREAT_MAP_H
@@ -14,47 +14,81 @@
 #include "camera.h"
 #include "layer.h"
 #include "texture.h"
+#include "file.h"
+#include "asset-watcher.h"
+#include "profiler.h"
+#include "render-stats.h"
 
 _Check_return_
-static Layer LoadLayer(
+static bool ParseNextNumber(
+    _Inout_ const char** ppCursor,
+    _In_    const char* pEnd,
+    _Out_   LONG* plValue
+) {
+    // A sign only starts a number when a digit follows it; a lone '-' or '+' is skipped like any separator
+    const char* p = *ppCursor;
+    while (p < pEnd && (*p < '0' || *p > '9')
+        && !((*p == '-' || *p == '+') && p + 1 < pEnd && p[1] >= '0' && p[1] <= '9')) {
+        p++;
+    }
+    if (p >= pEnd) {
+        *ppCursor = p;
+        return false;
+    }
+
+    const bool bNegative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+
+    LONG lValue = 0;
+    while (p < pEnd && *p >= '0' && *p <= '9') {
+        lValue = lValue * 10 + (*p - '0');
+        p++;
+    }
+
+    *ppCursor = p;
+    *plValue = bNegative ? -lValue : lValue;
+    return true;
+}
+
+_Check_return_
+Layer Tilemap_ParseLayer(
     _In_z_ PCSTR pszFilename
 ) {
     Layer layer = { 0 };
 
-    FILE* pFile = fopen(pszFilename, "r");
+    FileView* pFile = File_Map(pszFilename);
     if (!pFile) {
         printf("Failed to open layer file: %s\n", pszFilename);
         return (Layer){ 0 };
     }
 
-    char buffer[1024];
-    fgets(buffer, 1024, pFile);
-    layer.usWidth = (UINT16)strtol(buffer, NULL, 10);
+    // Width and height on the first two lines, then comma separated tile ids
+    const char* pCursor = (const char*)FileView_GetData(pFile);
+    const char* pEnd = pCursor + FileView_GetSize(pFile);
 
-    fgets(buffer, 1024, pFile);
-    layer.usHeight = (UINT16)strtol(buffer, NULL, 10);
+    LONG lValue = 0;
+    if (ParseNextNumber(&pCursor, pEnd, &lValue)) {
+        layer.usWidth = (UINT16)lValue;
+    }
+    if (ParseNextNumber(&pCursor, pEnd, &lValue)) {
+        layer.usHeight = (UINT16)lValue;
+    }
 
-    layer.arrTiles = malloc((size_t)(layer.usWidth * layer.usHeight) * sizeof(BYTE));
+    layer.arrTiles = calloc((size_t)layer.usWidth * layer.usHeight, sizeof(BYTE));
     if (!layer.arrTiles) {
         printf("Failed to allocate memory for layer tiles\n");
-        fclose(pFile);
+        File_Unmap(pFile);
         return (Layer){ 0 };
     }
 
-    int nIndex = 0;
-
-    while (fgets(buffer, 1024, pFile)) {
-        const char* pszTileId = strtok(buffer, ",");
-        while (pszTileId != NULL) {
-            if (nIndex < layer.usWidth * layer.usHeight) {
-                layer.arrTiles[nIndex] = (BYTE)strtol(pszTileId, NULL, 10);
-                nIndex++;
-            }
-            pszTileId = strtok(NULL, ",");
-        }
+    const int nTiles = layer.usWidth * layer.usHeight;
+    for (int nIndex = 0; nIndex < nTiles && ParseNextNumber(&pCursor, pEnd, &lValue); nIndex++) {
+        layer.arrTiles[nIndex] = (BYTE)lValue;
     }
 
-    fclose(pFile);
+    File_Unmap(pFile);
     return layer;
 }
 
@@ -83,8 +117,24 @@ void Tilemap_LoadLayer(
     _Inout_ Tilemap* pTilemap,
     _In_z_  PCSTR pszFilename
 ) {
-    pTilemap->arrLayers[pTilemap->nCount] = LoadLayer(pszFilename);
+    PROFILE_BEGIN("Tilemap_LoadLayer");
+    pTilemap->arrLayers[pTilemap->nCount] = Tilemap_ParseLayer(pszFilename);
+    AssetWatcher_Watch(ASSET_KIND_LAYER, pTilemap, pTilemap->nCount, pszFilename);
     pTilemap->nCount++;
+    PROFILE_END();
+}
+
+void Tilemap_ReplaceLayer(
+    _Inout_ Tilemap* pTilemap,
+    _In_    const INT iLayer,
+    _In_    const Layer layer
+) {
+    if (iLayer < 0 || iLayer >= pTilemap->nCount) {
+        return;
+    }
+
+    SafeFree(pTilemap->arrLayers[iLayer].arrTiles);
+    pTilemap->arrLayers[iLayer] = layer;
 }
 
 void Tilemap_SetTexture(
@@ -99,35 +149,77 @@ void Tilemap_SetTexture(
     );
 }
 
+_Check_return_
+TileRange Tilemap_GetVisibleTileRange(
+    _In_ const Tilemap* pTilemap
+) {
+    INT iMapWidth = 0;
+    INT iMapHeight = 0;
+    for (int i = 0; i < pTilemap->nCount; i++) {
+        if (pTilemap->arrLayers[i].usWidth > iMapWidth) {
+            iMapWidth = pTilemap->arrLayers[i].usWidth;
+        }
+        if (pTilemap->arrLayers[i].usHeight > iMapHeight) {
+            iMapHeight = pTilemap->arrLayers[i].usHeight;
+        }
+    }
+
+    // The right and bottom edges are exclusive, so a view ending exactly on a tile border leaves that tile out
+    const RECTF rcView = Camera_GetVisibleBounds();
+    TileRange range = {
+        (INT)floorf(rcView.fLeft / pTilemap->fTileWidth),
+        (INT)floorf(rcView.fTop / pTilemap->fTileHeight),
+        (INT)ceilf(rcView.fRight / pTilemap->fTileWidth) - 1,
+        (INT)ceilf(rcView.fBottom / pTilemap->fTileHeight) - 1
+    };
+
+    range.iMinX = range.iMinX < 0 ? 0 : range.iMinX;
+    range.iMinY = range.iMinY < 0 ? 0 : range.iMinY;
+    range.iMaxX = range.iMaxX >= iMapWidth ? iMapWidth - 1 : range.iMaxX;
+    range.iMaxY = range.iMaxY >= iMapHeight ? iMapHeight - 1 : range.iMaxY;
+    return range;
+}
+
 void Tilemap_Draw(
     _In_ const Tilemap* pTilemap
 ) {
+    PROFILE_BEGIN("Tilemap_Draw");
+
+    const int nTilesPerRow = (int)(pTilemap->pTilesetTexture->fWidth / pTilemap->fTileWidth);
+    const TileRange visible = Tilemap_GetVisibleTileRange(pTilemap);
+
     for (int nLayer = 0; nLayer < pTilemap->nCount; nLayer++) {
-        for (int nTile = 0; nTile < pTilemap->arrLayers[nLayer].usWidth * pTilemap->arrLayers[nLayer].usHeight; nTile++) {
-            const int iTileX = pTilemap->arrLayers[nLayer].arrTiles[nTile] % (int)(pTilemap->pTilesetTexture->fWidth / pTilemap->fTileWidth);
-            const int iTileY = pTilemap->arrLayers[nLayer].arrTiles[nTile] / (int)(pTilemap->pTilesetTexture->fWidth / pTilemap->fTileWidth);
-
-            sfSprite_setTextureRect(
-                pTilemap->pSpriteHandle,
-                (sfIntRect) {
-                    iTileX * (int)pTilemap->fTileWidth,
-                    iTileY * (int)pTilemap->fTileHeight,
-                    (int)pTilemap->fTileWidth,
-                    (int)pTilemap->fTileHeight
-                }
-            );
-
-            sfSprite_setPosition(
-                pTilemap->pSpriteHandle,
-                (sfVector2f) {
-                    nTile % pTilemap->arrLayers[nLayer].usWidth * pTilemap->fTileWidth,
-                    nTile / pTilemap->arrLayers[nLayer].usWidth * pTilemap->fTileHeight
-                }
-            );
-
-            sfRenderWindow_drawSprite(Window_GetRenderWindow(), pTilemap->pSpriteHandle, NULL);
+        const Layer* pLayer = &pTilemap->arrLayers[nLayer];
+        const int iMaxX = visible.iMaxX < pLayer->usWidth ? visible.iMaxX : pLayer->usWidth - 1;
+        const int iMaxY = visible.iMaxY < pLayer->usHeight ? visible.iMaxY : pLayer->usHeight - 1;
+
+        for (int y = visible.iMinY; y <= iMaxY; y++) {
+            for (int x = visible.iMinX; x <= iMaxX; x++) {
+                const BYTE byTile = pLayer->arrTiles[y * pLayer->usWidth + x];
+                const int iTileX = byTile % nTilesPerRow;
+                const int iTileY = byTile / nTilesPerRow;
+
+                sfSprite_setTextureRect(
+                    pTilemap->pSpriteHandle,
+                    (sfIntRect) {
+                        iTileX * (int)pTilemap->fTileWidth,
+                        iTileY * (int)pTilemap->fTileHeight,
+                        (int)pTilemap->fTileWidth,
+                        (int)pTilemap->fTileHeight
+                    }
+                );
+
+                sfSprite_setPosition(
+                    pTilemap->pSpriteHandle,
+                    (sfVector2f) { (FLOAT)x * pTilemap->fTileWidth, (FLOAT)y * pTilemap->fTileHeight }
+                );
+
+                RenderStats_DrawSprite(pTilemap->pSpriteHandle);
+            }
         }
     }
+
+    PROFILE_END();
 }
 
 _Check_return_
@@ -161,6 +253,7 @@ bool Tilemap_Destroy(
         return false;
     }
 
+    AssetWatcher_Unwatch(pTilemap);
     sfSprite_destroy(pTilemap->pSpriteHandle);
 
     for (int i = 0; i < pTilemap->nCount; i++) {
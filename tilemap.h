@@ -8,11 +8,21 @@
 #include "utils.h"
 #include "point.h"
 #include "vector2.h"
+#include "layer.h"
 
-typedef struct _Layer Layer;
 typedef struct _Texture Texture;
 typedef struct sfSprite sfSprite;
 
+/*
+ * Inclusive rectangle of tile indices. Empty when a maximum is below its minimum.
+ */
+typedef struct _TileRange {
+    INT iMinX;
+    INT iMinY;
+    INT iMaxX;
+    INT iMaxY;
+} TileRange;
+
 typedef struct _Tilemap {
     sfSprite* pSpriteHandle;
     Layer* arrLayers;
@@ -57,6 +67,34 @@ void Tilemap_LoadLayer(
     _In_z_  PCSTR pszFilename
     );
 
+/**
+ * @brief Parses a layer file without adding it to a tilemap.
+ *
+ * Only touches the file and the heap, so it may run on any thread. Used by `Tilemap_LoadLayer` and by the asset
+ * watcher to decode a changed layer in the background.
+ *
+ * @param pszFilename The path to the layer file.
+ * @return The parsed layer. `arrTiles` is `NULL` if the file could not be read.
+ */
+_Check_return_ Layer Tilemap_ParseLayer(
+    _In_z_ PCSTR pszFilename
+    );
+
+/**
+ * @brief Replaces the tiles of a loaded layer.
+ *
+ * The old tiles are freed and the tilemap takes ownership of `layer.arrTiles`.
+ *
+ * @param pTilemap Pointer to the `Tilemap` that owns the layer.
+ * @param iLayer   Index of the layer, in the order the layers were loaded.
+ * @param layer    The new layer contents.
+ */
+void Tilemap_ReplaceLayer(
+    _Inout_ Tilemap* pTilemap,
+    _In_    INT iLayer,
+    _In_    Layer layer
+    );
+
 /**
  * @brief Sets the texture for a tilemap.
  *
@@ -83,12 +121,25 @@ void Tilemap_SetTexture(
  *                 initialized and contains valid tile data.
  *
  * @note The function uses the current rendering context, so ensure that the camera, projection, and other settings
- *       are correctly configured before drawing the tilemap.
+ *       are correctly configured before drawing the tilemap. Only tiles inside the active camera's view are drawn.
  */
 void Tilemap_Draw(
     _In_ const Tilemap* pTilemap
     );
 
+/**
+ * @brief Gets the tiles the active camera shows.
+ *
+ * Built from `Camera_GetVisibleBounds`, so it includes zoom and rotation, and clamped to the largest layer of the
+ * tilemap. Layers smaller than that need clamping to their own size.
+ *
+ * @param pTilemap The tilemap to query.
+ * @return The visible tiles, empty if the view is entirely off the map.
+ */
+_Check_return_ TileRange Tilemap_GetVisibleTileRange(
+    _In_ const Tilemap* pTilemap
+    );
+
 /**
  * @brief Converts world coordinates to tile coordinates in a tilemap.
  *
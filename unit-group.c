@@ -5,50 +5,107 @@
 #include "unit-group.h"
 
 #include "unit.h"
+#include "occupancy-grid.h"
 
 _Check_return_ _Ret_maybenull_
 UnitGroup* UnitGroup_Create(
-    void
+    _In_ EcsWorld* pWorld
 ) {
-    UnitGroup* pUnitGroup = malloc(sizeof(UnitGroup));
+    UnitGroup* pUnitGroup = calloc(1, sizeof(UnitGroup));
     if (!pUnitGroup) {
+        printf("Failed to allocate memory for UnitGroup\n");
         return NULL;
     }
 
-    pUnitGroup->nCount = 0;
-    pUnitGroup->nCapacity = 10;
-    pUnitGroup->arrUnits = malloc(pUnitGroup->nCapacity * sizeof(Unit*));
-
+    pUnitGroup->pWorld = pWorld;
     return pUnitGroup;
 }
 
+_Check_return_
+static bool Reserve(
+    _Inout_ UnitGroup* pUnitGroup,
+    _In_    const INT nCapacity
+) {
+    if (nCapacity <= pUnitGroup->nCapacity) {
+        return true;
+    }
+
+    // Each array is kept once it grew, so a failure part way leaves every array at least the old capacity
+    UnitState* arrStates = realloc(pUnitGroup->arrStates, nCapacity * sizeof(UnitState));
+    if (!arrStates) {
+        return false;
+    }
+    pUnitGroup->arrStates = arrStates;
+
+    Unit** arrUnits = realloc(pUnitGroup->arrUnits, nCapacity * sizeof(Unit*));
+    if (!arrUnits) {
+        return false;
+    }
+    pUnitGroup->arrUnits = arrUnits;
+
+    pUnitGroup->nCapacity = nCapacity;
+    return true;
+}
+
 _Check_return_opt_
 bool UnitGroup_AddUnit(
     _Inout_ UnitGroup* pUnitGroup,
-    _In_    Unit* pUnit
+    _Inout_ Unit* pUnit,
+    _In_    const UnitState* pState
 ) {
-    if (pUnitGroup->nCount >= pUnitGroup->nCapacity) {
-        pUnitGroup->nCapacity += 10;
-        Unit** arrUnits = realloc(pUnitGroup->arrUnits, pUnitGroup->nCapacity * sizeof(Unit*));
-        if (!arrUnits) {
-            return false;
-        }
-        pUnitGroup->arrUnits = arrUnits;
+    if (pUnit->pGroup) {
+        printf("Unit is already in a group\n");
+        return false;
+    }
+
+    if (pUnitGroup->nCount >= pUnitGroup->nCapacity &&
+        !Reserve(pUnitGroup, pUnitGroup->nCapacity ? pUnitGroup->nCapacity * 2 : 16)) {
+        printf("Failed to allocate memory for UnitGroup\n");
+        return false;
     }
 
-    pUnitGroup->arrUnits[pUnitGroup->nCount] = pUnit;
-    pUnitGroup->nCount++;
+    const INT iUnit = pUnitGroup->nCount++;
+    pUnitGroup->arrStates[iUnit] = *pState;
+    pUnitGroup->arrUnits[iUnit] = pUnit;
 
+    pUnit->pGroup = pUnitGroup;
+    pUnit->iGroupIndex = iUnit;
     return true;
 }
 
-void UnitGroup_Draw(
-    _In_ const UnitGroup* pUnitGroup,
-    _In_ const Tilemap* pTilemap
+void UnitGroup_RemoveUnit(
+    _Inout_ UnitGroup* pUnitGroup,
+    _Inout_ Unit* pUnit
+) {
+    if (pUnit->pGroup != pUnitGroup) {
+        return;
+    }
+
+    const INT iUnit = pUnit->iGroupIndex;
+    const INT iLast = --pUnitGroup->nCount;
+    if (iUnit != iLast) {
+        pUnitGroup->arrStates[iUnit] = pUnitGroup->arrStates[iLast];
+        pUnitGroup->arrUnits[iUnit] = pUnitGroup->arrUnits[iLast];
+        pUnitGroup->arrUnits[iUnit]->iGroupIndex = iUnit;
+    }
+
+    pUnit->pGroup = NULL;
+    pUnit->iGroupIndex = -1;
+}
+
+_Check_return_opt_
+bool UnitGroup_SetTilePosition(
+    _Inout_ UnitGroup* pUnitGroup,
+    _In_    const INT iUnit,
+    _In_    const POINT ptTile
 ) {
-    for (int i = 0; i < pUnitGroup->nCount; i++) {
-        Unit_Draw(pUnitGroup->arrUnits[i], pTilemap);
+    Unit* pUnit = pUnitGroup->arrUnits[iUnit];
+    if (pUnit->pOccupancy &&
+        !OccupancyGrid_Relocate(pUnit->pOccupancy, pUnit, pUnitGroup->arrStates[iUnit].ptTilePosition, ptTile)) {
+        return false;
     }
+    pUnitGroup->arrStates[iUnit].ptTilePosition = ptTile;
+    return true;
 }
 
 _Check_return_opt_
@@ -59,6 +116,12 @@ bool UnitGroup_Destroy(
         return false;
     }
 
+    // Destroying the last unit never moves another one
+    while (pUnitGroup->nCount > 0) {
+        Unit_Destroy(pUnitGroup->arrUnits[pUnitGroup->nCount - 1]);
+    }
+
+    SafeFree(pUnitGroup->arrStates);
     SafeFree(pUnitGroup->arrUnits);
     SafeFree(pUnitGroup);
     return true;
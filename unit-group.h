@@ -6,30 +6,81 @@
 #define UNIT_GROUP_H
 
 #include "utils.h"
+#include "point.h"
+#include "unit-state.h"
 
 typedef struct _Unit Unit;
-typedef struct _Tilemap Tilemap;
+typedef struct _EcsWorld EcsWorld;
 
+/*
+ * A set of units, e.g. one faction, and the game rules state of each.
+ *
+ * The states are stored as one array indexed by the unit's position in the group, with no gaps, next to
+ * `arrUnits` holding the `Unit` objects. Passes over the whole group, like the AI snapshot or the threat map,
+ * walk the states front to back instead of following a pointer per unit. Motion, sprites and animation are
+ * components of each unit's entity in `pWorld` and are advanced by the systems in `systems.h`.
+ *
+ * Removing a unit moves the last one into its place, so indices are not stable; hold a `UnitHandle` or the
+ * `Unit` pointer to refer to a unit over time. Each `Unit` knows its current index.
+ */
 typedef struct _UnitGroup {
-    Unit** arrUnits;
+    EcsWorld* pWorld;          // << World holding the entities of the group's units
+    UnitState* arrStates;
+    Unit** arrUnits;           // << Unit at each index, also used to fix up its index when it moves
     INT nCount;
     INT nCapacity;
 } UnitGroup;
 
+/**
+ * @brief Creates an empty group.
+ *
+ * @param pWorld World the group's units create their entities in. Must outlive the group.
+ * @return A pointer to the new `UnitGroup`, or `NULL` if the allocation failed.
+ */
 _Check_return_ _Ret_maybenull_ UnitGroup* UnitGroup_Create(
-    void
+    _In_ EcsWorld* pWorld
     );
 
+/**
+ * @brief Adds a unit to the group. Called by `Unit_CreateFromAnimatedSprite`.
+ *
+ * @param pUnitGroup Pointer to the `UnitGroup`.
+ * @param pUnit      The unit; must not be in a group yet.
+ * @param pState     Initial game rules state.
+ * @return `true` if the unit was added, `false` if the arrays could not grow.
+ */
 _Check_return_opt_ bool UnitGroup_AddUnit(
     _Inout_ UnitGroup* pUnitGroup,
-    _In_    Unit* pUnit
+    _Inout_ Unit* pUnit,
+    _In_    const UnitState* pState
     );
 
-void UnitGroup_Draw(
-    _In_ const UnitGroup* pUnitGroup,
-    _In_ const Tilemap* pTilemap
+/**
+ * @brief Removes a unit from the group by moving the last unit into its place. Called by `Unit_Destroy`.
+ */
+void UnitGroup_RemoveUnit(
+    _Inout_ UnitGroup* pUnitGroup,
+    _Inout_ Unit* pUnit
+    );
+
+/**
+ * @brief Moves a unit to a tile, keeping the occupancy grid it is placed on in sync.
+ *
+ * @param pUnitGroup Pointer to the `UnitGroup`.
+ * @param iUnit      Index of the unit in the group.
+ * @param ptTile     The new tile.
+ * @return `true` if the unit moved, `false` if it is placed on a grid and `ptTile` is outside it or taken by
+ *         another unit. The unit keeps its tile then.
+ */
+_Check_return_opt_ bool UnitGroup_SetTilePosition(
+    _Inout_ UnitGroup* pUnitGroup,
+    _In_    INT iUnit,
+    _In_    POINT ptTile
     );
 
+/**
+ * @brief Destroys the group together with every unit still in it.
+ */
 _Check_return_opt_ bool UnitGroup_Destroy(
     _Inout_ _Pre_valid_ _Post_invalid_ UnitGroup* pUnitGroup
     );
@@ -0,0 +1,45 @@
+#ifndef UNIT_STATE_H
+#define UNIT_STATE_H
+
+#include "utils.h"
+#include "point.h"
+
+/*
+ * Everything about a unit the game rules read and change, with nothing used only for drawing. A `UnitGroup`
+ * keeps the states of its units packed in `arrStates`, apart from their sprites and animation, and a `Unit`
+ * reaches its own through the group; headless code such as the battle simulator works on plain arrays of them,
+ * without a window or any CSFML graphics.
+ */
+typedef struct _UnitState {
+    POINT ptTilePosition; // << Position on the map eg. (1, 1)
+    INT nHp;
+    INT nAttack;
+    INT nDefense;
+    INT nMoveSpeed;       // << Movement points per turn, spent on terrain costs
+    INT nAttackRange;     // << Tiles from which the unit can attack, 1 for melee
+} UnitState;
+
+/**
+ * @brief Gets the damage an attack deals: attack minus defense, but always at least 1.
+ */
+_Check_return_
+static inline INT UnitState_GetDamage(
+    _In_ const UnitState* pAttacker,
+    _In_ const UnitState* pDefender
+) {
+    return pAttacker->nAttack > pDefender->nDefense ? pAttacker->nAttack - pDefender->nDefense : 1;
+}
+
+/**
+ * @brief Checks whether a target stands within a unit's attack range of a tile.
+ */
+_Check_return_
+static inline bool UnitState_CanAttackFrom(
+    _In_ const UnitState* pAttacker,
+    _In_ const POINT ptFrom,
+    _In_ const POINT ptTarget
+) {
+    return abs(ptFrom.x - ptTarget.x) + abs(ptFrom.y - ptTarget.y) <= pAttacker->nAttackRange;
+}
+
+#endif //UNIT_STATE_H
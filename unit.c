@@ -1,69 +1,78 @@
 #include "unit.h"
 
 #include <math.h>
+#include <string.h>
 
-#include "window.h"
 #include "camera.h"
 #include "tilemap.h"
 #include "sprite.h"
 #include "animated-sprite.h"
+#include "pathfinder.h"
+#include "occupancy-grid.h"
+#include "systems.h"
+
+static Pool s_unitPool = POOL_INIT(Unit);
 
 _Check_return_ _Ret_maybenull_
 Unit* Unit_CreateFromAnimatedSprite(
     _Inout_ _Pre_valid_ _Post_invalid_ AnimatedSprite** ppAnimSprite,
-    _In_ const Tilemap* pTilemap
+    _In_ const Tilemap* pTilemap,
+    _Inout_ UnitGroup* pGroup
 ) {
-    Unit* pUnit = calloc(1, sizeof(Unit));
+    Unit* pUnit = Pool_Alloc(&s_unitPool);
     if (!pUnit) {
         printf("Failed to allocate memory for Unit\n");
         return NULL;
     }
 
+    const Sprite* pSprite = (*ppAnimSprite)->pSprite;
+    UnitState state = { 0 };
+    state.ptTilePosition.x = (INT)floorf(pSprite->x / pTilemap->fTileWidth);
+    state.ptTilePosition.y = (INT)floorf(pSprite->y / pTilemap->fTileHeight);
+    state.nAttackRange = 1;
+
+    pUnit->entity = Ecs_CreateEntity(pGroup->pWorld);
+    WorldPosition* pPosition = Ecs_AddComponent(pGroup->pWorld, pUnit->entity, ECS_COMPONENT_POSITION);
+    UnitMotion* pMotion = Ecs_AddComponent(pGroup->pWorld, pUnit->entity, ECS_COMPONENT_MOTION);
+    UnitPath* pPath = Ecs_AddComponent(pGroup->pWorld, pUnit->entity, ECS_COMPONENT_PATH);
+    Unit** ppUnit = Ecs_AddComponent(pGroup->pWorld, pUnit->entity, ECS_COMPONENT_UNIT);
+    Sprite** ppSprite = Ecs_AddComponent(pGroup->pWorld, pUnit->entity, ECS_COMPONENT_SPRITE);
+    AnimatedSprite** ppAnimation = Ecs_AddComponent(pGroup->pWorld, pUnit->entity, ECS_COMPONENT_ANIMATION);
+    if (!pPosition || !pMotion || !pPath || !ppUnit || !ppSprite || !ppAnimation || !UnitGroup_AddUnit(pGroup, pUnit, &state)) {
+        Ecs_DestroyEntity(pGroup->pWorld, pUnit->entity);
+        Pool_Free(&s_unitPool, pUnit);
+        return NULL;
+    }
+
+    pPosition->vPosition = CreateVector2(pSprite->x, pSprite->y);
+    pPosition->vPrevPosition = pPosition->vPosition;
+    pMotion->fMoveSpeed = 150.0f;
+    *ppUnit = pUnit;
+    *ppSprite = (*ppAnimSprite)->pSprite;
+    *ppAnimation = *ppAnimSprite;
+
     pUnit->pAnimSprite = *ppAnimSprite;
-    pUnit->ptTilePosition.x = (INT)floorf(pUnit->pAnimSprite->pSprite->x / pTilemap->fTileWidth);
-    pUnit->ptTilePosition.y = (INT)floorf(pUnit->pAnimSprite->pSprite->y / pTilemap->fTileHeight);
-    pUnit->fMoveSpeed = 150.0f;
-    pUnit->bAnimated = true;
 
     *ppAnimSprite = NULL;
 
     return pUnit;
 }
 
-void Unit_Draw(
-    _Inout_ Unit* pUnit,
-    _In_    const Tilemap* pTilemap
+_Check_return_
+UnitState* Unit_GetState(
+    _In_ const Unit* pUnit
 ) {
-    AnimatedSprite_Draw(pUnit->pAnimSprite);
-
-    if (pUnit->bAnimated) {
-        AnimatedSprite_Update(pUnit->pAnimSprite);
-    }
-
-    if (pUnit->bIsMoving) {
-        pUnit->fMoveElapsed += (FLOAT)GetFrameTime() / 1000.0f;
-        FLOAT t = pUnit->fMoveElapsed / pUnit->fMoveDuration;
-
-        if (t >= 1.0f) {
-            t = 1.0f;
-            pUnit->bIsMoving = false;
-        }
-
-        Sprite_SetPosition(
-            pUnit->pAnimSprite->pSprite,
-            pUnit->vStart.x + (pUnit->vTarget.x - pUnit->vStart.x) * t,
-            pUnit->vStart.y + (pUnit->vTarget.y - pUnit->vStart.y) * t
-        );
-    }
+    return &pUnit->pGroup->arrStates[pUnit->iGroupIndex];
 }
 
-void Unit_Move(
+_Check_return_opt_
+bool Unit_Move(
     _Inout_ Unit* pUnit,
     _In_    const INT dx,
     _In_    const INT dy
 ) {
-    pUnit->ptTilePosition.x += dx;
-    pUnit->ptTilePosition.y += dy;
+    const POINT ptTile = Unit_GetState(pUnit)->ptTilePosition;
+    return UnitGroup_SetTilePosition(pUnit->pGroup, pUnit->iGroupIndex, (POINT) { ptTile.x + dx, ptTile.y + dy });
 }
 
 void Unit_StartMoveToTile(
@@ -75,58 +84,74 @@ void Unit_StartMoveToTile(
         return;
     }
 
-    pUnit->ptTilePosition = ptTarget;
+    // A one-tile path is a straight move that replaces any path being walked
+    MovementSystem_StartPath(pUnit->pGroup->pWorld, pUnit->entity, pTilemap, &ptTarget, 1);
+}
 
-    const VECTOR2 vStartPos = CreateVector2(
-        pUnit->pAnimSprite->pSprite->x,
-        pUnit->pAnimSprite->pSprite->y
-    );
-    const VECTOR2 vTargetPos = CreateVector2(
-        (FLOAT)ptTarget.x * pTilemap->fTileWidth,
-        (FLOAT)ptTarget.y * pTilemap->fTileHeight
-    );
+_Check_return_opt_
+bool Unit_StartMoveAlongPath(
+    _Inout_             Unit* pUnit,
+    _In_                const Tilemap* pTilemap,
+    _In_reads_(nLength) const POINT* arrPath,
+    _In_                const INT nLength
+) {
+    if (!pUnit || !pTilemap) {
+        return false;
+    }
 
-    const FLOAT dx = vTargetPos.x - vStartPos.x;
-    const FLOAT dy = vTargetPos.y - vStartPos.y;
-    const FLOAT distance = sqrtf(dx * dx + dy * dy);
+    return MovementSystem_StartPath(pUnit->pGroup->pWorld, pUnit->entity, pTilemap, arrPath, nLength);
+}
 
-    if (distance == 0.0f) {
-        return;
+_Check_return_opt_
+bool Unit_StartPathTo(
+    _Inout_  Unit* pUnit,
+    _In_     const Tilemap* pTilemap,
+    _Inout_  PathFinder* pFinder,
+    _In_     const TerrainMap* pTerrain,
+    _In_opt_ const OccupancyGrid* pBlockers,
+    _In_     const POINT ptTarget
+) {
+    POINT arrPath[UNIT_MAX_PATH_LENGTH];
+    const INT nLength = PathFinder_FindPath(
+        pFinder,
+        pTerrain,
+        pBlockers,
+        Unit_GetState(pUnit)->ptTilePosition,
+        ptTarget,
+        arrPath,
+        UNIT_MAX_PATH_LENGTH
+    );
+    if (nLength < 0) {
+        return false;
     }
 
-    const FLOAT duration = distance / pUnit->fMoveSpeed;
-
-    pUnit->vStart = vStartPos;
-    pUnit->vTarget = vTargetPos;
-    pUnit->fMoveDuration = duration;
-    pUnit->fMoveElapsed = 0.0f;
-    pUnit->bIsMoving = true;
+    return Unit_StartMoveAlongPath(pUnit, pTilemap, arrPath, nLength);
 }
 
 _Check_return_ _Ret_maybenull_
 Unit* Unit_GetAtScreenPosition(
-    _In_reads_(nCount) Unit* pUnits,
-    _In_               const INT nCount,
-    _In_               const Tilemap* pTilemap,
-    _In_               const FLOAT fMouseX,
-    _In_               const FLOAT fMouseY
+    _In_ const OccupancyGrid* pOccupancy,
+    _In_ const Tilemap* pTilemap,
+    _In_ const FLOAT fMouseX,
+    _In_ const FLOAT fMouseY
 ) {
-    const Camera* pCamera = Camera_GetCurrent();
-    VECTOR2 world = { 0 };
-
-    const FLOAT invZoom = 1.0f / pCamera->fZoom;
-    world.x = (fMouseX - (FLOAT)Window_GetWidth() / 2.0f) * invZoom + pCamera->x;
-    world.y = (fMouseY - (FLOAT)Window_GetHeight() / 2.0f) * invZoom + pCamera->y;
-
+    const VECTOR2 world = ScreenToWorld((INT)fMouseX, (INT)fMouseY);
     const POINT ptTilePos = MapPositionToTile(pTilemap, world.x, world.y);
+    return OccupancyGrid_Get(pOccupancy, ptTilePos);
+}
 
-    for (INT i = 0; i < nCount; i++) {
-        if (Point_IsEqual(&pUnits[i].ptTilePosition, &ptTilePos)) {
-            return &pUnits[i];
-        }
-    }
+_Check_return_
+UnitHandle Unit_GetHandle(
+    _In_ const Unit* pUnit
+) {
+    return Pool_GetHandle(&s_unitPool, pUnit);
+}
 
-    return NULL;
+_Check_return_ _Ret_maybenull_
+Unit* Unit_FromHandle(
+    _In_ const UnitHandle hUnit
+) {
+    return Pool_Resolve(&s_unitPool, hUnit);
 }
 
 _Check_return_opt_
@@ -137,8 +162,21 @@ bool Unit_Destroy(
         return false;
     }
 
+    if (pUnit->pOccupancy) {
+        OccupancyGrid_Remove(pUnit->pOccupancy, pUnit);
+    }
+    if (pUnit->pGroup) {
+        Ecs_DestroyEntity(pUnit->pGroup->pWorld, pUnit->entity);
+        UnitGroup_RemoveUnit(pUnit->pGroup, pUnit);
+    }
     AnimatedSprite_Destroy(pUnit->pAnimSprite);
-    SafeFree(pUnit);
+    Pool_Free(&s_unitPool, pUnit);
     
     return true;
 }
+
+void Unit_Shutdown(
+    void
+) {
+    Pool_Release(&s_unitPool);
+}
@@ -4,53 +4,60 @@
 #include "point.h"
 #include "utils.h"
 #include "vector2.h"
+#include "unit-state.h"
+#include "pool.h"
+#include "unit-group.h"
+#include "ecs.h"
 
 typedef struct _Tilemap Tilemap;
 typedef struct _AnimatedSprite AnimatedSprite;
+typedef struct _PathFinder PathFinder;
+typedef struct _TerrainMap TerrainMap;
+typedef struct _OccupancyGrid OccupancyGrid;
 
+/*
+ * A unit ties together its game rules state, kept in the arrays of the `UnitGroup` it belongs to at `iGroupIndex`,
+ * and its entity in the group's world, which has position, motion, path, unit, sprite and animation components.
+ * Moving, animating and drawing units is done for all of them at once by the systems in `systems.h`.
+ */
 typedef struct _Unit {
+    UnitGroup* pGroup;    // << Group holding the unit's state
+    INT iGroupIndex;      // << Index of the unit in its group, changes when another unit is removed
+    Entity entity;        // << Entity in pGroup->pWorld
     AnimatedSprite* pAnimSprite;
-    POINT ptTilePosition; // << Position on the map eg. (1, 1)
-    VECTOR2 vStart;       // << Moving start vector in world space eg. (16, 16)
-    VECTOR2 vTarget;      // << Moving target vector in world space eg. (48, 32)
-    FLOAT fMoveDuration;  // << Time it should take to move
-    FLOAT fMoveElapsed;   // << Time spent moving so far
-    FLOAT fMoveSpeed;     // << Speed of the unit in pixels per second
-    bool bIsMoving;       // << Is the unit currently moving?
-    INT nHp;
-    INT nAttack;
-    INT nDefense;
-    INT nMoveSpeed;
-    bool bAnimated;
+    OccupancyGrid* pOccupancy; // << Grid the unit is placed on, kept in sync with the tile position, or NULL
 } Unit;
 
+/*
+ * Reference to a unit that may be destroyed while it is held, e.g. an attack target or a selection. Resolves
+ * to `NULL` once the unit is gone, even if its memory was reused for a new unit.
+ */
+typedef PoolHandle UnitHandle;
+
 /**
- * Creates a unit from an animated sprite.
+ * Creates a unit from an animated sprite and adds it to a group.
  * Takes ownership of the animated sprite pointer.
  * 
  * @param ppAnimSprite Pointer to the animated sprite to use for the unit.
  * @param pTilemap Pointer to the tilemap used for positioning the unit.
+ * @param pGroup Group that will hold the unit's state; the unit is destroyed with it.
  * 
  * @return A pointer to the created unit, or NULL on failure.
  */
 _Check_return_ _Ret_maybenull_ Unit* Unit_CreateFromAnimatedSprite(
     _Inout_ _Pre_valid_ _Post_invalid_ AnimatedSprite** ppAnimSprite,
-    _In_ const Tilemap* pTilemap
+    _In_ const Tilemap* pTilemap,
+    _Inout_ UnitGroup* pGroup
     );
 
 /**
- * @brief Draws a unit on the screen based on its position on the tilemap.
+ * @brief Gets the game rules state of a unit.
  *
- * This function renders the specified unit at its position on the screen, using information from the
- * provided tilemap to correctly place the unit within the game world. The unit will be drawn with
- * its current properties, such as sprite, position, and other visual characteristics.
- *
- * @param pUnit    Pointer to the `Unit` that will be drawn.
- * @param pTilemap Pointer to the `Tilemap` used to determine the unit's placement in the game world.
+ * @param pUnit Pointer to the `Unit`.
+ * @return The state in the unit's group. Valid until a unit is added to or removed from the group.
  */
-void Unit_Draw(
-    _Inout_ Unit* pUnit,
-    _In_    const Tilemap* pTilemap
+_Check_return_ UnitState* Unit_GetState(
+    _In_ const Unit* pUnit
     );
 
 /**
@@ -63,46 +70,114 @@ void Unit_Draw(
  * @param pUnit Pointer to the `Unit` whose position will be updated.
  * @param dx    The amount to move the unit along the X-axis.
  * @param dy    The amount to move the unit along the Y-axis.
+ * @return `true` if the unit moved, `false` if the tile is taken by another unit on its occupancy grid.
  */
-void Unit_Move(
+_Check_return_opt_ bool Unit_Move(
     _Inout_ Unit* pUnit,
     _In_    INT dx,
     _In_    INT dy
     );
 
+/**
+ * @brief Moves the unit to a tile in a straight line.
+ *
+ * Cancels any path the unit is walking. Use `Unit_StartMoveAlongPath` or `Unit_StartPathTo` for moves that must
+ * go around terrain and other units.
+ *
+ * @param pUnit    Pointer to the `Unit` to move.
+ * @param pTilemap Pointer to the `Tilemap` used to convert tiles to world positions.
+ * @param ptTarget Tile to move to.
+ */
 void Unit_StartMoveToTile(
     _Inout_ Unit* pUnit,
     _In_    const Tilemap* pTilemap,
     _In_    POINT ptTarget
     );
 
+/**
+ * @brief Walks the unit along a path, one tile per step.
+ *
+ * The path is copied, so the caller's array may be reused right away. Paths longer than
+ * `UNIT_MAX_PATH_LENGTH` are rejected.
+ *
+ * @param pUnit    Pointer to the `Unit` to move.
+ * @param pTilemap Pointer to the `Tilemap` used to convert tiles to world positions.
+ * @param arrPath  Tiles to walk through, starting with the first step and ending on the destination.
+ * @param nLength  Number of tiles in `arrPath`.
+ * @return `true` if the unit started moving or already stood on the destination.
+ */
+_Check_return_opt_ bool Unit_StartMoveAlongPath(
+    _Inout_             Unit* pUnit,
+    _In_                const Tilemap* pTilemap,
+    _In_reads_(nLength) const POINT* arrPath,
+    _In_                INT nLength
+    );
+
+/**
+ * @brief Finds the cheapest path to a tile and starts walking it.
+ *
+ * @param pUnit     Pointer to the `Unit` to move.
+ * @param pTilemap  Pointer to the `Tilemap` used to convert tiles to world positions.
+ * @param pFinder   Path finder sized to the terrain.
+ * @param pTerrain  Terrain costs of the map.
+ * @param pBlockers Grid of the units the path must go around, or `NULL`. May contain `pUnit` itself.
+ * @param ptTarget  Tile to move to.
+ * @return `true` if a path was found and the unit started moving.
+ */
+_Check_return_opt_ bool Unit_StartPathTo(
+    _Inout_  Unit* pUnit,
+    _In_     const Tilemap* pTilemap,
+    _Inout_  PathFinder* pFinder,
+    _In_     const TerrainMap* pTerrain,
+    _In_opt_ const OccupancyGrid* pBlockers,
+    _In_     POINT ptTarget
+    );
+
 /**
  * @brief Retrieves the unit at the specified screen position.
  *
- * This function checks the screen position (given by `fMouseX` and `fMouseY`) and determines which
- * unit is located at that position, based on the provided list of units and the tilemap. The function
- * returns a pointer to the unit found at the given screen coordinates.
+ * This function converts the screen position (given by `fMouseX` and `fMouseY`) to a tile through the current
+ * camera and the tilemap, then looks the tile up in the occupancy grid.
  *
- * @param pUnits   Pointer to an array of `Unit` objects.
- * @param nCount   The number of units in the `pUnits` array.
- * @param pTilemap Pointer to the `Tilemap` used to map screen coordinates to world coordinates.
- * @param fMouseX  The X coordinate of the mouse in screen space.
- * @param fMouseY  The Y coordinate of the mouse in screen space.
+ * @param pOccupancy Pointer to the `OccupancyGrid` the units are placed on.
+ * @param pTilemap   Pointer to the `Tilemap` used to map screen coordinates to world coordinates.
+ * @param fMouseX    The X coordinate of the mouse in screen space.
+ * @param fMouseY    The Y coordinate of the mouse in screen space.
  * @return A pointer to the `Unit` at the specified screen position, or `NULL` if no unit is found.
  */
 _Check_return_ _Ret_maybenull_ Unit* Unit_GetAtScreenPosition(
-    _In_reads_(nCount) Unit* pUnits,
-    _In_               INT nCount,
-    _In_               const Tilemap* pTilemap,
-    _In_               FLOAT fMouseX,
-    _In_               FLOAT fMouseY
+    _In_ const OccupancyGrid* pOccupancy,
+    _In_ const Tilemap* pTilemap,
+    _In_ FLOAT fMouseX,
+    _In_ FLOAT fMouseY
+    );
+
+/**
+ * @brief Gets a handle to a unit.
+ *
+ * @param pUnit Pointer to the `Unit`.
+ * @return A handle that resolves to the unit until it is destroyed.
+ */
+_Check_return_ UnitHandle Unit_GetHandle(
+    _In_ const Unit* pUnit
+    );
+
+/**
+ * @brief Looks up the unit a handle refers to.
+ *
+ * @param hUnit The handle.
+ * @return A pointer to the `Unit`, or `NULL` if it was destroyed since the handle was taken.
+ */
+_Check_return_ _Ret_maybenull_ Unit* Unit_FromHandle(
+    _In_ UnitHandle hUnit
     );
 
 /**
  * @brief Destroys the specified unit, releasing its resources.
  *
- * This function deletes the specified unit and frees any associated resources. After this function is
- * called, the `Unit` pointer is no longer valid, and further access to it should be avoided.
+ * This function deletes the specified unit and frees any associated resources. The unit is removed from its
+ * occupancy grid first. After this function is called, the `Unit` pointer is no longer valid, and further
+ * access to it should be avoided.
  *
  * @param pUnit Pointer to the `Unit` that will be destroyed.
  * @return `true` if the unit was successfully destroyed, `false` otherwise.
@@ -111,4 +186,13 @@ _Check_return_opt_ bool Unit_Destroy(
     _Inout_ _Pre_valid_ _Post_invalid_ Unit* pUnit
     );
 
+/**
+ * @brief Frees the memory pool that units are allocated from.
+ *
+ * Call once at shutdown, after every one of them is destroyed.
+ */
+void Unit_Shutdown(
+    void
+    );
+
 #endif //UNIT_H
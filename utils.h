@@ -48,6 +48,27 @@ typedef enum _Result {
  */
 #define UnusedParam(var)
 
+/**
+ * @brief Gives every thread its own instance of a static or global variable.
+ *
+ * MSVC's C compiler has no `_Thread_local` in older language modes, so it gets its own spelling.
+ */
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+/**
+ * @brief Promises the compiler that a pointer is the only way its memory is reached, so loops over it can be
+ *        vectorised without runtime overlap checks.
+ */
+#ifdef _MSC_VER
+#define RESTRICT __restrict
+#else
+#define RESTRICT restrict
+#endif
+
 /**
  * @brief Safely frees a dynamically allocated pointer and sets it to NULL.
  *
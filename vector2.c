@@ -79,3 +79,12 @@ bool Vector2Equal(
 ) {
     return vec1.x == vec2.x && vec1.y == vec2.y;
 }
+
+_Check_return_
+VECTOR2 Vector2Lerp(
+    _In_ const VECTOR2 from,
+    _In_ const VECTOR2 to,
+    _In_ const FLOAT fT
+) {
+    return (VECTOR2){ from.x + (to.x - from.x) * fT, from.y + (to.y - from.y) * fT };
+}
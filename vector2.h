@@ -119,4 +119,19 @@ _Check_return_ bool Vector2Equal(
     _In_ VECTOR2 vec2
     );
 
+/**
+ * Linearly interpolates between two vectors.
+ *
+ * @param from The vector returned for a factor of 0.
+ * @param to   The vector returned for a factor of 1.
+ * @param fT   Interpolation factor, usually between 0 and 1.
+ *
+ * @returns The vector fT of the way from `from` to `to`.
+ */
+_Check_return_ VECTOR2 Vector2Lerp(
+    _In_ VECTOR2 from,
+    _In_ VECTOR2 to,
+    _In_ FLOAT fT
+    );
+
 #endif //VECTOR2_H
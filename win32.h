@@ -0,0 +1,21 @@
+#ifndef WIN32_H
+#define WIN32_H
+
+/*
+ * Includes <windows.h> next to utils.h. Both declare CHAR, LONG, ULONG and DWORD, with different types, so the
+ * Windows versions are renamed while the header is read. Code in this project keeps seeing the utils.h types;
+ * values still convert implicitly when passed to Windows functions.
+ */
+#ifdef _WIN32
+#define CHAR WIN32_CHAR
+#define LONG WIN32_LONG
+#define ULONG WIN32_ULONG
+#define DWORD WIN32_DWORD
+#include <windows.h>
+#undef CHAR
+#undef LONG
+#undef ULONG
+#undef DWORD
+#endif
+
+#endif //WIN32_H
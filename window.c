@@ -7,15 +7,49 @@
 #include <stdio.h>
 #include <SFML/Graphics.h>
 
+#ifdef _WIN32
+#include "win32.h"
+#else
+#include <time.h>
+#endif
+
+#include "profiler.h"
+#include "render-stats.h"
+#include "arena.h"
+
 static INT s_iWindowWidth;
 static INT s_iWindowHeight;
 static sfRenderWindow* s_pWindow;
 static sfEvent lastEvent;
 static FLOAT s_fMouseX;
 static FLOAT s_fMouseY;
-static sfTime s_deltaTime;
-static sfClock* s_pDeltaClock;
-static sfClock* s_pClock;
+static INT64 s_lStartNs;       // << Clock reading when the window was created
+static INT64 s_lLastFrameNs;   // << Clock reading at the previous Window_IsOpen
+static INT64 s_lFrameNs;       // << Duration of the last frame
+
+_Check_return_
+static INT64 ReadClockNanoseconds(
+    void
+) {
+#ifdef _WIN32
+    static LARGE_INTEGER s_frequency;
+    if (s_frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&s_frequency);
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // Split into whole seconds and the remainder, so the multiplication cannot overflow
+    const INT64 lSeconds = counter.QuadPart / s_frequency.QuadPart;
+    const INT64 lRemainder = counter.QuadPart % s_frequency.QuadPart;
+    return lSeconds * 1000000000LL + lRemainder * 1000000000LL / s_frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (INT64)now.tv_sec * 1000000000LL + now.tv_nsec;
+#endif
+}
 
 _Check_return_ _Ret_maybenull_
 Window* Window_Create(
@@ -53,26 +87,10 @@ Window* Window_Create(
     s_pWindow = pWindow->pDisplay;
     s_iWindowWidth = (int)uWidth;
     s_iWindowHeight = (int)uHeight;
-    
-    s_pDeltaClock = sfClock_create();
-    if (!s_pDeltaClock) {
-        printf("Failed to create delta clock\n");
-        sfRenderWindow_destroy(pWindow->pDisplay);
-        SafeFree(pWindow);
-        return NULL;
-    }
-
-    s_pClock = sfClock_create();
-    if (!s_pClock) {
-        printf("Failed to create clock\n");
-        sfClock_destroy(s_pDeltaClock);
-        sfRenderWindow_destroy(pWindow->pDisplay);
-        SafeFree(pWindow);
-        return NULL;
-    }
 
-    sfClock_restart(s_pClock);
-    sfClock_restart(s_pDeltaClock);
+    s_lStartNs = ReadClockNanoseconds();
+    s_lLastFrameNs = s_lStartNs;
+    s_lFrameNs = 0;
 
     return pWindow;
 }
@@ -86,26 +104,61 @@ bool Window_IsOpen(
             case sfEvtClosed:
                 sfRenderWindow_close(pWindow->pDisplay);
                 break;
+            case sfEvtResized:
+                // Cameras compare against these to notice that their cached transforms are stale
+                s_iWindowWidth = (INT)lastEvent.size.width;
+                s_iWindowHeight = (INT)lastEvent.size.height;
+                break;
         }
     }
 
-    s_deltaTime = sfClock_restart(s_pDeltaClock);
+    const INT64 lNowNs = ReadClockNanoseconds();
+    s_lFrameNs = lNowNs - s_lLastFrameNs;
+    s_lLastFrameNs = lNowNs;
 
     return sfRenderWindow_isOpen(pWindow->pDisplay);
 }
 
+_Check_return_
+INT64 GetTimeNanoseconds(
+    void
+) {
+    return ReadClockNanoseconds() - s_lStartNs;
+}
+
+_Check_return_
+INT64 GetTimeMicroseconds(
+    void
+) {
+    return GetTimeNanoseconds() / 1000;
+}
+
 _Check_return_
 INT GetTime(
     void
 ) {
-    return sfTime_asMilliseconds(sfClock_getElapsedTime(s_pClock));
+    return (INT)(GetTimeNanoseconds() / 1000000);
+}
+
+_Check_return_
+DOUBLE GetFrameTimeSeconds(
+    void
+) {
+    return (DOUBLE)s_lFrameNs / 1000000000.0;
+}
+
+_Check_return_
+INT64 GetFrameTimeMicroseconds(
+    void
+) {
+    return s_lFrameNs / 1000;
 }
 
 _Check_return_
 INT64 GetFrameTime(
     void
 ) {
-    return sfTime_asMilliseconds(s_deltaTime);
+    return s_lFrameNs / 1000000;
 }
 
 _Check_return_
@@ -147,7 +200,13 @@ void Window_Clear(
 void Window_Display(
     void
 ) {
+    PROFILE_BEGIN("Window_Display");
     sfRenderWindow_display(s_pWindow);
+    PROFILE_END();
+
+    Profiler_EndFrame();
+    RenderStats_EndFrame();
+    Arena_EndFrame();
 }
 
 _Check_return_
@@ -194,8 +253,6 @@ bool Window_Destroy(
     }
 
     sfRenderWindow_destroy(pWindow->pDisplay);
-    sfClock_destroy(s_pClock);
-    sfClock_destroy(s_pDeltaClock);
     SafeFree(pWindow);
 
     return true;
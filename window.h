@@ -56,20 +56,66 @@ _Check_return_ bool Window_IsOpen(
     _In_ const Window* pWindow
     );
 
+/**
+ * @brief Retrieves the time since the window was created, in nanoseconds.
+ *
+ * The time comes from the system's monotonic high-resolution clock (`QueryPerformanceCounter` on Windows,
+ * `CLOCK_MONOTONIC` elsewhere), so it never jumps when the wall clock is changed.
+ *
+ * @return The time since the window was created, in nanoseconds.
+ */
+_Check_return_ INT64 GetTimeNanoseconds(
+    void
+    );
+
+/**
+ * @brief Retrieves the time since the window was created, in microseconds.
+ *
+ * @return The time since the window was created, in microseconds.
+ */
+_Check_return_ INT64 GetTimeMicroseconds(
+    void
+    );
+
+/**
+ * @brief Retrieves the time since the window was created, in milliseconds.
+ *
+ * Kept for callers that only need coarse time; it is `GetTimeNanoseconds` rounded down.
+ *
+ * @return The time since the window was created, in milliseconds.
+ */
 _Check_return_ INT GetTime(
     void
     );
 
 /**
- * @brief Retrieves the time duration of the last frame.
+ * @brief Retrieves the duration of the last frame in seconds, with sub-microsecond resolution.
  *
- * This function returns the time elapsed (in seconds) for the most recent frame rendered by the application.
- * This value can be used to synchronize animations, control frame rates, or perform time-based calculations.
+ * The frame time is measured each time `Window_IsOpen` is called, i.e. once per pass of the main loop. Use it for
+ * anything that moves every frame; whole milliseconds are too coarse above 100 frames per second.
  *
  * @return The time elapsed during the last frame, in seconds.
+ */
+_Check_return_ DOUBLE GetFrameTimeSeconds(
+    void
+    );
+
+/**
+ * @brief Retrieves the duration of the last frame in microseconds.
+ *
+ * @return The time elapsed during the last frame, in microseconds.
+ */
+_Check_return_ INT64 GetFrameTimeMicroseconds(
+    void
+    );
+
+/**
+ * @brief Retrieves the duration of the last frame in whole milliseconds.
+ *
+ * Kept for existing callers. Frames shorter than a millisecond return `0`, and at high frame rates the value
+ * jumps between neighbouring milliseconds; prefer `GetFrameTimeSeconds`.
  *
- * @note The frame time is typically updated each time the application renders a frame, and the returned value
- *       may vary depending on the system's performance and rendering loop timing.
+ * @return The time elapsed during the last frame, in milliseconds.
  */
 _Check_return_ INT64 GetFrameTime(
     void